@@ -49,8 +49,8 @@ class AboutRain {
     int WIDTH = 240;
     int HEIGHT = 325;
     int MARGIN_TOP = 20;
-    int CHAR_WIDTH = 5;
-    int CHAR_HEIGHT = 8;
+    int GLYPH_WIDTH = 5;
+    int GLYPH_HEIGHT = 8;
     int COLS = 0;
     int ROWS = 0;
     static const int MAX_DROPS = 36;
@@ -105,13 +105,13 @@ class AboutRain {
         int16_t end_y = std::min<int16_t>(ROWS - 1, drop.old_y);
 
         if (start_y <= end_y) {
-            int16_t pixel_y = start_y * CHAR_HEIGHT + MARGIN_TOP;
-            uint16_t height = (end_y - start_y + 1) * CHAR_HEIGHT;
+            int16_t pixel_y = start_y * GLYPH_HEIGHT + MARGIN_TOP;
+            uint16_t height = (end_y - start_y + 1) * GLYPH_HEIGHT;
 
             painter.fill_rectangle_unrolled8(
-                {static_cast<int16_t>(drop.x * CHAR_WIDTH),
+                {static_cast<int16_t>(drop.x * GLYPH_WIDTH),
                  pixel_y,
-                 CHAR_WIDTH,
+                 GLYPH_WIDTH,
                  height},
                 ui::Color::black());
         }
@@ -134,8 +134,8 @@ class AboutRain {
         std::srand(0);
         WIDTH = UI_POS_MAXWIDTH;
         HEIGHT = UI_POS_MAXHEIGHT;
-        COLS = WIDTH / CHAR_WIDTH;
-        ROWS = (HEIGHT - MARGIN_TOP) / CHAR_HEIGHT;
+        COLS = WIDTH / GLYPH_WIDTH;
+        ROWS = (HEIGHT - MARGIN_TOP) / GLYPH_HEIGHT;
 
         for (uint8_t i = 0; i < MAX_DROPS; ++i) {
             init_drop(i, true);
@@ -171,8 +171,8 @@ class AboutRain {
                 int y = drops[i].y - j;
                 if (y >= 0 && y < ROWS) {
                     ui::Point p{
-                        static_cast<int16_t>(drops[i].x * CHAR_WIDTH),
-                        static_cast<int16_t>(y * CHAR_HEIGHT + MARGIN_TOP)};
+                        static_cast<int16_t>(drops[i].x * GLYPH_WIDTH),
+                        static_cast<int16_t>(y * GLYPH_HEIGHT + MARGIN_TOP)};
 
                     ui::Color fg;
                     if (j == 0) {
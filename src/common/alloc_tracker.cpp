@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "alloc_tracker.hpp"
+
+#if APP_ALLOC_TRACKING
+
+#include "app_allocator.hpp"
+#include "standalone_application.hpp"
+#include "ui/ui_painter.hpp"
+#include "ui/ui_font_fixed_5x8.hpp"
+#include "ui/file.hpp"
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+constinit AllocTracker alloc_tracker;
+
+static size_t histogram_bucket(size_t size) {
+    size_t bucket = 0;
+    for (size_t limit = 16; bucket < ALLOC_HISTOGRAM_BUCKETS - 1 && size > limit; limit <<= 1)
+        bucket++;
+
+    return bucket;
+}
+
+// the overlay is formatted without allocating, so it does not show up in what it counts
+static char* append(char* out, const char* text) {
+    while (*text)
+        *out++ = *text++;
+
+    return out;
+}
+
+static char* append(char* out, uint32_t value) {
+    char digits[10];
+    size_t length = 0;
+
+    do {
+        digits[length++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    while (length > 0)
+        *out++ = digits[--length];
+
+    return out;
+}
+
+void AllocTracker::count(size_t size) {
+    stats_.in_use += size;
+    stats_.blocks++;
+    stats_.frame_allocations++;
+    stats_.histogram[histogram_bucket(size)]++;
+
+    if (stats_.in_use > stats_.peak_in_use)
+        stats_.peak_in_use = stats_.in_use;
+
+    if (stats_.blocks > stats_.peak_blocks)
+        stats_.peak_blocks = stats_.blocks;
+}
+
+void* AllocTracker::allocate(size_t size) {
+    stats_.mallocs++;
+    return allocate_counted(size);
+}
+
+void* AllocTracker::allocate_counted(size_t size) {
+    Header* header = (Header*)app_allocator.allocate(sizeof(Header) + size);
+    if (header == nullptr)
+        return nullptr;
+
+    header->size = size;
+    count(size);
+    return header + 1;
+}
+
+void* AllocTracker::allocate_zeroed(size_t count, size_t size) {
+    stats_.callocs++;
+
+    size_t total = count * size;
+    if (size != 0 && total / size != count)
+        return nullptr;
+
+    void* p = allocate_counted(total);
+    if (p != nullptr)
+        memset(p, 0, total);
+
+    return p;
+}
+
+void* AllocTracker::reallocate(void* p, size_t size) {
+    if (p == nullptr)
+        return allocate(size);
+
+    stats_.reallocs++;
+
+    Header* header = (Header*)p - 1;
+    size_t old_size = header->size;
+
+    header = (Header*)app_allocator.reallocate(header, sizeof(Header) + size);
+    if (header == nullptr)
+        return nullptr;
+
+    // counted as a new block of the new size
+    header->size = size;
+    stats_.in_use -= old_size;
+    stats_.blocks--;
+    count(size);
+    return header + 1;
+}
+
+void AllocTracker::release(void* p) {
+    if (p == nullptr)
+        return;
+
+    stats_.frees++;
+
+    Header* header = (Header*)p - 1;
+    stats_.in_use -= header->size;
+    stats_.blocks--;
+    app_allocator.release(header);
+}
+
+void AllocTracker::frame_end() {
+    stats_.frames++;
+    stats_.last_frame_allocations = stats_.frame_allocations;
+    if (stats_.frame_allocations > stats_.max_frame_allocations)
+        stats_.max_frame_allocations = stats_.frame_allocations;
+    stats_.frame_allocations = 0;
+
+    if (stats_.frames % ALLOC_OVERLAY_INTERVAL == 0)
+        draw_overlay();
+}
+
+void AllocTracker::draw_overlay() {
+    char line[64];
+    char* end = line;
+
+    end = append(end, "use ");
+    end = append(end, stats_.in_use);
+    end = append(end, " pk ");
+    end = append(end, stats_.peak_in_use);
+    end = append(end, " blk ");
+    end = append(end, stats_.blocks);
+    end = append(end, " frm ");
+    end = append(end, stats_.last_frame_allocations);
+    end = append(end, "/");
+    end = append(end, stats_.max_frame_allocations);
+
+    // padded, so a shorter line covers the previous one
+    while (end < line + sizeof(line) && (size_t)(end - line) * 5 < *_api->screen_width)
+        *end++ = ' ';
+
+    ui::Painter painter;
+    painter.draw_string({0, *_api->screen_height - 8}, ui::font::fixed_5x8(), ui::Color::white(), ui::Color::dark_blue(),
+                        std::string_view(line, end - line));
+}
+
+bool AllocTracker::dump() {
+    // copied first, writing the file allocates as well
+    alloc_stats_t s = stats_;
+
+    File file;
+    if (file.append(u"ALLOCS.TXT").is_valid())
+        return false;
+
+    file.write_line("calls: malloc " + std::to_string(s.mallocs) + ", calloc " + std::to_string(s.callocs) +
+                    ", realloc " + std::to_string(s.reallocs) + ", free " + std::to_string(s.frees));
+    file.write_line("in use: " + std::to_string(s.in_use) + " bytes in " + std::to_string(s.blocks) + " blocks, peak " +
+                    std::to_string(s.peak_in_use) + " bytes / " + std::to_string(s.peak_blocks) + " blocks");
+    file.write_line("per frame: last " + std::to_string(s.last_frame_allocations) + ", max " + std::to_string(s.max_frame_allocations) +
+                    ", average " + std::to_string(s.frames > 0 ? (s.mallocs + s.callocs + s.reallocs) / s.frames : 0) +
+                    " over " + std::to_string(s.frames) + " frames");
+
+    for (size_t bucket = 0; bucket < ALLOC_HISTOGRAM_BUCKETS; bucket++) {
+        std::string range = bucket < ALLOC_HISTOGRAM_BUCKETS - 1 ? "<= " + std::to_string(16 << bucket) : "> " + std::to_string(16 << (bucket - 1));
+        file.write_line("  " + range + ": " + std::to_string(s.histogram[bucket]));
+    }
+
+    file.write_line("");
+    return true;
+}
+
+#endif
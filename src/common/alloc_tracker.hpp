@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __ALLOC_TRACKER_H__
+#define __ALLOC_TRACKER_H__
+
+#include <cstdint>
+#include <cstddef>
+
+/* Optional bookkeeping in the malloc hooks of the app: call counts, bytes and blocks in use with their peaks,
+ * allocations per frame and a histogram of the requested sizes.
+ * Build with -DAPP_ALLOC_TRACKING=1 (UDEFS in the app's CMakeLists.txt) to enable it, otherwise none of it is compiled.
+ * Every block then carries an 8 byte header with its size. A line at the bottom of the screen shows the numbers
+ * twice a second and the whole set is written to ALLOCS.TXT when the app exits or dump() is called. */
+
+#ifndef APP_ALLOC_TRACKING
+#define APP_ALLOC_TRACKING 0
+#endif
+
+#if APP_ALLOC_TRACKING
+
+// sizes up to 16, 32, 64 ... 4096 bytes and everything larger
+#define ALLOC_HISTOGRAM_BUCKETS 10
+#define ALLOC_OVERLAY_INTERVAL 30
+
+struct alloc_stats_t {
+    uint32_t mallocs;
+    uint32_t callocs;
+    uint32_t reallocs;
+    uint32_t frees;
+    uint32_t in_use;  // bytes requested by the app, without headers
+    uint32_t peak_in_use;
+    uint32_t blocks;
+    uint32_t peak_blocks;
+    uint32_t frames;
+    uint32_t frame_allocations;  // in the running frame
+    uint32_t last_frame_allocations;
+    uint32_t max_frame_allocations;
+    uint32_t histogram[ALLOC_HISTOGRAM_BUCKETS];
+};
+
+class AllocTracker {
+   public:
+    constexpr AllocTracker() = default;
+
+    AllocTracker(const AllocTracker&) = delete;
+    AllocTracker& operator=(const AllocTracker&) = delete;
+
+    void* allocate(size_t size);
+    void* allocate_zeroed(size_t count, size_t size);
+    void* reallocate(void* p, size_t size);
+    void release(void* p);
+
+    // closes the per frame count and refreshes the overlay every ALLOC_OVERLAY_INTERVAL frames
+    void frame_end();
+
+    const alloc_stats_t& stats() const { return stats_; }
+    void draw_overlay();
+    bool dump();
+
+   private:
+    struct Header {
+        uint32_t size;
+        uint32_t reserved;
+    };
+
+    void* allocate_counted(size_t size);
+    void count(size_t size);
+
+    alloc_stats_t stats_{};
+};
+
+extern AllocTracker alloc_tracker;
+
+#endif
+
+#endif /*__ALLOC_TRACKER_H__*/
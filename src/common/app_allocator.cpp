@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "app_allocator.hpp"
+#include "standalone_application.hpp"
+
+#include <cstring>
+
+// constant initialized, so it works for allocations made by static constructors
+constinit AppAllocator app_allocator;
+
+static constexpr size_t align8(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+static constexpr size_t pool_block_size(size_t size_class) {
+    return APP_POOL_MIN_BLOCK << size_class;
+}
+
+bool AppAllocator::ready() {
+    if (initialized_)
+        return true;
+
+    if (released_)
+        return false;
+
+    region_ = (uint8_t*)_api->malloc(arena_size + pool_size);
+    if (region_ == nullptr) {
+        // everything goes to the firmware heap
+        released_ = true;
+        return false;
+    }
+
+    uint8_t* block = region_ + arena_size;
+    for (size_t size_class = 0; size_class < APP_POOL_CLASS_COUNT; size_class++) {
+        for (size_t i = 0; i < APP_POOL_BLOCKS_PER_CLASS; i++) {
+            *(void**)block = free_lists_[size_class];
+            free_lists_[size_class] = block;
+            block += pool_block_size(size_class);
+        }
+    }
+
+    initialized_ = true;
+    return true;
+}
+
+bool AppAllocator::in_arena(const uint8_t* p) const {
+    return region_ != nullptr && p >= region_ && p < region_ + arena_size;
+}
+
+bool AppAllocator::in_pools(const uint8_t* p) const {
+    return region_ != nullptr && p >= region_ + arena_size && p < region_ + arena_size + pool_size;
+}
+
+void* AppAllocator::allocate(size_t size) {
+    if (size == 0)
+        size = 1;
+
+    if (ready()) {
+        void* p = nullptr;
+
+        if (in_frame_ && size <= APP_ARENA_MAX_BLOCK)
+            p = arena_allocate(size);
+
+        if (p == nullptr && size <= APP_POOL_MAX_BLOCK)
+            p = pool_allocate(size);
+
+        if (p != nullptr)
+            return p;
+    }
+
+    return _api->malloc(size);
+}
+
+void* AppAllocator::allocate_zeroed(size_t count, size_t size) {
+    size_t total = count * size;
+    if (size != 0 && total / size != count)
+        return nullptr;
+
+    void* p = allocate(total);
+    if (p != nullptr)
+        memset(p, 0, total);
+
+    return p;
+}
+
+void* AppAllocator::reallocate(void* p, size_t size) {
+    if (p == nullptr)
+        return allocate(size);
+
+    uint8_t* block = (uint8_t*)p;
+    size_t old_size;
+
+    if (in_arena(block)) {
+        if (released_)
+            return nullptr;
+
+        if (arena_resize(block, size))
+            return p;
+
+        old_size = ((ArenaHeader*)(block - sizeof(ArenaHeader)))->size;
+    } else if (in_pools(block)) {
+        if (released_)
+            return nullptr;
+
+        old_size = pool_block_size(pool_class_of(block));
+        if (size != 0 && size <= old_size)
+            return p;
+    } else {
+        return _api->realloc(p, size);
+    }
+
+    void* moved = allocate(size);
+    if (moved == nullptr)
+        return nullptr;
+
+    memcpy(moved, p, old_size < size ? old_size : size);
+    release(p);
+    return moved;
+}
+
+void AppAllocator::release(void* p) {
+    if (p == nullptr)
+        return;
+
+    uint8_t* block = (uint8_t*)p;
+
+    if (in_arena(block)) {
+        if (!released_)
+            arena_release(block);
+    } else if (in_pools(block)) {
+        if (!released_)
+            pool_release(block);
+    } else {
+        _api->free(p);
+    }
+}
+
+void AppAllocator::shutdown() {
+    if (!initialized_)
+        return;
+
+    // region_ stays set, so blocks from the arena and the pools are still recognized
+    _api->free(region_);
+    initialized_ = false;
+    released_ = true;
+}
+
+void* AppAllocator::arena_allocate(size_t size) {
+    size_t needed = sizeof(ArenaHeader) + align8(size);
+    Page* page = &pages_[current_page_];
+
+    if (page->offset + needed > APP_ARENA_PAGE_SIZE) {
+        // continue on the next page without live blocks
+        size_t i = 1;
+        for (; i < APP_ARENA_PAGE_COUNT; i++) {
+            if (pages_[(current_page_ + i) % APP_ARENA_PAGE_COUNT].live == 0)
+                break;
+        }
+
+        if (i == APP_ARENA_PAGE_COUNT)
+            return nullptr;
+
+        current_page_ = (current_page_ + i) % APP_ARENA_PAGE_COUNT;
+        page = &pages_[current_page_];
+        page->offset = 0;
+    }
+
+    uint8_t* block = region_ + current_page_ * APP_ARENA_PAGE_SIZE + page->offset;
+    ((ArenaHeader*)block)->size = size;
+    page->offset += needed;
+    page->live++;
+
+    return block + sizeof(ArenaHeader);
+}
+
+void AppAllocator::arena_release(uint8_t* p) {
+    uint8_t* header = p - sizeof(ArenaHeader);
+    size_t index = (header - region_) / APP_ARENA_PAGE_SIZE;
+    Page& page = pages_[index];
+    size_t end = header - region_ - index * APP_ARENA_PAGE_SIZE + sizeof(ArenaHeader) + align8(((ArenaHeader*)header)->size);
+
+    page.live--;
+
+    if (page.live == 0)
+        page.offset = 0;
+    else if (end == page.offset)
+        // the newest block of the page gives its space back right away
+        page.offset = header - region_ - index * APP_ARENA_PAGE_SIZE;
+}
+
+// shrinks in place, grows in place if the block is the newest of its page
+bool AppAllocator::arena_resize(uint8_t* p, size_t size) {
+    if (size == 0)
+        return false;
+
+    ArenaHeader* header = (ArenaHeader*)(p - sizeof(ArenaHeader));
+    size_t index = ((uint8_t*)header - region_) / APP_ARENA_PAGE_SIZE;
+    Page& page = pages_[index];
+    size_t start = p - region_ - index * APP_ARENA_PAGE_SIZE;
+
+    if (size <= align8(header->size)) {
+        header->size = size;
+        return true;
+    }
+
+    if (start + align8(header->size) != page.offset || start + align8(size) > APP_ARENA_PAGE_SIZE)
+        return false;
+
+    page.offset = start + align8(size);
+    header->size = size;
+    return true;
+}
+
+void* AppAllocator::pool_allocate(size_t size) {
+    size_t size_class = 0;
+    while (pool_block_size(size_class) < size)
+        size_class++;
+
+    void* block = free_lists_[size_class];
+    if (block == nullptr)
+        return nullptr;
+
+    free_lists_[size_class] = *(void**)block;
+    return block;
+}
+
+void AppAllocator::pool_release(uint8_t* p) {
+    size_t size_class = pool_class_of(p);
+    *(void**)p = free_lists_[size_class];
+    free_lists_[size_class] = p;
+}
+
+size_t AppAllocator::pool_class_of(const uint8_t* p) const {
+    size_t offset = p - (region_ + arena_size);
+    size_t size_class = 0;
+
+    while (offset >= pool_block_size(size_class) * APP_POOL_BLOCKS_PER_CLASS) {
+        offset -= pool_block_size(size_class) * APP_POOL_BLOCKS_PER_CLASS;
+        size_class++;
+    }
+
+    return size_class;
+}
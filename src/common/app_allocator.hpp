@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __APP_ALLOCATOR_H__
+#define __APP_ALLOCATOR_H__
+
+#include <cstdint>
+#include <cstddef>
+
+/* Allocator behind the malloc hooks of the app, so small blocks stay off the firmware heap.
+ * During a frame (on_event and painting) blocks up to 256 bytes come from a bump arena of a few pages.
+ * Every page counts its live blocks and starts over once they are all freed, so frame temporaries
+ * cost a pointer bump and a block that outlives the frame only holds on to its own page.
+ * Outside of frames small blocks come from pools with one size class per power of two from 16 to 128 bytes.
+ * Everything else, and whatever does not fit anymore, goes to the firmware heap.
+ * Not thread safe, all allocations have to come from the app's thread. */
+
+#define APP_ARENA_PAGE_SIZE 512
+#define APP_ARENA_PAGE_COUNT 8
+#define APP_ARENA_MAX_BLOCK 256
+
+#define APP_POOL_CLASS_COUNT 4
+#define APP_POOL_MIN_BLOCK 16
+#define APP_POOL_MAX_BLOCK (APP_POOL_MIN_BLOCK << (APP_POOL_CLASS_COUNT - 1))
+#define APP_POOL_BLOCKS_PER_CLASS 32
+
+class AppAllocator {
+   public:
+    constexpr AppAllocator() = default;
+
+    AppAllocator(const AppAllocator&) = delete;
+    AppAllocator& operator=(const AppAllocator&) = delete;
+
+    void* allocate(size_t size);
+    void* allocate_zeroed(size_t count, size_t size);
+    void* reallocate(void* p, size_t size);
+    void release(void* p);
+
+    // the arena is only used between these calls
+    void frame_begin() { in_frame_ = true; }
+    void frame_end() { in_frame_ = false; }
+
+    // returns the arena and the pools to the firmware heap, blocks from them that are freed later are ignored
+    void shutdown();
+
+   private:
+    struct Page {
+        uint16_t offset;
+        uint16_t live;
+    };
+
+    // keeps the blocks 8 byte aligned
+    struct ArenaHeader {
+        uint32_t size;
+        uint32_t reserved;
+    };
+
+    static constexpr size_t arena_size = APP_ARENA_PAGE_SIZE * APP_ARENA_PAGE_COUNT;
+    static constexpr size_t pool_size = (2 * APP_POOL_MAX_BLOCK - APP_POOL_MIN_BLOCK) * APP_POOL_BLOCKS_PER_CLASS;
+
+    bool ready();
+    bool in_arena(const uint8_t* p) const;
+    bool in_pools(const uint8_t* p) const;
+
+    void* arena_allocate(size_t size);
+    void arena_release(uint8_t* p);
+    bool arena_resize(uint8_t* p, size_t size);
+
+    void* pool_allocate(size_t size);
+    void pool_release(uint8_t* p);
+    size_t pool_class_of(const uint8_t* p) const;
+
+    uint8_t* region_{nullptr};  // the arena pages followed by the pool blocks of every class
+    bool initialized_{false};
+    bool released_{false};
+    bool in_frame_{false};
+
+    Page pages_[APP_ARENA_PAGE_COUNT]{};
+    size_t current_page_{0};
+
+    void* free_lists_[APP_POOL_CLASS_COUNT]{};
+};
+
+extern AppAllocator app_allocator;
+
+#endif /*__APP_ALLOCATOR_H__*/
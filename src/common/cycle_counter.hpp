@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __CYCLE_COUNTER_H__
+#define __CYCLE_COUNTER_H__
+
+#include <cstdint>
+
+#if defined(PP_SIMULATOR)
+#include <chrono>
+#endif
+
+/* The standalone api has no time source, so timing uses the DWT cycle counter of the M4.
+ * It counts core clock cycles and wraps after about 21 seconds, so only measure shorter spans.
+ * The host simulator counts at the same rate from the steady clock, elsewhere off target the counter reads 0. */
+
+#define CYCLE_COUNTER_HZ 200000000
+
+#if defined(__arm__)
+#define CYCLE_COUNTER_DEMCR (*(volatile uint32_t*)0xE000EDFC)
+#define CYCLE_COUNTER_DWT_CTRL (*(volatile uint32_t*)0xE0001000)
+#define CYCLE_COUNTER_DWT_CYCCNT (*(volatile uint32_t*)0xE0001004)
+
+// harmless if the firmware enabled it already
+inline void cycle_counter_enable() {
+    CYCLE_COUNTER_DEMCR |= 1 << 24;  // TRCENA
+    CYCLE_COUNTER_DWT_CTRL |= 1;     // CYCCNTENA
+}
+
+inline uint32_t cycle_counter_now() {
+    return CYCLE_COUNTER_DWT_CYCCNT;
+}
+#elif defined(PP_SIMULATOR)
+inline void cycle_counter_enable() {}
+
+inline uint32_t cycle_counter_now() {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (uint32_t)(ns / (1000000000 / CYCLE_COUNTER_HZ));
+}
+#else
+inline void cycle_counter_enable() {}
+
+inline uint32_t cycle_counter_now() {
+    return 0;
+}
+#endif
+
+inline uint32_t cycles_to_us(uint32_t cycles) {
+    return cycles / (CYCLE_COUNTER_HZ / 1000000);
+}
+
+#endif /*__CYCLE_COUNTER_H__*/
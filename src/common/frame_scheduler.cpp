@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "frame_scheduler.hpp"
+
+constinit FrameScheduler frame_scheduler;
+
+void FrameScheduler::link(FrameTimer*& head, FrameTimer* timer) {
+    timer->next_ = head;
+    if (head)
+        head->pprev_ = &timer->next_;
+    head = timer;
+    timer->pprev_ = &head;
+}
+
+void FrameScheduler::unlink(FrameTimer* timer) {
+    if (timer->pprev_ == nullptr)
+        return;
+
+    *timer->pprev_ = timer->next_;
+    if (timer->next_)
+        timer->next_->pprev_ = timer->pprev_;
+    timer->next_ = nullptr;
+    timer->pprev_ = nullptr;
+}
+
+void FrameScheduler::insert(FrameTimer* timer) {
+    link(slots_[timer->expires_ % FRAME_TIMER_WHEEL_SLOTS], timer);
+}
+
+void FrameScheduler::tick(const ui::View* top) {
+    frame_++;
+
+    // the covered view came back, let its waiting timers fire in this frame
+    if (top != last_top_) {
+        last_top_ = top;
+        while (parked_) {
+            FrameTimer* timer = parked_;
+            unlink(timer);
+            timer->expires_ = frame_;
+            insert(timer);
+        }
+    }
+
+    FrameTimer*& slot = slots_[frame_ % FRAME_TIMER_WHEEL_SLOTS];
+    if (slot == nullptr)
+        return;
+
+    // move the slot to due_ and take timers from there one by one, callbacks may stop or destroy any of them
+    due_ = slot;
+    due_->pprev_ = &due_;
+    slot = nullptr;
+
+    while (due_) {
+        FrameTimer* timer = due_;
+        unlink(timer);
+
+        if (timer->expires_ != frame_) {
+            // further rounds of the wheel
+            insert(timer);
+        } else if (timer->owner_ != top) {
+            link(parked_, timer);
+        } else {
+            // rearmed before the call, so the callback can stop or restart it and nothing touches it afterwards
+            if (timer->period_ > 0) {
+                timer->expires_ = frame_ + timer->period_;
+                insert(timer);
+            }
+            timer->on_timeout_();
+        }
+    }
+}
+
+void FrameTimer::start_frames(uint32_t frames, bool periodic) {
+    stop();
+
+    if (frames == 0)
+        frames = 1;
+
+    period_ = periodic ? frames : 0;
+    expires_ = frame_scheduler.now() + frames;
+    frame_scheduler.insert(this);
+}
+
+void FrameTimer::start_ms(uint32_t ms, bool periodic) {
+    start_frames((ms * FRAME_TIMER_FRAMES_PER_SECOND + 999) / 1000, periodic);
+}
+
+void FrameTimer::stop() {
+    frame_scheduler.unlink(this);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __FRAME_SCHEDULER_H__
+#define __FRAME_SCHEDULER_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace ui {
+class View;
+}
+
+/* One-shot and periodic timers counted in frame syncs (60 per second), driven by StandaloneViewMirror::on_framesync.
+ * Timers hang in a wheel of FRAME_TIMER_WHEEL_SLOTS lists by their expiry frame, so a frame only walks one short
+ * list and a frame without due timers costs an index increment.
+ * A timer belongs to a view and only fires while that view is on top of the navigation stack, like on_framesync did.
+ * Timers that come due while their view is covered wait and fire once it is on top again.
+ * The callback may start, stop or destroy any timer, including its own. */
+
+#define FRAME_TIMER_WHEEL_SLOTS 64
+#define FRAME_TIMER_FRAMES_PER_SECOND 60
+
+class FrameTimer;
+
+class FrameScheduler {
+   public:
+    constexpr FrameScheduler() = default;
+
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    // advances one frame and fires the due timers whose view is top
+    void tick(const ui::View* top);
+
+    uint32_t now() const { return frame_; }
+
+   private:
+    friend class FrameTimer;
+
+    void insert(FrameTimer* timer);
+    void link(FrameTimer*& head, FrameTimer* timer);
+    void unlink(FrameTimer* timer);
+
+    FrameTimer* slots_[FRAME_TIMER_WHEEL_SLOTS]{};
+    FrameTimer* due_{nullptr};     // the slot being dispatched, detached so callbacks can change the wheel
+    FrameTimer* parked_{nullptr};  // due while their view was covered
+    const ui::View* last_top_{nullptr};
+    uint32_t frame_{0};
+};
+
+extern FrameScheduler frame_scheduler;
+
+class FrameTimer {
+   public:
+    FrameTimer(const ui::View* owner, std::function<void()> on_timeout)
+        : owner_{owner}, on_timeout_{std::move(on_timeout)} {}
+    ~FrameTimer() { stop(); }
+
+    FrameTimer(const FrameTimer&) = delete;
+    FrameTimer& operator=(const FrameTimer&) = delete;
+
+    // (re)starts the timer, it fires after the given time and then every period if periodic
+    void start_frames(uint32_t frames, bool periodic = false);
+    void start_ms(uint32_t ms, bool periodic = false);
+    void stop();
+
+    bool is_running() const { return pprev_ != nullptr; }
+
+    // for timers of widgets, whose view is only known once they are added to it
+    void set_owner(const ui::View* owner) { owner_ = owner; }
+
+   private:
+    friend class FrameScheduler;
+
+    const ui::View* owner_;
+    std::function<void()> on_timeout_;
+    uint32_t expires_{0};
+    uint32_t period_{0};  // 0 for one-shot
+    FrameTimer* next_{nullptr};
+    FrameTimer** pprev_{nullptr};  // link pointing at this timer, nullptr when stopped
+};
+
+#endif /*__FRAME_SCHEDULER_H__*/
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "i2c_queue.hpp"
+
+#include "standalone_application.hpp"
+#include "cycle_counter.hpp"
+
+#include <utility>
+
+I2cQueue i2c_queue;
+
+bool I2cQueue::join(const uint8_t* command, size_t command_len, size_t response_len, const void* owner, I2cCallback& on_done) {
+    // newest first, a read from before a queued write could answer with stale data
+    for (size_t i = count_; i > 0; i--) {
+        Request& request = at(i - 1);
+        if (request.response_len == 0)
+            return false;
+
+        if (request.response_len != response_len || request.command_len != command_len ||
+            memcmp(request.command, command, command_len) != 0)
+            continue;
+
+        if (request.waiter_count == I2C_QUEUE_MAX_WAITERS)
+            return false;
+
+        request.waiters[request.waiter_count++] = {owner, std::move(on_done)};
+        return true;
+    }
+
+    return false;
+}
+
+bool I2cQueue::submit(const void* owner, Command command, const void* args, size_t args_len, size_t response_len, I2cCallback on_done) {
+    size_t command_len = sizeof(command) + args_len;
+    if (command_len > I2C_QUEUE_MAX_COMMAND || response_len > I2C_QUEUE_MAX_RESPONSE)
+        return false;
+
+    uint8_t buffer[I2C_QUEUE_MAX_COMMAND];
+    memcpy(buffer, &command, sizeof(command));
+    if (args_len > 0)
+        memcpy(buffer + sizeof(command), args, args_len);
+
+    if (response_len > 0 && join(buffer, command_len, response_len, owner, on_done))
+        return true;
+
+    if (count_ == I2C_QUEUE_DEPTH)
+        return false;
+
+    Request& request = at(count_++);
+    memcpy(request.command, buffer, command_len);
+    request.command_len = command_len;
+    request.response_len = response_len;
+    request.waiters[0] = {owner, std::move(on_done)};
+    request.waiter_count = 1;
+    return true;
+}
+
+void I2cQueue::cancel(const void* owner) {
+    for (size_t i = 0; i < count_; i++) {
+        Request& request = at(i);
+        for (size_t w = 0; w < request.waiter_count; w++) {
+            if (request.waiters[w].owner == owner) {
+                request.waiters[w].owner = nullptr;
+                request.waiters[w].on_done = nullptr;
+            }
+        }
+    }
+}
+
+void I2cQueue::run_next() {
+    // taken out of the queue first, the callbacks may submit or cancel
+    Request& request = at(0);
+    uint8_t command[I2C_QUEUE_MAX_COMMAND];
+    size_t command_len = request.command_len;
+    size_t response_len = request.response_len;
+    Waiter waiters[I2C_QUEUE_MAX_WAITERS];
+    size_t waiter_count = request.waiter_count;
+
+    memcpy(command, request.command, command_len);
+    bool waited_for = response_len == 0;
+    for (size_t w = 0; w < waiter_count; w++) {
+        waiters[w] = std::move(request.waiters[w]);
+        request.waiters[w].on_done = nullptr;
+        if (waiters[w].on_done)
+            waited_for = true;
+    }
+
+    head_ = (head_ + 1) % I2C_QUEUE_DEPTH;
+    count_--;
+
+    // a read whose views are gone is not worth the bus time
+    if (waited_for == false)
+        return;
+
+    uint8_t response[I2C_QUEUE_MAX_RESPONSE];
+    bool ok = _api->i2c_read(command, command_len, response_len > 0 ? response : nullptr, response_len);
+
+    for (size_t w = 0; w < waiter_count; w++) {
+        if (waiters[w].on_done)
+            waiters[w].on_done(ok, response, response_len);
+    }
+}
+
+void I2cQueue::poll(uint32_t budget_us) {
+    if (count_ == 0)
+        return;
+
+    if (clock_ == nullptr) {
+        cycle_counter_enable();
+        clock_ = cycle_counter_now;
+    }
+
+    uint32_t start = clock_();
+    uint32_t budget = budget_us * (CYCLE_COUNTER_HZ / 1000000);
+
+    do {
+        run_next();
+    } while (count_ > 0 && clock_() - start < budget);
+}
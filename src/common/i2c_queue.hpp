@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __I2C_QUEUE_H__
+#define __I2C_QUEUE_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+
+#include "pp_commands.hpp"
+
+/* Deferred module transactions, so views do not block their callbacks and on_framesync on _api->i2c_read.
+ * Requests are queued with a completion callback and run in order from StandaloneViewMirror::on_framesync,
+ * as many per frame as fit into the time budget, but at least one.
+ * A read equal to one still waiting, with no write queued after it, joins that request instead of adding another.
+ * Views pass themselves as owner and call cancel(this) in their destructor, so no callback outlives its view.
+ * The module has no batch command, so every request is still its own transaction. */
+
+#define I2C_QUEUE_DEPTH 8
+#define I2C_QUEUE_MAX_WAITERS 4
+#define I2C_QUEUE_MAX_COMMAND 128  // command and arguments, what one i2c write can carry
+#define I2C_QUEUE_MAX_RESPONSE 128
+#define I2C_QUEUE_FRAME_BUDGET_US 2000
+
+// ok is false if the transaction failed, data is only valid during the call
+typedef std::function<void(bool ok, const uint8_t* data, size_t len)> I2cCallback;
+
+class I2cQueue {
+   public:
+    I2cQueue() = default;
+
+    I2cQueue(const I2cQueue&) = delete;
+    I2cQueue& operator=(const I2cQueue&) = delete;
+
+    // returns false if the queue is full or the request too large, on_done is not called then
+    bool submit(const void* owner, Command command, const void* args, size_t args_len, size_t response_len, I2cCallback on_done);
+
+    // on_done only runs for a successful read, like the blocking code that returned on failure
+    template <typename Response>
+    bool read(const void* owner, Command command, std::function<void(const Response&)> on_done) {
+        static_assert(sizeof(Response) <= I2C_QUEUE_MAX_RESPONSE, "response too large");
+        return submit(owner, command, nullptr, 0, sizeof(Response), [on_done](bool ok, const uint8_t* data, size_t) {
+            if (ok == false) return;
+            Response response;
+            memcpy(&response, data, sizeof(Response));
+            on_done(response);
+        });
+    }
+
+    template <typename Args>
+    bool write(const void* owner, Command command, const Args& args, std::function<void(bool ok)> on_done = {}) {
+        static_assert(sizeof(Command) + sizeof(Args) <= I2C_QUEUE_MAX_COMMAND, "arguments too large");
+        return submit(owner, command, &args, sizeof(Args), 0, [on_done](bool ok, const uint8_t*, size_t) {
+            if (on_done) on_done(ok);
+        });
+    }
+
+    // drops the callbacks of owner, its writes are still sent but reads nobody waits for anymore are dropped
+    void cancel(const void* owner);
+
+    // runs queued requests until budget_us have passed
+    void poll(uint32_t budget_us);
+
+    size_t pending() const { return count_; }
+
+    // counts at CYCLE_COUNTER_HZ, the cycle counter by default, replaceable for tests off target
+    void set_clock(uint32_t (*clock)()) { clock_ = clock; }
+
+   private:
+    struct Waiter {
+        const void* owner;
+        I2cCallback on_done;
+    };
+
+    struct Request {
+        uint8_t command[I2C_QUEUE_MAX_COMMAND];
+        size_t command_len;
+        size_t response_len;  // 0 for writes
+        Waiter waiters[I2C_QUEUE_MAX_WAITERS];
+        size_t waiter_count;
+    };
+
+    Request& at(size_t index) { return requests_[(head_ + index) % I2C_QUEUE_DEPTH]; }
+    bool join(const uint8_t* command, size_t command_len, size_t response_len, const void* owner, I2cCallback& on_done);
+    void run_next();
+
+    Request requests_[I2C_QUEUE_DEPTH]{};
+    size_t head_{0};
+    size_t count_{0};
+    uint32_t (*clock_)(){nullptr};
+};
+
+extern I2cQueue i2c_queue;
+
+#endif /*__I2C_QUEUE_H__*/
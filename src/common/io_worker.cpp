@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+
+#include "io_worker.hpp"
+
+#include "standalone_application.hpp"
+#include "cycle_counter.hpp"
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+#ifdef PP_SIMULATOR
+#include <thread>
+#endif
+
+IoWorker io_worker;
+
+static bool path_copy(TCHAR* out, const TCHAR* path) {
+    size_t i = 0;
+    for (; path[i]; i++) {
+        if (i + 1 == IO_WORKER_MAX_PATH)
+            return false;
+        out[i] = path[i];
+    }
+    out[i] = 0;
+    return true;
+}
+
+static bool path_equal(const TCHAR* a, const TCHAR* b) {
+    for (; *a && *a == *b; a++, b++);
+    return *a == *b;
+}
+
+IoRequestId IoWorker::read(const void* owner, const std::filesystem::path& path, uint32_t offset, uint32_t length, IoPriority priority, IoCallback on_done) {
+    if (length == 0 || length > IO_WORKER_BUFFER_BUDGET || path.native().size() >= IO_WORKER_MAX_PATH ||
+        stopping_.load(std::memory_order_relaxed))
+        return 0;
+
+    if (priority == IoPriority::VISIBLE)
+        make_room(length);
+
+    Slot* slot = free_slot();
+    if (slot == nullptr || buffered_ + length > IO_WORKER_BUFFER_BUDGET)
+        return 0;
+
+    slot->buffer = new (std::nothrow) uint8_t[length];
+    if (slot->buffer == nullptr)
+        return 0;
+
+    path_copy(slot->path, path.tchar());
+    slot->offset = offset;
+    slot->length = length;
+    slot->owner = owner;
+    slot->on_done = std::move(on_done);
+    slot->id = next_id_++;
+    if (next_id_ == 0)
+        next_id_ = 1;
+    slot->cancelled.store(false, std::memory_order_relaxed);
+    slot->priority.store((uint8_t)priority, std::memory_order_relaxed);
+    slot->sequence.store(next_sequence_++, std::memory_order_relaxed);
+    slot->state.store(QUEUED, std::memory_order_release);
+
+    pending_++;
+    buffered_ += length;
+    path_copy(last_path_, slot->path);
+
+    if (started_ == false) {
+        started_ = true;
+        running_.store(true, std::memory_order_release);
+        _api->create_thread(thread_main, this, IO_WORKER_STACK_SIZE, IO_WORKER_PRIORITY);
+    }
+
+    return slot->id;
+}
+
+IoWorker::Slot* IoWorker::free_slot() {
+    for (auto& s : slots_) {
+        if (s.state.load(std::memory_order_acquire) == FREE)
+            return &s;
+    }
+    return nullptr;
+}
+
+// queued prefetches give way to a visible read, newest first, until there is a slot and buffer memory for it
+void IoWorker::make_room(uint32_t length) {
+    while (free_slot() == nullptr || buffered_ + length > IO_WORKER_BUFFER_BUDGET) {
+        Slot* newest = nullptr;
+        for (auto& s : slots_) {
+            if (s.state.load(std::memory_order_acquire) == QUEUED && s.priority.load(std::memory_order_relaxed) == (uint8_t)IoPriority::PREFETCH &&
+                (newest == nullptr || (int32_t)(s.sequence.load(std::memory_order_relaxed) - newest->sequence.load(std::memory_order_relaxed)) > 0))
+                newest = &s;
+        }
+
+        if (newest == nullptr)
+            return;
+
+        // the worker may claim it meanwhile, then its memory comes back once the read is returned
+        drop(*newest);
+    }
+}
+
+void IoWorker::release(Slot& slot) {
+    delete[] slot.buffer;
+    slot.buffer = nullptr;
+    slot.on_done = nullptr;
+    slot.owner = nullptr;
+    slot.id = 0;
+    buffered_ -= slot.length;
+    pending_--;
+    slot.state.store(FREE, std::memory_order_release);
+}
+
+// takes a queued or finished request back without calling on_done, one being read is only flagged
+void IoWorker::drop(Slot& slot) {
+    uint8_t expected = QUEUED;
+    if (slot.state.compare_exchange_strong(expected, FREE, std::memory_order_acq_rel) || expected == DONE) {
+        release(slot);
+        return;
+    }
+
+    if (expected == READING) {
+        slot.cancelled.store(true, std::memory_order_relaxed);
+        slot.on_done = nullptr;
+        slot.owner = nullptr;
+        slot.id = 0;
+    }
+}
+
+void IoWorker::promote(IoRequestId id) {
+    for (auto& s : slots_) {
+        if (s.id == id && id != 0)
+            s.priority.store((uint8_t)IoPriority::VISIBLE, std::memory_order_relaxed);
+    }
+}
+
+void IoWorker::cancel(IoRequestId id) {
+    for (auto& s : slots_) {
+        if (s.id == id && id != 0)
+            drop(s);
+    }
+}
+
+void IoWorker::cancel(const void* owner) {
+    for (auto& s : slots_) {
+        if (s.owner == owner && s.id != 0)
+            drop(s);
+    }
+}
+
+void IoWorker::poll(uint32_t budget_us) {
+    if (pending_ == 0)
+        return;
+
+    if (clock_ == nullptr) {
+        cycle_counter_enable();
+        clock_ = cycle_counter_now;
+    }
+
+    uint32_t start = clock_();
+    uint32_t budget = budget_us * (CYCLE_COUNTER_HZ / 1000000);
+
+    // round robin over the slots, a slow callback does not keep the later slots waiting every frame
+    for (size_t n = 0; n < IO_WORKER_SLOTS; n++) {
+        Slot& slot = slots_[next_poll_];
+        next_poll_ = (next_poll_ + 1) % IO_WORKER_SLOTS;
+
+        if (slot.state.load(std::memory_order_acquire) != DONE)
+            continue;
+
+        if (slot.cancelled.load(std::memory_order_relaxed) || !slot.on_done) {
+            release(slot);
+            continue;
+        }
+
+        // taken out of the slot first, the callback may submit or cancel, this slot stays DONE until it returns
+        IoCallback on_done = std::move(slot.on_done);
+        slot.on_done = nullptr;
+        slot.owner = nullptr;
+        slot.id = 0;
+        on_done(slot.ok, slot.buffer, slot.result_length);
+        release(slot);
+
+        if (clock_() - start >= budget)
+            break;
+    }
+}
+
+void IoWorker::stop() {
+    for (auto& s : slots_)
+        drop(s);
+
+    if (started_) {
+        stopping_.store(true, std::memory_order_release);
+        wait_for_worker();
+        started_ = false;
+        stopping_.store(false, std::memory_order_relaxed);
+    }
+
+    // what the worker returned while it was asked to stop
+    for (auto& s : slots_) {
+        if (s.state.load(std::memory_order_acquire) == DONE)
+            release(s);
+    }
+}
+
+void IoWorker::wait_for_worker() {
+    // the worker runs below the ui thread and only gets the cpu while this thread blocks, a read from the sd card
+    // with a fresh FIL always reaches the card. The worker may hold the volume lock, then f_open waits for it.
+    while (running_.load(std::memory_order_acquire)) {
+        FIL file;
+        if (_api->f_open(&file, last_path_, FA_READ) == FR_OK) {
+            uint8_t byte;
+            UINT read;
+            _api->f_read(&file, &byte, 1, &read);
+            _api->f_close(&file);
+        }
+    }
+}
+
+int32_t IoWorker::thread_main(void* arg) {
+    static_cast<IoWorker*>(arg)->run();
+    return 0;
+}
+
+void IoWorker::run() {
+    while (stopping_.load(std::memory_order_acquire) == false) {
+        Slot* slot = claim_next();
+        if (slot == nullptr) {
+            // idle, a file left open could go stale while the ui thread writes it
+            if (file_open_) {
+                _api->f_close(&file_);
+                file_open_ = false;
+            }
+#ifdef PP_SIMULATOR
+            std::this_thread::yield();
+#endif
+            continue;
+        }
+
+        read_slot(*slot);
+        slot->state.store(DONE, std::memory_order_release);
+    }
+
+    if (file_open_) {
+        _api->f_close(&file_);
+        file_open_ = false;
+    }
+
+    // the last access to the app's memory, stop() returns after this
+    running_.store(false, std::memory_order_release);
+}
+
+IoWorker::Slot* IoWorker::claim_next() {
+    Slot* best = nullptr;
+    uint8_t best_priority = 0;
+    uint32_t best_sequence = 0;
+
+    for (auto& s : slots_) {
+        if (s.state.load(std::memory_order_acquire) != QUEUED)
+            continue;
+
+        uint8_t priority = s.priority.load(std::memory_order_relaxed);
+        uint32_t sequence = s.sequence.load(std::memory_order_relaxed);
+        if (best == nullptr || priority < best_priority || (priority == best_priority && (int32_t)(sequence - best_sequence) < 0)) {
+            best = &s;
+            best_priority = priority;
+            best_sequence = sequence;
+        }
+    }
+
+    // the ui thread may have taken it back meanwhile, then the next round picks another
+    uint8_t expected = QUEUED;
+    if (best == nullptr || best->state.compare_exchange_strong(expected, READING, std::memory_order_acq_rel) == false)
+        return nullptr;
+
+    return best;
+}
+
+void IoWorker::read_slot(Slot& slot) {
+    // runs of requests for one file keep it open
+    if (file_open_ && path_equal(file_path_, slot.path) == false) {
+        _api->f_close(&file_);
+        file_open_ = false;
+    }
+
+    if (file_open_ == false) {
+        file_open_ = _api->f_open(&file_, slot.path, FA_READ) == FR_OK;
+        if (file_open_)
+            path_copy(file_path_, slot.path);
+    }
+
+    bool ok = file_open_ && _api->f_lseek(&file_, slot.offset) == FR_OK;
+    uint32_t done = 0;
+
+    while (ok && done < slot.length && slot.cancelled.load(std::memory_order_relaxed) == false &&
+           stopping_.load(std::memory_order_relaxed) == false) {
+        uint32_t chunk = slot.length - done < IO_WORKER_CHUNK ? slot.length - done : IO_WORKER_CHUNK;
+        UINT read = 0;
+        ok = _api->f_read(&file_, slot.buffer + done, chunk, &read) == FR_OK;
+        done += read;
+
+        // end of the file
+        if (read < chunk)
+            break;
+    }
+
+    slot.ok = ok;
+    slot.result_length = done;
+}
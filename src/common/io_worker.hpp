@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+
+#ifndef __IO_WORKER_H__
+#define __IO_WORKER_H__
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+#include "file.hpp"
+
+/* Reads files on a thread of its own, so map tiles, thumbnails and large files do not stall the ui thread.
+ * The ui thread fills requests into a fixed table of slots, the worker claims the most urgent one, visible before
+ * prefetch and oldest first, and reads it into a buffer allocated at submit time. Completed reads are handed back
+ * from StandaloneViewMirror::on_framesync, as many per frame as fit into the time budget, but at least one.
+ * Slots change hands only through their atomic state, there is no lock the ui thread could wait on: a queued request
+ * is cancelled by taking its slot back, one being read is flagged and dropped once the worker returns it.
+ * Buffers are allocated and freed on the ui thread, the app allocator is not thread safe. All pending buffers stay
+ * within IO_WORKER_BUFFER_BUDGET, a visible read makes room by dropping the newest queued prefetches.
+ * The worker keeps its own FIL. The firmware builds FatFs with _FS_REENTRANT, calls are serialized per volume,
+ * so the ui thread can use other files meanwhile, but should not write a file the worker reads.
+ *
+ * The api has no call to block a thread, so the worker polls its slots while idle. It runs below the ui thread and
+ * gets the cpu while the ui thread waits for events or for the sd card. The thread is started by the first request
+ * and ends in stop(), called from shutdown() before the app image is unloaded. stop() reads from the sd card while
+ * it waits, so the worker gets the cpu to notice. Threads from create_thread are not freed by the firmware, so
+ * there is one worker per app run. */
+
+#define IO_WORKER_SLOTS 8
+#define IO_WORKER_MAX_PATH 64  // characters including the terminator
+#define IO_WORKER_CHUNK 512    // bytes per f_read, cancellation is checked in between
+#define IO_WORKER_STACK_SIZE 2048
+#define IO_WORKER_PRIORITY 2  // LOWPRIO of chibios, the ui thread runs at NORMALPRIO
+#define IO_WORKER_FRAME_BUDGET_US 2000
+
+#ifndef IO_WORKER_BUFFER_BUDGET
+#define IO_WORKER_BUFFER_BUDGET (8 * 1024)
+#endif
+
+enum class IoPriority : uint8_t {
+    VISIBLE = 0,  // needed for what is on screen
+    PREFETCH,     // may be needed soon, dropped first when memory runs short
+};
+
+// 0 is no request
+typedef uint32_t IoRequestId;
+
+// ok is false if the file could not be opened or read, length is short at the end of the file
+// data is only valid during the call
+typedef std::function<void(bool ok, const uint8_t* data, size_t length)> IoCallback;
+
+class IoWorker {
+   public:
+    IoWorker() = default;
+
+    IoWorker(const IoWorker&) = delete;
+    IoWorker& operator=(const IoWorker&) = delete;
+
+    // returns 0 if no slot or buffer memory is left or the path is too long, on_done is not called then
+    IoRequestId read(const void* owner, const std::filesystem::path& path, uint32_t offset, uint32_t length, IoPriority priority, IoCallback on_done);
+
+    IoRequestId prefetch(const void* owner, const std::filesystem::path& path, uint32_t offset, uint32_t length, IoCallback on_done) {
+        return read(owner, path, offset, length, IoPriority::PREFETCH, std::move(on_done));
+    }
+
+    // raises a queued prefetch to visible, when what it reads came into view
+    void promote(IoRequestId id);
+
+    // on_done of a cancelled request is not called
+    void cancel(IoRequestId id);
+    void cancel(const void* owner);
+
+    // hands completed reads to their callbacks until budget_us have passed
+    void poll(uint32_t budget_us);
+
+    // cancels all requests and waits for the worker thread to end, from shutdown()
+    void stop();
+
+    size_t pending() const { return pending_; }
+    size_t buffered() const { return buffered_; }
+
+    // counts at CYCLE_COUNTER_HZ, the cycle counter by default, replaceable for tests off target
+    void set_clock(uint32_t (*clock)()) { clock_ = clock; }
+
+   private:
+    enum State : uint8_t {
+        FREE = 0,
+        QUEUED,   // filled by the ui thread, waits for the worker
+        READING,  // claimed by the worker
+        DONE,     // returned by the worker, waits for poll()
+    };
+
+    struct Slot {
+        std::atomic<uint8_t> state{FREE};
+        std::atomic<uint8_t> priority{0};
+        std::atomic<uint32_t> sequence{0};  // submit order, read by the worker while choosing
+        std::atomic<bool> cancelled{false};
+
+        // written by the ui thread before QUEUED, read by the worker after claiming
+        TCHAR path[IO_WORKER_MAX_PATH];
+        uint32_t offset;
+        uint32_t length;
+        uint8_t* buffer;
+
+        // written by the worker before DONE
+        uint32_t result_length;
+        bool ok;
+
+        // ui thread only
+        IoRequestId id;
+        const void* owner;
+        IoCallback on_done;
+    };
+
+    static int32_t thread_main(void* arg);
+    void run();
+    Slot* claim_next();
+    void read_slot(Slot& slot);
+    Slot* free_slot();
+    void make_room(uint32_t length);
+    void release(Slot& slot);
+    void drop(Slot& slot);
+    void wait_for_worker();
+
+    Slot slots_[IO_WORKER_SLOTS]{};
+    IoRequestId next_id_{1};
+    uint32_t next_sequence_{0};
+    size_t pending_{0};
+    size_t buffered_{0};
+    size_t next_poll_{0};
+    uint32_t (*clock_)(){nullptr};
+
+    bool started_{false};                // ui thread
+    std::atomic<bool> stopping_{false};  // asks the worker to end
+    std::atomic<bool> running_{false};   // cleared by the worker as it leaves
+    TCHAR last_path_[IO_WORKER_MAX_PATH]{};  // ui thread, read by stop() to wait on the sd card
+
+    // worker thread only
+    FIL file_;
+    TCHAR file_path_[IO_WORKER_MAX_PATH]{};
+    bool file_open_{false};
+};
+
+extern IoWorker io_worker;
+
+#endif /*__IO_WORKER_H__*/
@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+
+#include "paint_profiler.hpp"
+
+#if APP_PAINT_PROFILING
+
+#include "cycle_counter.hpp"
+#include "standalone_application.hpp"
+#include "ui/ui_painter.hpp"
+#include "ui/ui_widget.hpp"
+#include "ui/ui_font_fixed_5x8.hpp"
+#include "ui/file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+constinit PaintProfiler paint_profiler;
+
+static const char* const call_names[(size_t)PaintCall::COUNT] = {"bitmap", "fill", "fill8", "pixel", "pixels", "scroll"};
+
+// the overlay is formatted without allocating
+static char* append(char* out, const char* text) {
+    while (*text)
+        *out++ = *text++;
+
+    return out;
+}
+
+static char* append(char* out, uint32_t value) {
+    char digits[10];
+    size_t length = 0;
+
+    do {
+        digits[length++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    while (length > 0)
+        *out++ = digits[--length];
+
+    return out;
+}
+
+static uint32_t call_count(const paint_cost_t& cost) {
+    uint32_t calls = 0;
+    for (auto c : cost.calls)
+        calls += c;
+
+    return calls;
+}
+
+static void add(paint_cost_t& to, const paint_cost_t& cost) {
+    for (size_t i = 0; i < (size_t)PaintCall::COUNT; i++)
+        to.calls[i] += cost.calls[i];
+
+    to.pixels += cost.pixels;
+    to.cycles += cost.cycles;
+}
+
+paint_widget_stats_t* PaintProfiler::entry(const ui::Widget* widget) {
+    for (size_t i = 0; i < widget_count_; i++) {
+        if (widgets_[i].widget == widget)
+            return &widgets_[i];
+    }
+
+    if (widget_count_ == PAINT_PROFILE_WIDGETS - 1) {
+        paint_widget_stats_t* other = &widgets_[PAINT_PROFILE_WIDGETS - 1];
+        strcpy(other->name, "(other)");
+        return other;
+    }
+
+    paint_widget_stats_t* e = &widgets_[widget_count_++];
+    e->widget = widget;
+    strcpy(e->name, widget ? "" : "(outside)");
+    return e;
+}
+
+void PaintProfiler::charge(uint32_t now) {
+    if (depth_ > 0)
+        stack_[depth_ - 1]->frame.cycles += now - segment_start_;
+
+    segment_start_ = now;
+}
+
+void PaintProfiler::begin(const ui::Widget* widget) {
+    if (reporting_)
+        return;
+
+    charge(cycle_counter_now());
+
+    if (depth_ == PAINT_PROFILE_DEPTH) {
+        // deeper scopes are charged to the innermost one that fits
+        depth_++;
+        return;
+    }
+
+    paint_widget_stats_t* e = entry(widget);
+
+    // the widget at an address can change between frames, the name is taken again for every frame it draws in
+    if (widget && e != &widgets_[PAINT_PROFILE_WIDGETS - 1] && call_count(e->frame) == 0 && e->frame.cycles == 0) {
+        std::string name;
+        const_cast<ui::Widget*>(widget)->getWidgetName(name);
+        if (name.empty()) {
+            char* end = append(append(append(e->name, "@"), widget->screen_rect().left()), ",");
+            *append(end, widget->screen_rect().top()) = 0;
+        } else {
+            size_t length = std::min(name.size(), sizeof(e->name) - 1);
+            memcpy(e->name, name.data(), length);
+            e->name[length] = 0;
+        }
+    }
+
+    stack_[depth_++] = e;
+}
+
+void PaintProfiler::end() {
+    if (reporting_ || depth_ == 0)
+        return;
+
+    if (depth_ <= PAINT_PROFILE_DEPTH)
+        charge(cycle_counter_now());
+
+    depth_--;
+}
+
+void PaintProfiler::count(PaintCall call, uint32_t pixels) {
+    if (reporting_)
+        return;
+
+    paint_widget_stats_t* e = depth_ > 0 ? stack_[std::min<size_t>(depth_, PAINT_PROFILE_DEPTH) - 1] : entry(nullptr);
+    e->frame.calls[(size_t)call]++;
+    e->frame.pixels += pixels;
+}
+
+void PaintProfiler::frame_end() {
+    frames_++;
+
+    // a scope that spans the frame end is split between the two frames
+    if (depth_ > 0)
+        charge(cycle_counter_now());
+
+    paint_cost_t frame{};
+    for (const auto& e : widgets_)
+        add(frame, e.frame);
+
+    bool painted = call_count(frame) > 0;
+    bool worst = painted && (frame.cycles > worst_frame_.cycles || (frame.cycles == worst_frame_.cycles && frame.pixels > worst_frame_.pixels));
+
+    if (painted) {
+        painted_frames_++;
+        last_frame_ = frame;
+        add(total_, frame);
+    }
+
+    if (worst) {
+        worst_frame_ = frame;
+        worst_frame_number_ = frames_;
+    }
+
+    for (size_t i = 0; i < PAINT_PROFILE_WIDGETS; i++) {
+        paint_widget_stats_t& e = widgets_[i];
+        if (worst) {
+            worst_cycles_[i] = e.frame.cycles;
+            worst_pixels_[i] = e.frame.pixels;
+        }
+
+        if (call_count(e.frame) == 0 && e.frame.cycles == 0)
+            continue;
+
+        e.frames++;
+        if (e.frame.cycles > e.max_frame_cycles)
+            e.max_frame_cycles = e.frame.cycles;
+        add(e.total, e.frame);
+        e.frame = {};
+    }
+
+    if (frames_ % PAINT_OVERLAY_INTERVAL == 0)
+        draw_overlay();
+}
+
+void PaintProfiler::draw_overlay() {
+    const paint_widget_stats_t* top = nullptr;
+    for (size_t i = 0; i < PAINT_PROFILE_WIDGETS; i++) {
+        const paint_widget_stats_t& e = widgets_[i];
+        if (e.frames > 0 && (top == nullptr || e.max_frame_cycles > top->max_frame_cycles ||
+                             (e.max_frame_cycles == top->max_frame_cycles && e.total.pixels > top->total.pixels)))
+            top = &e;
+    }
+
+    char line[64];
+    char* end = line;
+
+    end = append(end, "drw ");
+    end = append(end, call_count(last_frame_));
+    end = append(end, " px ");
+    end = append(end, last_frame_.pixels);
+    end = append(end, " us ");
+    end = append(end, cycles_to_us(last_frame_.cycles));
+    if (top) {
+        end = append(end, " ");
+        end = append(end, top->name);
+        end = append(end, " ");
+        end = append(end, cycles_to_us(top->max_frame_cycles));
+    }
+
+    // padded, so a shorter line covers the previous one
+    while (end < line + sizeof(line) && (size_t)(end - line) * 5 < *_api->screen_width)
+        *end++ = ' ';
+
+    // one line above the allocation overlay, its own drawing is not counted
+    reporting_ = true;
+    ui::Painter painter;
+    painter.draw_string({0, *_api->screen_height - 16}, ui::font::fixed_5x8(), ui::Color::white(), ui::Color::dark_green(),
+                        std::string_view(line, end - line));
+    reporting_ = false;
+}
+
+static std::string format_cost(const paint_cost_t& cost) {
+    std::string text;
+    for (size_t i = 0; i < (size_t)PaintCall::COUNT; i++) {
+        if (cost.calls[i] > 0)
+            text += std::string(call_names[i]) + " " + std::to_string(cost.calls[i]) + ", ";
+    }
+
+    return text + std::to_string(cost.pixels) + " px, " + std::to_string(cycles_to_us(cost.cycles)) + " us";
+}
+
+bool PaintProfiler::dump() {
+    reporting_ = true;
+
+    File file;
+    if (file.append(u"PAINTS.TXT").is_valid()) {
+        reporting_ = false;
+        return false;
+    }
+
+    file.write_line("frames " + std::to_string(frames_) + ", drawn in " + std::to_string(painted_frames_));
+    file.write_line("total: " + format_cost(total_));
+    file.write_line("per widget: frames drawn in, max us per frame, totals");
+
+    for (size_t i = 0; i < PAINT_PROFILE_WIDGETS; i++) {
+        const paint_widget_stats_t& e = widgets_[i];
+        if (e.frames == 0)
+            continue;
+
+        file.write_line("  " + std::string(e.name) + ": " + std::to_string(e.frames) + ", " + std::to_string(cycles_to_us(e.max_frame_cycles)) +
+                        ", " + format_cost(e.total));
+    }
+
+    file.write_line("slowest frame " + std::to_string(worst_frame_number_) + ": " + format_cost(worst_frame_));
+    for (size_t i = 0; i < PAINT_PROFILE_WIDGETS; i++) {
+        if (worst_cycles_[i] == 0 && worst_pixels_[i] == 0)
+            continue;
+
+        file.write_line("  " + std::string(widgets_[i].name) + ": " + std::to_string(worst_pixels_[i]) + " px, " +
+                        std::to_string(cycles_to_us(worst_cycles_[i])) + " us");
+    }
+
+    file.write_line("");
+    reporting_ = false;
+    return true;
+}
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+
+#ifndef __PAINT_PROFILER_H__
+#define __PAINT_PROFILER_H__
+
+#include <cstdint>
+#include <cstddef>
+
+/* Optional accounting of the drawing calls: api calls by type, pixels and time, attributed to the widget that
+ * made them. Painter::paint_widget opens a scope around every paint(), widgets that draw outside of paint
+ * (Console, HexDump) open their own, the time of a scope excludes the scopes nested in it.
+ * Build with -DAPP_PAINT_PROFILING=1 (UDEFS in the app's CMakeLists.txt) to enable it, otherwise the hooks are empty.
+ * A line above the bottom of the screen shows the last frame and its costliest widget twice a second, the totals
+ * per widget and the breakdown of the slowest frame are written to PAINTS.TXT when the app exits or dump() is called. */
+
+#ifndef APP_PAINT_PROFILING
+#define APP_PAINT_PROFILING 0
+#endif
+
+namespace ui {
+class Widget;
+}
+
+enum class PaintCall : uint8_t {
+    DRAW_BITMAP = 0,
+    FILL_RECTANGLE,
+    FILL_UNROLLED8,
+    DRAW_PIXEL,
+    DRAW_PIXELS,
+    SCROLL,
+    COUNT
+};
+
+#if APP_PAINT_PROFILING
+
+// widgets tracked by address, the rest is summed up in the last entry
+#define PAINT_PROFILE_WIDGETS 24
+#define PAINT_PROFILE_DEPTH 8
+#define PAINT_OVERLAY_INTERVAL 30
+
+struct paint_cost_t {
+    uint32_t calls[(size_t)PaintCall::COUNT];
+    uint32_t pixels;
+    uint32_t cycles;
+};
+
+struct paint_widget_stats_t {
+    const ui::Widget* widget;
+    char name[16];
+    paint_cost_t frame;  // in the running frame
+    paint_cost_t total;
+    uint32_t frames;  // frames it drew in
+    uint32_t max_frame_cycles;
+};
+
+class PaintProfiler {
+   public:
+    constexpr PaintProfiler() = default;
+
+    PaintProfiler(const PaintProfiler&) = delete;
+    PaintProfiler& operator=(const PaintProfiler&) = delete;
+
+    void count(PaintCall call, uint32_t pixels);
+
+    // the calls in between are charged to widget, nullptr charges them to the drawing outside of any widget
+    void begin(const ui::Widget* widget);
+    void end();
+
+    // closes the per frame numbers and refreshes the overlay every PAINT_OVERLAY_INTERVAL frames
+    void frame_end();
+
+    void draw_overlay();
+    bool dump();
+
+   private:
+    paint_widget_stats_t* entry(const ui::Widget* widget);
+    void charge(uint32_t now);
+
+    paint_widget_stats_t widgets_[PAINT_PROFILE_WIDGETS]{};
+    size_t widget_count_{0};
+
+    paint_widget_stats_t* stack_[PAINT_PROFILE_DEPTH]{};
+    size_t depth_{0};
+    uint32_t segment_start_{0};
+
+    paint_cost_t frame_{};
+    paint_cost_t last_frame_{};
+    paint_cost_t total_{};
+    uint32_t frames_{0};
+    uint32_t painted_frames_{0};
+
+    // per widget cycles and pixels of the slowest frame
+    paint_cost_t worst_frame_{};
+    uint32_t worst_frame_number_{0};
+    uint32_t worst_cycles_[PAINT_PROFILE_WIDGETS]{};
+    uint32_t worst_pixels_[PAINT_PROFILE_WIDGETS]{};
+
+    bool reporting_{false};
+};
+
+extern PaintProfiler paint_profiler;
+
+inline void paint_profile(PaintCall call, uint32_t pixels) {
+    paint_profiler.count(call, pixels);
+}
+
+// charges the drawing of a widget outside of paint(), e.g. from on_framesync
+class PaintProfileScope {
+   public:
+    explicit PaintProfileScope(const ui::Widget* widget) { paint_profiler.begin(widget); }
+    ~PaintProfileScope() { paint_profiler.end(); }
+
+    PaintProfileScope(const PaintProfileScope&) = delete;
+    PaintProfileScope& operator=(const PaintProfileScope&) = delete;
+};
+
+#else
+
+inline void paint_profile(PaintCall, uint32_t) {}
+
+class PaintProfileScope {
+   public:
+    explicit PaintProfileScope(const ui::Widget*) {}
+};
+
+#endif
+
+#endif /*__PAINT_PROFILER_H__*/
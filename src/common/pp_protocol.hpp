@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __PP_PROTOCOL_H__
+#define __PP_PROTOCOL_H__
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+/* Shared by the PortaPack apps and the module, the module finds it through its include path.
+ * Messages are packed, trivially copyable structs whose wire size is pinned with PP_MESSAGE on both sides.
+ * A command goes out as its 16 bit code, little endian, followed by the message.
+ * Encoding fills a std::array on the stack and decoding copies straight into the message, nothing allocates. */
+
+enum app_location_t : uint32_t {
+    UTILITIES = 0,
+    RX,
+    TX,
+    DEBUG,
+    HOME,
+    SETTINGS,
+    GAMES,
+    TRX
+};
+
+#define PP_COMMAND_SIZE 2
+// one i2c write: command and arguments
+#define PP_MESSAGE_MAX_SIZE 128
+
+#define PP_MESSAGE(type, size)                                                              \
+    static_assert(std::is_trivially_copyable_v<type>, #type " has to be trivially copyable"); \
+    static_assert(sizeof(type) == (size), #type " changed its size on the wire")
+
+template <typename Message>
+constexpr void pp_store(uint8_t* out, const Message& message) {
+    auto bytes = std::bit_cast<std::array<uint8_t, sizeof(Message)>>(message);
+    for (size_t i = 0; i < sizeof(Message); i++)
+        out[i] = bytes[i];
+}
+
+// false if len is not the size of the message
+template <typename Message>
+constexpr bool pp_load(const uint8_t* data, size_t len, Message& message) {
+    if (len != sizeof(Message))
+        return false;
+
+    std::array<uint8_t, sizeof(Message)> bytes{};
+    for (size_t i = 0; i < sizeof(Message); i++)
+        bytes[i] = data[i];
+    message = std::bit_cast<Message>(bytes);
+    return true;
+}
+
+template <typename CommandType>
+constexpr void pp_store_command(uint8_t* out, CommandType command) {
+    uint16_t code = static_cast<uint16_t>(command);
+    out[0] = code & 0xFF;
+    out[1] = code >> 8;
+}
+
+template <typename CommandType>
+constexpr std::array<uint8_t, PP_COMMAND_SIZE> pp_command(CommandType command) {
+    std::array<uint8_t, PP_COMMAND_SIZE> out{};
+    pp_store_command(out.data(), command);
+    return out;
+}
+
+template <typename CommandType, typename Message>
+constexpr std::array<uint8_t, PP_COMMAND_SIZE + sizeof(Message)> pp_command(CommandType command, const Message& message) {
+    static_assert(PP_COMMAND_SIZE + sizeof(Message) <= PP_MESSAGE_MAX_SIZE, "message does not fit one i2c write");
+
+    std::array<uint8_t, PP_COMMAND_SIZE + sizeof(Message)> out{};
+    pp_store_command(out.data(), command);
+    pp_store(out.data() + PP_COMMAND_SIZE, message);
+    return out;
+}
+
+// variable length arguments, returns the encoded size or 0 if they do not fit out
+template <typename CommandType>
+constexpr size_t pp_command(CommandType command, const uint8_t* args, size_t args_len, uint8_t* out, size_t out_len) {
+    if (PP_COMMAND_SIZE + args_len > out_len)
+        return 0;
+
+    pp_store_command(out, command);
+    for (size_t i = 0; i < args_len; i++)
+        out[PP_COMMAND_SIZE + i] = args[i];
+    return PP_COMMAND_SIZE + args_len;
+}
+
+static_assert(pp_command(uint16_t{0x7F01})[0] == 0x01 && pp_command(uint16_t{0x7F01})[1] == 0x7F, "commands are little endian");
+
+// module commands with fixed arguments, used by the uart and logic apps
+
+typedef struct __attribute__((packed))
+{
+    uint8_t channel;
+    uint32_t baudrate;  // any rate the uart supports, not only the standard ones
+} uart_baudrate_message_t;
+PP_MESSAGE(uart_baudrate_message_t, 5);
+
+typedef struct __attribute__((packed))
+{
+    uint32_t offset;  // into the encoded capture
+} logic_read_message_t;
+PP_MESSAGE(logic_read_message_t, 4);
+
+typedef struct __attribute__((packed))
+{
+    uint32_t bitrate;  // 0 turns the output off
+    uint8_t idle_level;
+} pattern_config_message_t;
+PP_MESSAGE(pattern_config_message_t, 5);
+
+// sizes of the status responses, both sides keep their own struct with their own enums
+#define PP_UART_CHANNEL_STATUS_SIZE 32
+#define PP_LOGIC_CAPTURE_STATUS_SIZE 20
+#define PP_PATTERN_STATUS_SIZE 32
+
+#endif /*__PP_PROTOCOL_H__*/
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include "protocol_decoders.hpp"
+
+static uint8_t hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return 0xFF;
+}
+
+void NmeaDecoder::push(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+
+        if (c == '$' || c == '!') {
+            // a new start inside a sentence means the line end was lost
+            in_sentence_ = true;
+            buffer_[0] = c;
+            length_ = 1;
+        } else if (in_sentence_ == false) {
+            continue;
+        } else if (c == '\r' || c == '\n') {
+            in_sentence_ = false;
+            if (on_record)
+                on_record({DecodedRecordType::NMEA, check(), buffer_, length_});
+        } else if (length_ < max_length) {
+            buffer_[length_++] = c;
+        } else {
+            // longer than the standard allows, not nmea
+            in_sentence_ = false;
+        }
+    }
+}
+
+void NmeaDecoder::reset() {
+    length_ = 0;
+    in_sentence_ = false;
+}
+
+bool NmeaDecoder::check() const {
+    if (length_ < 4 || buffer_[length_ - 3] != '*')
+        return false;
+
+    uint8_t high = hex_value(buffer_[length_ - 2]);
+    uint8_t low = hex_value(buffer_[length_ - 1]);
+    if (high == 0xFF || low == 0xFF)
+        return false;
+
+    uint8_t checksum = 0;
+    for (size_t i = 1; i < length_ - 3; i++)
+        checksum ^= buffer_[i];
+
+    return checksum == ((high << 4) | low);
+}
+
+static uint16_t crc16_update(uint16_t crc, uint8_t c) {
+    crc ^= c;
+    for (uint8_t bit = 0; bit < 8; bit++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    return crc;
+}
+
+void ModbusRtuDecoder::set_baudrate(uint32_t baudrate) {
+    if (baudrate == 0)
+        return;
+
+    // 11 bits per character
+    uint32_t gap = (uint64_t)35 * 11 * 1000000 / 10 / baudrate;
+    gap_us_ = gap > 1750 ? gap : 1750;
+}
+
+void ModbusRtuDecoder::push(const uint8_t* data, size_t length, uint32_t time_us) {
+    if (length == 0)
+        return;
+
+    if (length_ > 0 && time_us - last_time_us_ > gap_us_)
+        emit(false);
+    last_time_us_ = time_us;
+
+    for (size_t i = 0; i < length; i++) {
+        if (length_ == max_length)
+            emit(false);
+
+        uint8_t c = data[i];
+        buffer_[length_++] = c;
+
+        crc_ = crc16_update(crc_, c);
+
+        if (length_ >= min_length && crc_ == 0)
+            emit(true);
+    }
+}
+
+void ModbusRtuDecoder::reset() {
+    length_ = 0;
+    crc_ = 0xFFFF;
+}
+
+uint16_t ModbusRtuDecoder::crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+        crc = crc16_update(crc, data[i]);
+    return crc;
+}
+
+void ModbusRtuDecoder::emit(bool valid) {
+    if (on_record)
+        on_record({DecodedRecordType::MODBUS, valid, buffer_, length_});
+    reset();
+}
+
+#define SLIP_END 0xC0
+#define SLIP_ESC 0xDB
+#define SLIP_ESC_END 0xDC
+#define SLIP_ESC_ESC 0xDD
+
+void SlipDecoder::push(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+
+        if (c == SLIP_END) {
+            // empty frames are line noise flushes, senders often start with END
+            if (length_ > 0 && on_record)
+                on_record({DecodedRecordType::SLIP, valid_ && escape_ == false, buffer_, length_});
+            reset();
+            continue;
+        }
+
+        if (escape_) {
+            escape_ = false;
+            if (c == SLIP_ESC_END)
+                c = SLIP_END;
+            else if (c == SLIP_ESC_ESC)
+                c = SLIP_ESC;
+            else
+                valid_ = false;
+        } else if (c == SLIP_ESC) {
+            escape_ = true;
+            continue;
+        }
+
+        if (length_ < max_length)
+            buffer_[length_++] = c;
+        else
+            valid_ = false;
+    }
+}
+
+void SlipDecoder::reset() {
+    length_ = 0;
+    escape_ = false;
+    valid_ = true;
+}
+
+void CobsDecoder::push(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+
+        if (c == 0) {
+            // the frame has to end exactly at a block boundary
+            if ((length_ > 0 || zero_pending_) && on_record)
+                on_record({DecodedRecordType::COBS, valid_ && code_ == 0, buffer_, length_});
+            reset();
+            continue;
+        }
+
+        if (code_ == 0) {
+            // code byte of the next block
+            if (zero_pending_) {
+                if (length_ < max_length)
+                    buffer_[length_++] = 0;
+                else
+                    valid_ = false;
+            }
+            code_ = c;
+            zero_pending_ = c < 0xFF;
+        } else if (length_ < max_length) {
+            buffer_[length_++] = c;
+        } else {
+            valid_ = false;
+        }
+
+        code_--;
+    }
+}
+
+void CobsDecoder::reset() {
+    length_ = 0;
+    code_ = 0;
+    zero_pending_ = false;
+    valid_ = true;
+}
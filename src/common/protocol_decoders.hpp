@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __PROTOCOL_DECODERS_H__
+#define __PROTOCOL_DECODERS_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+/* Incremental decoders for serial protocols.
+ * Bytes are pushed as they arrive in chunks of any size, each decoder keeps
+ * a fixed-size state machine and buffer and never allocates. A decoded record
+ * points into the decoder's buffer and is only valid during on_record. */
+
+enum class DecodedRecordType : uint8_t {
+    NMEA = 0,
+    MODBUS,
+    SLIP,
+    COBS
+};
+
+struct decoded_record_t {
+    DecodedRecordType type;
+    bool valid;  // checksum, crc or framing is correct
+    const uint8_t* data;
+    size_t length;
+};
+
+using decoded_record_callback = std::function<void(const decoded_record_t&)>;
+
+/* NMEA 0183 sentences from '$' or '!' up to the line end.
+ * data is the sentence without line end, valid if the *hh checksum matches.
+ * Sentences without checksum are reported as not valid. */
+class NmeaDecoder {
+   public:
+    static constexpr size_t max_length = 82;
+
+    decoded_record_callback on_record{};
+
+    void push(const uint8_t* data, size_t length);
+    void reset();
+
+   private:
+    bool check() const;
+
+    uint8_t buffer_[max_length]{};
+    size_t length_{0};
+    bool in_sentence_{false};
+};
+
+/* Modbus RTU frames: address, function, data, CRC16 (low byte first).
+ * A frame ends as soon as the bytes collected so far carry a valid CRC. A pause longer than
+ * the inter-frame gap drops what was collected (reported as not valid), so the decoder
+ * resynchronizes after noise. The time is only as exact as the caller's timestamps. */
+class ModbusRtuDecoder {
+   public:
+    static constexpr size_t max_length = 256;
+    static constexpr size_t min_length = 4;
+
+    decoded_record_callback on_record{};
+
+    // the gap is 3.5 characters, but at least 1750us as the standard asks for fast links
+    void set_baudrate(uint32_t baudrate);
+    void set_gap(uint32_t gap_us) { gap_us_ = gap_us; }
+    void push(const uint8_t* data, size_t length, uint32_t time_us);
+    void reset();
+
+    static uint16_t crc16(const uint8_t* data, size_t length);
+
+   private:
+    void emit(bool valid);
+
+    uint8_t buffer_[max_length]{};
+    size_t length_{0};
+    uint16_t crc_{0xFFFF};  // running over all bytes, 0 once the frame's own crc is included
+    uint32_t gap_us_{1750};
+    uint32_t last_time_us_{0};
+};
+
+/* SLIP (RFC 1055) frames between END bytes. Invalid escapes mark the frame as not valid. */
+class SlipDecoder {
+   public:
+    static constexpr size_t max_length = 256;
+
+    decoded_record_callback on_record{};
+
+    void push(const uint8_t* data, size_t length);
+    void reset();
+
+   private:
+    uint8_t buffer_[max_length]{};
+    size_t length_{0};
+    bool escape_{false};
+    bool valid_{true};
+};
+
+/* COBS frames terminated by a zero byte, decoded on the fly. */
+class CobsDecoder {
+   public:
+    static constexpr size_t max_length = 256;
+
+    decoded_record_callback on_record{};
+
+    void push(const uint8_t* data, size_t length);
+    void reset();
+
+   private:
+    uint8_t buffer_[max_length]{};
+    size_t length_{0};
+    uint8_t code_{0};       // bytes left in the current block including the code byte
+    bool zero_pending_{false};  // the finished block was shorter than 0xFF, a zero follows unless the frame ends
+    bool valid_{true};
+};
+
+#endif /*__PROTOCOL_DECODERS_H__*/
@@ -29,6 +29,7 @@
 
 #include "ui/ui.hpp"
 #include "ui/ff.h"
+#include "pp_protocol.hpp"
 
 #define CURRENT_STANDALONE_APPLICATION_API_VERSION 4
 
@@ -95,17 +96,6 @@ struct standalone_application_api_t {
 
 extern const standalone_application_api_t* _api;
 
-enum app_location_t : uint32_t {
-    UTILITIES = 0,
-    RX,
-    TX,
-    DEBUG,
-    HOME,
-    SETTINGS,
-    GAMES,
-    TRX
-};
-
 struct standalone_application_information_t {
     uint32_t header_version;
 
@@ -1,26 +1,59 @@
 #include "standaloneviewmirror.hpp"
+#include "app_allocator.hpp"
+#include "alloc_tracker.hpp"
+#include "paint_profiler.hpp"
+
+// the hooks below go through the tracker when it is compiled in, it forwards to the allocator
+#if APP_ALLOC_TRACKING
+#define app_heap alloc_tracker
+#else
+#define app_heap app_allocator
+#endif
 
 ui::StandaloneViewMirror* standaloneViewMirror = nullptr;
 ui::Context* context = nullptr;
 const standalone_application_api_t* _api;
 
+static void flush_touch_move();
+
 // event 1 == frame sync. called each 1/60th of second, so 6 = 100ms
 extern "C" void on_event(const uint32_t& events) {
     if (events & 1) {
+        app_allocator.frame_begin();
+        flush_touch_move();
         if (standaloneViewMirror)
             standaloneViewMirror->on_framesync();
+        app_allocator.frame_end();
+#if APP_ALLOC_TRACKING
+        alloc_tracker.frame_end();
+#endif
+#if APP_PAINT_PROFILING
+        paint_profiler.frame_end();
+#endif
     }
 }
 
 extern "C" void shutdown() {
+    // the worker thread runs app code, it has to end before the image is unloaded
+    io_worker.stop();
     delete standaloneViewMirror;
     delete context;
+#if APP_ALLOC_TRACKING
+    // what is still in use here was leaked by the app
+    alloc_tracker.dump();
+#endif
+#if APP_PAINT_PROFILING
+    paint_profiler.dump();
+#endif
+    app_allocator.shutdown();
 }
 
 extern "C" void PaintViewMirror() {
+    app_allocator.frame_begin();
     ui::Painter painter;
     if (standaloneViewMirror)
         painter.paint_widget_tree(standaloneViewMirror);
+    app_allocator.frame_end();
 }
 
 ui::Widget* touch_widget(ui::Widget* const w, ui::TouchEvent event) {
@@ -47,10 +80,36 @@ ui::Widget* touch_widget(ui::Widget* const w, ui::TouchEvent event) {
 
 ui::Widget* captured_widget{nullptr};
 
+// a drag reports moves faster than frames are drawn, the latest one waits for the next frame sync
+// and replaces those before it, so a widget redraws once per frame at most
+static bool touch_move_pending{false};
+static ui::Point touch_move_point{};
+
+static void flush_touch_move() {
+    if (!touch_move_pending)
+        return;
+
+    touch_move_pending = false;
+    if (standaloneViewMirror && captured_widget)
+        captured_widget->on_touch({touch_move_point, ui::TouchEvent::Type::Move});
+}
+
 extern "C" bool OnTouchEvent(int x, int y, uint32_t type) {
     if (standaloneViewMirror) {
         ui::TouchEvent event{{x, y}, static_cast<ui::TouchEvent::Type>(type)};
 
+        if (event.type == ui::TouchEvent::Type::Move) {
+            if (captured_widget == nullptr)
+                return false;
+
+            touch_move_pending = true;
+            touch_move_point = event.point;
+            return true;
+        }
+
+        // the last position of a drag reaches the widget before it ends
+        flush_touch_move();
+
         if (event.type == ui::TouchEvent::Type::Start) {
             captured_widget = touch_widget(standaloneViewMirror, event);
 
@@ -115,32 +174,35 @@ extern "C" bool OnKeyboad(uint8_t key) {
     return false;
 }
 
+// the host simulator keeps the allocator and abort() of its c library
+#ifndef PP_SIMULATOR
 /* Implementing abort() eliminates requirement for _getpid(), _kill(), _exit(). */
 extern "C" void abort() {
     while (true);
 }
 
-// replace memory allocations to use heap from chibios
+// replace memory allocations, small blocks come from the app's pools and frame arena, the rest from the heap of chibios
 extern "C" void* malloc(size_t size) {
-    return _api->malloc(size);
+    return app_heap.allocate(size);
 }
 extern "C" void* calloc(size_t num, size_t size) {
-    return _api->calloc(num, size);
+    return app_heap.allocate_zeroed(num, size);
 }
 extern "C" void* realloc(void* p, size_t size) {
-    return _api->realloc(p, size);
+    return app_heap.reallocate(p, size);
 }
 extern "C" void free(void* p) {
-    _api->free(p);
+    app_heap.release(p);
 }
 
 // redirect std lib memory allocations (sprintf, etc.)
 extern "C" void* __wrap__malloc_r(size_t size) {
-    return _api->malloc(size);
+    return app_heap.allocate(size);
 }
 extern "C" void __wrap__free_r(void* p) {
-    _api->free(p);
+    app_heap.release(p);
 }
+#endif
 
 // redirect file I/O
 
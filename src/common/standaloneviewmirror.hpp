@@ -2,6 +2,10 @@
 #include "standalone_application.hpp"
 
 #include "ui_navigation.hpp"
+#include "frame_scheduler.hpp"
+#include "i2c_queue.hpp"
+#include "task_runner.hpp"
+#include "io_worker.hpp"
 
 namespace ui {
 
@@ -12,10 +16,24 @@ class StandaloneViewMirror : public NavigationView {
         set_style(ui::Theme::getInstance()->bg_darker);
     }
 
+    // timers of the top view fire first, views that still poll on every frame get on_framesync afterwards,
+    // then queued module requests, finished file reads and background tasks run within their budgets
     void on_framesync() {
-        if (view_stack.size() > 0 && view_stack.back().view) {
-            view_stack.back().view->on_framesync();
+        frame_scheduler.tick(top_view());
+
+        // a timer may have pushed or popped a view
+        if (View* top = top_view()) {
+            top->on_framesync();
         }
+
+        i2c_queue.poll(I2C_QUEUE_FRAME_BUDGET_US);
+        io_worker.poll(IO_WORKER_FRAME_BUDGET_US);
+        task_runner.run(top_view(), TASK_RUNNER_FRAME_BUDGET_US);
+    }
+
+   private:
+    View* top_view() const {
+        return view_stack.size() > 0 ? view_stack.back().view.get() : nullptr;
     }
 };
 
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+
+#include "task_runner.hpp"
+#include "cycle_counter.hpp"
+
+#include <utility>
+
+constinit TaskRunner task_runner;
+
+// new tasks queue up behind the running ones, so every task gets its turn
+void TaskRunner::link(BackgroundTask* task) {
+    task->prev_ = tail_;
+    task->next_ = nullptr;
+    if (tail_)
+        tail_->next_ = task;
+    else
+        head_ = task;
+    tail_ = task;
+    count_++;
+}
+
+void TaskRunner::unlink(BackgroundTask* task) {
+    if (next_ == task)
+        next_ = task->next_;
+    if (running_ == task)
+        running_ = nullptr;
+
+    if (task->prev_)
+        task->prev_->next_ = task->next_;
+    else
+        head_ = task->next_;
+
+    if (task->next_)
+        task->next_->prev_ = task->prev_;
+    else
+        tail_ = task->prev_;
+
+    task->prev_ = nullptr;
+    task->next_ = nullptr;
+    count_--;
+}
+
+void TaskRunner::run_step(BackgroundTask* task) {
+    // the step runs from a local, so the task may be restarted or destroyed by it
+    TaskStep step = std::move(task->step_);
+    running_ = task;
+    bool more = step();
+
+    if (running_ != task)
+        return;
+    running_ = nullptr;
+    task->step_ = std::move(step);
+
+    std::function<void()> on_done;
+    if (more == false) {
+        unlink(task);
+        task->started_ = false;
+        task->step_ = nullptr;
+        on_done = std::move(task->on_done_);
+    }
+
+    // called from copies and nothing touches the task afterwards, the callbacks may restart or destroy it
+    if (task->progress_changed_ && task->on_progress) {
+        task->progress_changed_ = false;
+        auto on_progress = task->on_progress;
+        on_progress(task->done_, task->total_);
+    }
+
+    if (on_done)
+        on_done();
+}
+
+void TaskRunner::run(const ui::Widget* top, uint32_t budget_us) {
+    if (head_ == nullptr)
+        return;
+
+    if (clock_ == nullptr) {
+        cycle_counter_enable();
+        clock_ = cycle_counter_now;
+    }
+
+    uint32_t start = clock_();
+    uint32_t budget = budget_us * (CYCLE_COUNTER_HZ / 1000000);
+
+    // stops once every task was passed over without one of them running
+    for (size_t skipped = 0; head_ && skipped < count_;) {
+        BackgroundTask* task = next_ ? next_ : head_;
+        next_ = task->next_;
+
+        if (task->owner_ && task->owner_ != top) {
+            skipped++;
+            continue;
+        }
+        skipped = 0;
+
+        run_step(task);
+
+        if (clock_() - start >= budget)
+            break;
+    }
+}
+
+void BackgroundTask::start(const ui::Widget* owner, TaskStep step, std::function<void()> on_done) {
+    cancel();
+
+    owner_ = owner;
+    step_ = std::move(step);
+    on_done_ = std::move(on_done);
+    done_ = 0;
+    total_ = 0;
+    progress_changed_ = false;
+    started_ = true;
+    task_runner.link(this);
+}
+
+void BackgroundTask::cancel() {
+    if (started_ == false)
+        return;
+
+    task_runner.unlink(this);
+    started_ = false;
+    step_ = nullptr;
+    on_done_ = nullptr;
+}
+
+void BackgroundTask::set_progress(uint32_t done, uint32_t total) {
+    if (done == done_ && total == total_)
+        return;
+
+    done_ = done;
+    total_ = total;
+    progress_changed_ = true;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+
+#ifndef __TASK_RUNNER_H__
+#define __TASK_RUNNER_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace ui {
+class Widget;
+}
+
+/* Cooperative background jobs, so long work does not block a callback for many frames.
+ * A job is a step function that does a small slice of the work and returns true while there is more to do,
+ * keeping its position in the captures or the owning object. StandaloneViewMirror::on_framesync runs the steps
+ * of all started tasks in turn until the time budget of the frame is used up, but at least one step.
+ * A task belongs to a view and pauses while another view covers it, like the frame timers.
+ * Tasks are members of their view, destroying the view cancels them.
+ * A step or callback may start, cancel or destroy any task, including its own. */
+
+#ifndef TASK_RUNNER_FRAME_BUDGET_US
+#define TASK_RUNNER_FRAME_BUDGET_US 4000
+#endif
+
+// does a slice of the work, returns false once the job is complete
+typedef std::function<bool()> TaskStep;
+
+class BackgroundTask;
+
+class TaskRunner {
+   public:
+    constexpr TaskRunner() = default;
+
+    TaskRunner(const TaskRunner&) = delete;
+    TaskRunner& operator=(const TaskRunner&) = delete;
+
+    // runs the steps of the tasks whose view is top round robin until budget_us have passed
+    void run(const ui::Widget* top, uint32_t budget_us);
+
+    bool is_idle() const { return head_ == nullptr; }
+
+    // for tests, the default clock is the cycle counter
+    void set_clock(uint32_t (*clock)()) { clock_ = clock; }
+
+   private:
+    friend class BackgroundTask;
+
+    void link(BackgroundTask* task);
+    void unlink(BackgroundTask* task);
+    void run_step(BackgroundTask* task);
+
+    BackgroundTask* head_{nullptr};
+    BackgroundTask* tail_{nullptr};
+    BackgroundTask* next_{nullptr};     // runs next, nullptr starts over at head_
+    BackgroundTask* running_{nullptr};  // cleared when the running task is cancelled or restarted by its step
+    size_t count_{0};
+    uint32_t (*clock_)(){nullptr};
+};
+
+extern TaskRunner task_runner;
+
+class BackgroundTask {
+   public:
+    BackgroundTask() = default;
+    ~BackgroundTask() { cancel(); }
+
+    BackgroundTask(const BackgroundTask&) = delete;
+    BackgroundTask& operator=(const BackgroundTask&) = delete;
+
+    // called after the step that reported new progress and with the final progress before on_done
+    std::function<void(uint32_t done, uint32_t total)> on_progress{};
+
+    // (re)starts the job for the view owner, nullptr runs it whatever view is top
+    // on_done runs after the last step, not when the task is cancelled
+    void start(const ui::Widget* owner, TaskStep step, std::function<void()> on_done = {});
+    void cancel();
+
+    // for the step, reported through on_progress once the step returns
+    void set_progress(uint32_t done, uint32_t total);
+
+    bool is_running() const { return started_; }
+
+   private:
+    friend class TaskRunner;
+
+    const ui::Widget* owner_{nullptr};
+    TaskStep step_{};
+    std::function<void()> on_done_{};
+    uint32_t done_{0};
+    uint32_t total_{0};
+    bool progress_changed_{false};
+    bool started_{false};
+    BackgroundTask* prev_{nullptr};
+    BackgroundTask* next_{nullptr};
+};
+
+#endif /*__TASK_RUNNER_H__*/
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __CONSOLE_HISTORY_H__
+#define __CONSOLE_HISTORY_H__
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>
+#include <memory>
+
+/* Fixed-size ring of console rows for scrollback.
+ * Every cell keeps the character and its term_colors index, rows wrap
+ * at the console width like the screen does. The rows are allocated once,
+ * appending a character or a row is O(1) and overwrites the oldest row
+ * when the ring is full. */
+class ConsoleHistory {
+   public:
+    static constexpr size_t max_columns = 40;
+    static constexpr uint8_t default_color = 0xFF;
+
+    struct Row {
+        uint8_t length;
+        char text[max_columns];
+        uint8_t color[max_columns];
+    };
+
+    ConsoleHistory(size_t capacity, size_t columns)
+        : rows_{std::make_unique<Row[]>(capacity)},
+          capacity_{capacity},
+          columns_{columns < max_columns ? columns : max_columns} {
+        clear();
+    }
+
+    ConsoleHistory(const ConsoleHistory&) = delete;
+    ConsoleHistory& operator=(const ConsoleHistory&) = delete;
+
+    void put(char c, uint8_t color) {
+        if (cursor_ >= columns_)
+            new_line();
+
+        Row& row = current();
+        row.text[cursor_] = c;
+        row.color[cursor_] = color;
+        cursor_++;
+
+        if (cursor_ > row.length)
+            row.length = cursor_;
+    }
+
+    void new_line() {
+        added_++;
+
+        if (count_ < capacity_)
+            count_++;
+        else
+            head_ = head_ + 1 < capacity_ ? head_ + 1 : 0;
+
+        current().length = 0;
+        cursor_ = 0;
+    }
+
+    // like on the screen, following characters overwrite the row
+    void carriage_return() {
+        cursor_ = 0;
+    }
+
+    void clear() {
+        head_ = 0;
+        count_ = 1;
+        cursor_ = 0;
+        rows_[0].length = 0;
+    }
+
+    // rows stored, the last one is the row being written
+    size_t size() const {
+        return count_;
+    }
+
+    // 0 is the oldest row
+    const Row& row(size_t index) const {
+        index += head_;
+        if (index >= capacity_)
+            index -= capacity_;
+        return rows_[index];
+    }
+
+    size_t columns() const {
+        return columns_;
+    }
+
+    size_t cursor() const {
+        return cursor_;
+    }
+
+    // rows started so far, tells how far the content moved between two calls
+    size_t added() const {
+        return added_;
+    }
+
+   private:
+    Row& current() {
+        return const_cast<Row&>(row(count_ - 1));
+    }
+
+    std::unique_ptr<Row[]> rows_;
+    const size_t capacity_;
+    const size_t columns_;
+    size_t head_{0};
+    size_t count_{1};
+    size_t cursor_{0};
+    size_t added_{0};
+};
+
+#endif /*__CONSOLE_HISTORY_H__*/
@@ -187,6 +187,8 @@ GeoMap::GeoMap(
 }
 
 bool GeoMap::on_encoder(const EncoderEvent delta) {
+    kinetic_timer.stop();
+
     // Valid map_zoom values are -2 to -MAX_MAP_ZOOM_OUT, and +1 to +MAX_MAP_ZOOM_IN (values of 0 and -1 are not permitted)
     if (delta > 0) {
         if (map_zoom < MAX_MAP_ZOOM_IN) {
@@ -360,6 +362,14 @@ GeoPoint GeoMap::lat_lon_to_map_pixel(float lat, float lon) {
     return {x, y};
 }
 
+// inverse of lat_lon_to_map_pixel
+void GeoMap::map_pixel_to_lat_lon(GeoPoint point, float& lat, float& lon) {
+    lon = point.x * 360 / map_width - 180;
+
+    double m = (map_height - point.y + map_offset) / (map_world_lon / 2);
+    lat = asin(tanh(m / 2)) * 180 / pi;
+}
+
 // Draw grid in place of map (when zoom-in level is too high).
 void GeoMap::draw_map_grid(ui::Rect r, Painter& painter) {
     // Grid spacing is just based on zoom at the moment, and centered on screen.
@@ -381,12 +391,12 @@ void GeoMap::draw_map_grid(ui::Rect r, Painter& painter) {
     }
 }
 
-double GeoMap::tile_pixel_x_to_lon(int x, int zoom) {
+double GeoMap::tile_pixel_x_to_lon(double x, int zoom) {
     double map_width = pow(2.0, zoom) * TILE_SIZE;
     return (x / map_width * 360.0) - 180.0;
 }
 
-double GeoMap::tile_pixel_y_to_lat(int y, int zoom) {
+double GeoMap::tile_pixel_y_to_lat(double y, int zoom) {
     double map_height = pow(2.0, zoom) * TILE_SIZE;
     double n = M_PI * (1.0 - 2.0 * y / map_height);
     return atan(sinh(n)) * 180.0 / M_PI;
@@ -402,6 +412,7 @@ double GeoMap::lat_to_pixel_y_tile(double lat, int zoom) {
     return ((1.0 - log((1.0 + sin_lat) / (1.0 - sin_lat)) / (2.0 * M_PI)) / 2.0) * pow(2.0, zoom) * TILE_SIZE;
 }
 
+// draws the next OSM_ROWS_PER_STEP rows of a tile, returns true once the tile is complete
 bool GeoMap::draw_osm_file(int zoom, int tile_x, int tile_y, int relative_x, int relative_y, Painter& painter) {
     const ui::Rect r = screen_rect();
     // Early exit if the tile is completely outside the viewport
@@ -410,8 +421,8 @@ bool GeoMap::draw_osm_file(int zoom, int tile_x, int tile_y, int relative_x, int
         return true;
     }
 
-    BMPFile bmp{};
-    bmp.open("/OSM/" + to_string_dec_int(zoom) + "/" + to_string_dec_int(tile_x) + "/" + to_string_dec_int(tile_y) + ".bmp", true);
+    if (osm_row == 0)
+        osm_bmp.open("/OSM/" + to_string_dec_int(zoom) + "/" + to_string_dec_int(tile_x) + "/" + to_string_dec_int(tile_y) + ".bmp", true);
     // 1. Define the source and destination areas, starting with the full tile.
     int src_x = 0;
     int src_y = 0;
@@ -444,23 +455,97 @@ bool GeoMap::draw_osm_file(int zoom, int tile_x, int tile_y, int relative_x, int
         return true;
     }
 
-    if (!bmp.is_loaded()) {
+    if (!osm_bmp.is_loaded()) {
         // Draw an error rectangle using the calculated clipped dimensions
         ui::Rect error_rect{{dest_x + r.left(), dest_y + r.top()}, {clip_w, clip_h}};
         painter.fill_rectangle(error_rect, Theme::getInstance()->bg_lightest->background);
-        return false;
+        return true;
     }
     std::vector<ui::Color> line(clip_w);
-    for (int y = 0; y < clip_h; ++y) {
+    int end_row = std::min(clip_h, osm_row + OSM_ROWS_PER_STEP);
+    for (int y = osm_row; y < end_row; ++y) {
         int source_row = src_y + y;
         int dest_row = dest_y + y;
-        bmp.seek(src_x, source_row);
+        osm_bmp.seek(src_x, source_row);
         for (int x = 0; x < clip_w; ++x) {
-            bmp.read_next_px(line[x], true);
+            osm_bmp.read_next_px(line[x], true);
         }
         painter.draw_pixels({dest_x + r.left(), dest_row + r.top(), clip_w, 1}, line);
     }
-    return true;
+    osm_row = end_row;
+    return osm_row == clip_h;
+}
+
+void GeoMap::start_osm_viewport() {
+    const auto r = screen_rect();
+
+    //  Convert center GPS to a global pixel coordinate
+    double global_center_px = lon_to_pixel_x_tile(lon_, map_osm_zoom);
+    double global_center_py = lat_to_pixel_y_tile(lat_, map_osm_zoom);
+
+    // Find the top-left corner of the screen (viewport) in global pixel coordinates
+    viewport_top_left_px = global_center_px - (r.width() / 2.0);
+    viewport_top_left_py = global_center_py - (r.height() / 2.0);
+
+    // Find the tile ID that contains the top-left corner of the viewport
+    osm_start_tile_x = floor(viewport_top_left_px / TILE_SIZE);
+    osm_start_tile_y = floor(viewport_top_left_py / TILE_SIZE);
+
+    // Calculate the crucial render offset.
+    // This determines how much the first tile is shifted to align the map correctly.
+    // This value will almost always be negative or zero.
+    osm_render_offset_x = -(viewport_top_left_px - (osm_start_tile_x * TILE_SIZE));
+    osm_render_offset_y = -(viewport_top_left_py - (osm_start_tile_y * TILE_SIZE));
+
+    // Determine how many tiles we need to draw to fill the screen
+    osm_tiles_x = (r.width() / TILE_SIZE) + 2;
+    osm_tiles_y = (r.height() / TILE_SIZE) + 2;
+
+    osm_tile = 0;
+    osm_row = 0;
+
+    // a new position restarts the drawing, so quick moves only draw the last viewport completely
+    // the tiles wait while another view covers this one
+    osm_task.start(
+        owner_view(), [this]() { return draw_osm_step(); },
+        [this]() {
+            osm_bmp.close();
+            Painter painter;
+            draw_overlays(painter);
+        });
+}
+
+// the view on top of the navigation that holds the map
+const View* GeoMap::owner_view() const {
+    const Widget* view = this;
+    while (view->parent() && view->parent()->parent())
+        view = view->parent();
+    return static_cast<const View*>(view);
+}
+
+bool GeoMap::draw_osm_step() {
+    // gone from the screen meanwhile, the viewport is drawn again when it is painted next
+    if (hidden() || !visible()) {
+        redraw_map = true;
+        osm_task.cancel();
+        return false;
+    }
+
+    int x = osm_tile % osm_tiles_x;
+    int y = osm_tile / osm_tiles_x;
+
+    // Calculate the final on-screen drawing position for this tile.
+    // For the first tile (x=0, y=0), this will be the negative offset.
+    int draw_pos_x = round(osm_render_offset_x + x * TILE_SIZE);
+    int draw_pos_y = round(osm_render_offset_y + y * TILE_SIZE);
+
+    Painter painter;
+    if (draw_osm_file(map_osm_zoom, osm_start_tile_x + x, osm_start_tile_y + y, draw_pos_x, draw_pos_y, painter)) {
+        osm_tile++;
+        osm_row = 0;
+    }
+
+    return osm_tile < osm_tiles_x * osm_tiles_y;
 }
 
 void GeoMap::paint(Painter& painter) {
@@ -516,69 +601,51 @@ void GeoMap::paint(Painter& painter) {
                 }
 
             } else {
-                // display osm tiles
-                //  Convert center GPS to a global pixel coordinate
-                double global_center_px = lon_to_pixel_x_tile(lon_, map_osm_zoom);
-                double global_center_py = lat_to_pixel_y_tile(lat_, map_osm_zoom);
-
-                // Find the top-left corner of the screen (viewport) in global pixel coordinates
-                viewport_top_left_px = global_center_px - (r.width() / 2.0);
-                viewport_top_left_py = global_center_py - (r.height() / 2.0);
-
-                // Find the tile ID that contains the top-left corner of the viewport
-                int start_tile_x = floor(viewport_top_left_px / TILE_SIZE);
-                int start_tile_y = floor(viewport_top_left_py / TILE_SIZE);
-
-                // Calculate the crucial render offset.
-                // This determines how much the first tile is shifted to align the map correctly.
-                // This value will almost always be negative or zero.
-                double render_offset_x = -(viewport_top_left_px - (start_tile_x * TILE_SIZE));
-                double render_offset_y = -(viewport_top_left_py - (start_tile_y * TILE_SIZE));
-
-                // Determine how many tiles we need to draw to fill the screen
-                int tiles_needed_x = (r.width() / TILE_SIZE) + 2;
-                int tiles_needed_y = (r.height() / TILE_SIZE) + 2;
-
-                for (int y = 0; y < tiles_needed_y; ++y) {
-                    for (int x = 0; x < tiles_needed_x; ++x) {
-                        int current_tile_x = start_tile_x + x;
-                        int current_tile_y = start_tile_y + y;
-
-                        // Calculate the final on-screen drawing position for this tile.
-                        // For the first tile (x=0, y=0), this will be the negative offset.
-                        int draw_pos_x = round(render_offset_x + x * TILE_SIZE);
-                        int draw_pos_y = round(render_offset_y + y * TILE_SIZE);
-                        if (!draw_osm_file(map_osm_zoom, current_tile_x, current_tile_y, draw_pos_x, draw_pos_y, painter)) {
-                            // already blanked it.
-                        }
-                    }
-                }
+                // display osm tiles, the markers follow once all of them are drawn
+                start_osm_viewport();
+                set_clean();
+                return;
             }
 
         } else {
             // No map data or excessive zoom; just draw a grid
             draw_map_grid(r, painter);
         }
-        // Draw crosshairs in center in manual panning mode
-        if (manual_panning_) {
-            painter.fill_rectangle({r.center() - Point(16, 1) + Point(zoom_pixel_offset, zoom_pixel_offset), {32, 2}}, Color::red());
-            painter.fill_rectangle({r.center() - Point(1, 16) + Point(zoom_pixel_offset, zoom_pixel_offset), {2, 32}}, Color::red());
+        draw_overlays(painter);
+        set_clean();
+    } else if (!osm_task.is_running()) {
+        // Draw the marker in the center
+        if (!manual_panning_ && !hide_center_marker_) {
+            draw_marker(painter, r.center() + Point(zoom_pixel_offset, zoom_pixel_offset), angle_, tag_, Color::red(), Color::white(), Color::black());
         }
+    }
+}
 
-        // Draw the other markers
-        draw_markers(painter);
-        if (!use_osm) draw_scale(painter);
-        draw_mypos(painter);
-        if (has_osm) draw_switcher(painter);
-        set_clean();
+void GeoMap::draw_overlays(Painter& painter) {
+    const auto r = screen_rect();
+
+    // Draw crosshairs in center in manual panning mode
+    if (manual_panning_) {
+        painter.fill_rectangle({r.center() - Point(16, 1) + Point(zoom_pixel_offset, zoom_pixel_offset), {32, 2}}, Color::red());
+        painter.fill_rectangle({r.center() - Point(1, 16) + Point(zoom_pixel_offset, zoom_pixel_offset), {2, 32}}, Color::red());
     }
 
+    // Draw the other markers
+    draw_markers(painter);
+    if (!use_osm) draw_scale(painter);
+    draw_mypos(painter);
+    if (has_osm) draw_switcher(painter);
+
     // Draw the marker in the center
     if (!manual_panning_ && !hide_center_marker_) {
         draw_marker(painter, r.center() + Point(zoom_pixel_offset, zoom_pixel_offset), angle_, tag_, Color::red(), Color::white(), Color::black());
     }
 }
 
+void GeoMap::getWidgetName(std::string& result) {
+    result = "GeoMap";
+}
+
 void GeoMap::draw_switcher(Painter& painter) {
     painter.fill_rectangle({screen_rect().left(), screen_rect().top(), 3 * 20, 20}, Theme::getInstance()->bg_darker->background);
     std::string_view txt = (use_osm) ? "B I N" : "O S M";
@@ -586,6 +653,7 @@ void GeoMap::draw_switcher(Painter& painter) {
 }
 
 bool GeoMap::on_keyboard(KeyboardEvent key) {
+    kinetic_timer.stop();
     if (key == '+' || key == ' ') return on_encoder(1);
     if (key == '-') return on_encoder(-1);
 
@@ -602,21 +670,105 @@ bool GeoMap::on_touch(const TouchEvent event) {
         return false;  // false, because with true this hits 2 times
     }
 
-    if ((event.type == TouchEvent::Type::Start) && (mode_ == PROMPT)) {
-        Point p;
-        set_highlighted(true);
-        if (on_move) {
-            if (!use_osm) {
-                p = event.point - screen_rect().center();
-                on_move(p.x() / 2.0 * lon_ratio, p.y() / 2.0 * lat_ratio, false);
-            } else {
-                p = event.point - screen_rect().location();
-                on_move(tile_pixel_x_to_lon(p.x() + viewport_top_left_px, map_osm_zoom), tile_pixel_y_to_lat(p.y() + viewport_top_left_py, map_osm_zoom), true);
+    switch (event.type) {
+        case TouchEvent::Type::Start:
+            // comes twice, when the widget is looked up and once it is captured
+            kinetic_timer.stop();
+            touch_start = touch_last = event.point;
+            touch_last_frame = frame_scheduler.now();
+            drag_speed_x = drag_speed_y = 0;
+            dragging = false;
+            if (mode_ == PROMPT) set_highlighted(true);
+            return true;
+
+        case TouchEvent::Type::Move: {
+            Point delta = event.point - touch_last;
+            if (!dragging) {
+                Point moved = event.point - touch_start;
+                if (abs(moved.x()) < GEOMAP_DRAG_THRESHOLD && abs(moved.y()) < GEOMAP_DRAG_THRESHOLD)
+                    return true;
+
+                // like editing the position, the map no longer follows the tracked one
+                dragging = true;
+                set_manual_panning(true);
             }
+
+            // the runtime hands on one move per frame, the speed is averaged over the last moves
+            uint32_t frames = frame_scheduler.now() - touch_last_frame;
+            if (frames == 0) frames = 1;
+            drag_speed_x = (drag_speed_x + (float)delta.x() / frames) / 2;
+            drag_speed_y = (drag_speed_y + (float)delta.y() / frames) / 2;
+            touch_last = event.point;
+            touch_last_frame = frame_scheduler.now();
+
+            pan(delta.x(), delta.y());
             return true;
         }
+
+        case TouchEvent::Type::End:
+            if (!dragging) {
+                // a tap in prompt mode picks the position under it
+                if (mode_ == PROMPT && on_move) {
+                    Point p;
+                    if (!use_osm) {
+                        p = touch_start - screen_rect().center();
+                        on_move(p.x() / 2.0 * lon_ratio, p.y() / 2.0 * lat_ratio, false);
+                    } else {
+                        p = touch_start - screen_rect().location();
+                        on_move(tile_pixel_x_to_lon(p.x() + viewport_top_left_px, map_osm_zoom), tile_pixel_y_to_lat(p.y() + viewport_top_left_py, map_osm_zoom), true);
+                    }
+                }
+                return true;
+            }
+
+            dragging = false;
+            if (frame_scheduler.now() - touch_last_frame > GEOMAP_FLING_IDLE_FRAMES)
+                return true;
+
+            if (fabs(drag_speed_x) >= GEOMAP_KINETIC_MIN_SPEED || fabs(drag_speed_y) >= GEOMAP_KINETIC_MIN_SPEED) {
+                kinetic_timer.set_owner(owner_view());
+                kinetic_timer.start_frames(1, true);
+            }
+            return true;
+
+        default:
+            return false;
     }
-    return false;
+}
+
+// one frame of a fling, slowing down until the map stops
+void GeoMap::kinetic_step() {
+    if (fabs(drag_speed_x) < GEOMAP_KINETIC_MIN_SPEED && fabs(drag_speed_y) < GEOMAP_KINETIC_MIN_SPEED) {
+        kinetic_timer.stop();
+        return;
+    }
+
+    pan(drag_speed_x, drag_speed_y);
+    drag_speed_x *= GEOMAP_KINETIC_FRICTION;
+    drag_speed_y *= GEOMAP_KINETIC_FRICTION;
+}
+
+void GeoMap::pan(float dx, float dy) {
+    float lon, lat;
+    if (use_osm) {
+        lon = tile_pixel_x_to_lon(lon_to_pixel_x_tile(lon_, map_osm_zoom) - dx, map_osm_zoom);
+        lat = tile_pixel_y_to_lat(lat_to_pixel_y_tile(lat_, map_osm_zoom) - dy, map_osm_zoom);
+    } else {
+        // screen pixels per map file pixel
+        float scale = (map_zoom > 0) ? map_zoom : 1.0f / -map_zoom;
+        GeoPoint p = lat_lon_to_map_pixel(lat_, lon_);
+        map_pixel_to_lat_lon({p.x - dx / scale, p.y - dy / scale}, lat, lon);
+    }
+
+    // both projections end at about 85 degrees, the longitude wraps around
+    if (lat > 85.0f) lat = 85.0f;
+    if (lat < -85.0f) lat = -85.0f;
+    if (lon < -180.0f) lon += 360.0f;
+    if (lon >= 180.0f) lon -= 360.0f;
+
+    move(lon, lat);
+    set_dirty();
+    if (on_move) on_move(lon, lat, true);
 }
 
 void GeoMap::move(const float lon, const float lat) {
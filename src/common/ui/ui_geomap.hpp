@@ -29,6 +29,8 @@
 #include "file.hpp"
 #include "bmpfile.hpp"
 #include "mathdef.hpp"
+#include "task_runner.hpp"
+#include "frame_scheduler.hpp"
 #include <string_view>
 
 namespace ui {
@@ -45,6 +47,16 @@ namespace ui {
 #define GEOMAP_RECT_HEIGHT (320 - 16 - GEOMAP_BANNER_HEIGHT)
 
 #define TILE_SIZE 256
+// tile rows drawn per step of the background task, a row is read pixel by pixel from the sd card
+#define OSM_ROWS_PER_STEP 16
+
+// a touch has to move this many pixels before it drags the map instead of tapping it
+#define GEOMAP_DRAG_THRESHOLD 4
+// share of its speed a flung map keeps from one frame to the next, it stops below the minimum (pixels per frame)
+#define GEOMAP_KINETIC_FRICTION 0.9f
+#define GEOMAP_KINETIC_MIN_SPEED 0.5f
+// a drag held still for longer than this before the release does not fling
+#define GEOMAP_FLING_IDLE_FRAMES 3
 
 enum GeoMapMode {
     DISPLAY,
@@ -208,6 +220,7 @@ class GeoMap : public Widget {
     GeoMap(Rect parent_rect);
 
     void paint(Painter& painter) override;
+    void getWidgetName(std::string& result) override;
 
     bool on_touch(const TouchEvent event) override;
     bool on_encoder(const EncoderEvent delta) override;
@@ -250,6 +263,7 @@ class GeoMap : public Widget {
     void draw_scale(Painter& painter);
     ui::Point item_rect_pixel(GeoMarker& item);
     GeoPoint lat_lon_to_map_pixel(float lat, float lon);
+    void map_pixel_to_lat_lon(GeoPoint point, float& lat, float& lon);
     void draw_marker_item(Painter& painter, GeoMarker& item, const Color color, const Color fontColor = Color::white(), const Color backColor = Color::black());
     void draw_marker(Painter& painter, const ui::Point itemPoint, const uint16_t itemAngle, const std::string itemTag, const Color color = Color::red(), const Color fontColor = Color::white(), const Color backColor = Color::black());
     void draw_markers(Painter& painter);
@@ -262,16 +276,40 @@ class GeoMap : public Widget {
     uint8_t find_osm_file_tile();
     void set_osm_max_zoom();
     bool draw_osm_file(int zoom, int tile_x, int tile_y, int relative_x, int relative_y, Painter& painter);
+    void start_osm_viewport();
+    bool draw_osm_step();
+    void draw_overlays(Painter& painter);
+    const View* owner_view() const;
+    // drag to pan, moves the map by screen pixels
+    void pan(float dx, float dy);
+    void kinetic_step();
     int lon2tile(double lon, int zoom);
     int lat2tile(double lat, int zoom);
     double lon_to_pixel_x_tile(double lon, int zoom);
     double lat_to_pixel_y_tile(double lat, int zoom);
-    double tile_pixel_x_to_lon(int x, int zoom);
-    double tile_pixel_y_to_lat(int y, int zoom);
+    double tile_pixel_x_to_lon(double x, int zoom);
+    double tile_pixel_y_to_lat(double y, int zoom);
     uint8_t map_osm_zoom{3};
     double viewport_top_left_px = 0;
     double viewport_top_left_py = 0;
 
+    // the tiles of the viewport are drawn in the background, the markers once they are complete
+    BackgroundTask osm_task{};
+    BMPFile osm_bmp{};
+    int osm_start_tile_x{0}, osm_start_tile_y{0};
+    double osm_render_offset_x{0}, osm_render_offset_y{0};
+    int osm_tiles_x{0}, osm_tiles_y{0};
+    int osm_tile{0};  // index of the tile being drawn, row by row
+    int osm_row{0};   // next row of that tile, 0 opens its file
+
+    // the map follows a dragging touch and glides on after a fling, one step per frame
+    FrameTimer kinetic_timer{nullptr, [this]() { kinetic_step(); }};
+    Point touch_start{};
+    Point touch_last{};
+    uint32_t touch_last_frame{0};
+    float drag_speed_x{0}, drag_speed_y{0};  // pixels per frame
+    bool dragging{false};
+
     bool manual_panning_{false};
     bool hide_center_marker_{false};
     GeoMapMode mode_{};
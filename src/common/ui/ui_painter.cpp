@@ -23,6 +23,7 @@
 #include "ui_widget.hpp"
 // #include "portapack.hpp"
 #include "standalone_application.hpp"
+#include "paint_profiler.hpp"
 
 // using namespace portapack;
 
@@ -37,6 +38,7 @@ Style Style::invert() const {
 
 int Painter::draw_char(Point p, const Style& style, char c) {
     const auto glyph = style.font.glyph(c);
+    paint_profile(PaintCall::DRAW_BITMAP, glyph.size().width() * glyph.size().height());
     _api->draw_bitmap(p.x(), p.y(), glyph.size().width(), glyph.size().height(), glyph.pixels(), style.foreground.v, style.background.v);
     return glyph.advance().x();
 }
@@ -67,6 +69,7 @@ int Painter::draw_string(
                 escape = true;
             } else {
                 const auto glyph = font.glyph(c);
+                paint_profile(PaintCall::DRAW_BITMAP, glyph.size().width() * glyph.size().height());
                 _api->draw_bitmap(p.x(), p.y(), glyph.size().width(), glyph.size().height(), glyph.pixels(), pen.v, background.v);
                 const auto advance = glyph.advance();
                 p += advance;
@@ -83,14 +86,17 @@ void Painter::draw_bitmap(Point p, const Bitmap& bitmap, Color foreground, Color
     if ((background.v == ui::Color::white().v) && (foreground.to_greyscale() > 146))
         foreground = foreground.dark();
 
+    paint_profile(PaintCall::DRAW_BITMAP, bitmap.size.width() * bitmap.size.height());
     _api->draw_bitmap(p.x(), p.y(), bitmap.size.width(), bitmap.size.height(), bitmap.data, foreground.v, background.v);
 }
 
 void Painter::draw_hline(Point p, int width, Color c) {
+    paint_profile(PaintCall::FILL_RECTANGLE, width);
     _api->fill_rectangle(p.x(), p.y(), width, 1, c.v);
 }
 
 void Painter::draw_vline(Point p, int height, Color c) {
+    paint_profile(PaintCall::FILL_RECTANGLE, height);
     _api->fill_rectangle(p.x(), p.y(), 1, height, c.v);
 }
 
@@ -102,10 +108,12 @@ void Painter::draw_rectangle(Rect r, Color c) {
 }
 
 void Painter::fill_rectangle(Rect r, Color c) {
+    paint_profile(PaintCall::FILL_RECTANGLE, r.width() * r.height());
     _api->fill_rectangle(r.left(), r.top(), r.width(), r.height(), c.v);
 }
 
 void Painter::fill_rectangle_unrolled8(Rect r, Color c) {
+    paint_profile(PaintCall::FILL_UNROLLED8, r.width() * r.height());
     _api->fill_rectangle_unrolled8(r.left(), r.top(), r.width(), r.height(), c.v);
 }
 
@@ -125,7 +133,10 @@ void Painter::paint_widget(Widget* w) {
         w->visible(true);
 
         if (w->dirty()) {
-            w->paint(*this);
+            {
+                PaintProfileScope profile_scope{w};
+                w->paint(*this);
+            }
             // Force-paint all children.
             for (const auto child : w->children()) {
                 child->set_dirty();
@@ -142,10 +153,12 @@ void Painter::paint_widget(Widget* w) {
 }
 
 void Painter::draw_pixel(const ui::Point p, const ui::Color color) {
+    paint_profile(PaintCall::DRAW_PIXEL, 1);
     _api->draw_pixel(p, color);
 }
 
 void Painter::draw_pixels(const ui::Rect r, const ui::Color* const colors, const size_t count) {
+    paint_profile(PaintCall::DRAW_PIXELS, count);
     _api->draw_pixels(r, colors, count);
 }
 
@@ -24,9 +24,11 @@
 #include "ui_painter.hpp"
 // #include "portapack.hpp"
 #include "standalone_application.hpp"
+#include "paint_profiler.hpp"
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
 
 // #include "chprintf.h"
@@ -679,60 +681,156 @@ Console::Console(
 }
 
 void Console::clear(bool clear_buffer = false) {
-    if (clear_buffer)
+    if (clear_buffer) {
         buffer.clear();
 
+        if (history) {
+            history->clear();
+            scroll_back = 0;
+        }
+    }
+
     if (!hidden() && visible()) {
+        PaintProfileScope profile_scope{this};
+        paint_profile(PaintCall::FILL_RECTANGLE, screen_rect().width() * screen_rect().height());
         _api->fill_rectangle(screen_rect().left(), screen_rect().top(), screen_rect().width(), screen_rect().height(), Theme::getInstance()->bg_darkest->background.v);
     }
 
     pos = {0, 0};
 }
 
+// glyphs are collected into a 1bpp strip and drawn with one draw_bitmap call per run,
+// 40 glyphs of the 8x16 font cover a 320 pixel wide line
+#define CONSOLE_RUN_MAX_BITS (40 * 8 * 16)
+static uint8_t console_strip[CONSOLE_RUN_MAX_BITS / 8];
+
+// the lcd has a single hardware scroll area, the widget that set it up last owns it
+static const Widget* scroll_area_owner = nullptr;
+
+// the console and the hex dump fill rows without a painter
+static void fill_row(int x, int y, int width, int height, Color color) {
+    paint_profile(PaintCall::FILL_RECTANGLE, width * height);
+    _api->fill_rectangle(x, y, width, height, color.v);
+}
+
 void Console::write(std::string message) {
+    PaintProfileScope profile_scope{this};
     bool escape = false;
 
+    // the history is drawn by paint() when hidden and is kept on screen while scrolled back
+    if (history) {
+        record(message);
+        if (hidden() || !visible() || scroll_back > 0)
+            return;
+    }
+
     if (!hidden() && visible()) {
         const Style& s = style();
         const Font& font = s.font;
         auto rect = screen_rect();
         ui::Color pen_color = s.foreground;
 
-        for (auto c : message) {
+        // a run is a stretch of glyphs with the same color on the same line
+        const size_t run_max = CONSOLE_RUN_MAX_BITS / (font.char_width() * font.line_height());
+        size_t run_start = 0;
+        size_t run_length = 0;
+        Point run_pos = pos;
+
+        for (size_t i = 0; i < message.size(); i++) {
+            char c = message[i];
+
             if (escape) {
                 if (c < std::size(term_colors))
                     pen_color = term_colors[(uint8_t)c];
                 else
                     pen_color = s.foreground;
                 escape = false;
-            } else {
-                if (c == '\n') {
+            } else if (c == '\n' || c == '\r' || c == '\x1B') {
+                draw_run(message.data() + run_start, run_length, run_pos, pen_color);
+                run_length = 0;
+
+                if (c == '\n')
                     crlf();
-                } else if (c == '\r') {
+                else if (c == '\r')
                     pos = {0, pos.y()};
-                } else if (c == '\x1B') {
+                else
                     escape = true;
-                } else {
-                    auto glyph = font.glyph(c);
-                    auto advance = glyph.advance();
-                    // Would drawing next character be off the end? Newline.
-                    if ((pos.x() + advance.x()) > rect.width())
-                        crlf();
+            } else {
+                auto advance = font.glyph(c).advance();
+                // Would drawing next character be off the end? Newline.
+                if ((pos.x() + advance.x()) > rect.width()) {
+                    draw_run(message.data() + run_start, run_length, run_pos, pen_color);
+                    run_length = 0;
+                    crlf();
+                }
 
-                    Point pos_glyph{rect.left() + pos.x(), _api->scroll_area_y(pos.y())};
-                    _api->draw_bitmap(pos_glyph.x(), pos_glyph.y(), glyph.size().width(), glyph.size().height(), glyph.pixels(), pen_color.v, s.background.v);
+                if (run_length == run_max) {
+                    draw_run(message.data() + run_start, run_length, run_pos, pen_color);
+                    run_length = 0;
+                }
 
-                    pos += {advance.x(), 0};
+                if (run_length == 0) {
+                    run_start = i;
+                    run_pos = pos;
                 }
+
+                run_length++;
+                pos += {advance.x(), 0};
             }
         }
-        buffer = message;
+
+        draw_run(message.data() + run_start, run_length, run_pos, pen_color);
+        if (!history)
+            buffer = message;
     } else {
         if (buffer.size() < 256)
             buffer += message;
     }
 }
 
+// draws the glyphs as one bitmap at a screen position
+static void draw_glyph_run(const Font& font, const char* text, size_t length, Coord screen_x, Coord screen_y, Color color, Color background) {
+    if (length == 0)
+        return;
+
+    const size_t glyph_width = font.char_width();
+    const size_t glyph_height = font.line_height();
+    const size_t width = glyph_width * length;
+
+    memset(console_strip, 0, (width * glyph_height + 7) / 8);
+
+    for (size_t i = 0; i < length; i++) {
+        const uint8_t* pixels = font.glyph(text[i]).pixels();
+        const size_t x0 = i * glyph_width;
+
+        // glyph and strip are bit streams, rows of 8 pixel glyphs are whole bytes in both
+        if (glyph_width == 8) {
+            for (size_t y = 0; y < glyph_height; y++)
+                console_strip[(y * width + x0) >> 3] = pixels[y];
+            continue;
+        }
+
+        for (size_t y = 0; y < glyph_height; y++) {
+            for (size_t x = 0; x < glyph_width; x++) {
+                size_t source = y * glyph_width + x;
+                if ((pixels[source >> 3] & (1U << (source & 7))) == 0)
+                    continue;
+
+                size_t target = y * width + x0 + x;
+                console_strip[target >> 3] |= 1U << (target & 7);
+            }
+        }
+    }
+
+    paint_profile(PaintCall::DRAW_BITMAP, width * glyph_height);
+    _api->draw_bitmap(screen_x, screen_y, width, glyph_height, console_strip, color.v, background.v);
+}
+
+void Console::draw_run(const char* text, size_t length, Point position, Color color) {
+    const Style& s = style();
+    draw_glyph_run(s.font, text, length, screen_rect().left() + position.x(), _api->scroll_area_y(position.y()), color, s.background);
+}
+
 void Console::getAccessibilityText(std::string& result) {
     result = "{" + buffer + "}";
 }
@@ -745,7 +843,161 @@ void Console::writeln(std::string message) {
 }
 
 void Console::paint(Painter&) {
-    write(buffer);
+    if (history)
+        draw_history();
+    else
+        write(buffer);
+}
+
+void Console::enable_history(size_t rows) {
+    history = std::make_unique<ConsoleHistory>(rows, size().width() / style().font.char_width());
+    scroll_back = 0;
+    set_focusable(true);
+}
+
+void Console::record(const std::string& message) {
+    bool escape = false;
+    uint8_t color = ConsoleHistory::default_color;
+    size_t added = history->added();
+
+    for (auto c : message) {
+        if (escape) {
+            color = (uint8_t)c < std::size(term_colors) ? (uint8_t)c : ConsoleHistory::default_color;
+            escape = false;
+        } else if (c == '\n') {
+            history->new_line();
+        } else if (c == '\r') {
+            history->carriage_return();
+        } else if (c == '\x1B') {
+            escape = true;
+        } else {
+            history->put(c, color);
+        }
+    }
+
+    if (scroll_back == 0 || history->added() == added)
+        return;
+
+    // stay on the same rows while new ones arrive, unless they were overwritten
+    scroll_back += history->added() - added;
+    size_t rows = visible_rows();
+    size_t max_back = history->size() > rows ? history->size() - rows : 0;
+
+    if (scroll_back > max_back) {
+        scroll_back = max_back;
+        if (!hidden() && visible())
+            draw_history();
+    } else if (!hidden() && visible()) {
+        draw_scroll_status((rows - 1) * style().font.line_height());
+    }
+}
+
+size_t Console::visible_rows() {
+    auto line_height = style().font.line_height();
+    return (scroll_height > 0 ? scroll_height : screen_rect().height()) / line_height;
+}
+
+void Console::scroll_history(int32_t rows) {
+    size_t visible = visible_rows();
+    int32_t max_back = history->size() > visible ? history->size() - visible : 0;
+    int32_t back = std::clamp<int32_t>((int32_t)scroll_back + rows, 0, max_back);
+
+    if ((size_t)back == scroll_back)
+        return;
+
+    scroll_back = back;
+    draw_history();
+}
+
+bool Console::on_encoder(const EncoderEvent delta) {
+    if (!history)
+        return false;
+
+    // turning right goes towards the newest row
+    scroll_history(-delta);
+    return true;
+}
+
+bool Console::on_touch(const TouchEvent event) {
+    if (!history)
+        return false;
+
+    auto line_height = style().font.line_height();
+
+    switch (event.type) {
+        case TouchEvent::Type::Start:
+            touch_y = event.point.y();
+            return true;
+
+        case TouchEvent::Type::Move: {
+            // dragging down pulls older rows into view
+            int32_t rows = (event.point.y() - touch_y) / line_height;
+            if (rows != 0) {
+                touch_y += rows * line_height;
+                scroll_history(rows);
+            }
+            return true;
+        }
+
+        default:
+            return true;
+    }
+}
+
+// only the rows on screen are drawn, the live output continues below the newest one
+void Console::draw_history() {
+    if (hidden() || !visible())
+        return;
+
+    PaintProfileScope profile_scope{this};
+
+    const Style& s = style();
+    auto line_height = s.font.line_height();
+    auto sr = screen_rect();
+    size_t rows = visible_rows();
+
+    size_t last = history->size() - 1 - scroll_back;
+    size_t shown = std::min(rows, last + 1);
+    size_t first = last + 1 - shown;
+
+    for (size_t i = 0; i < rows; i++) {
+        Coord y = i * line_height;
+        if (i < shown)
+            draw_history_row(history->row(first + i), y);
+        else
+            fill_row(sr.left(), _api->scroll_area_y(y), sr.width(), line_height, s.background);
+    }
+
+    if (scroll_back > 0)
+        draw_scroll_status((rows - 1) * line_height);
+    else
+        pos = {(Coord)(history->cursor() * s.font.char_width()), (Coord)((shown - 1) * line_height)};
+}
+
+void Console::draw_history_row(const ConsoleHistory::Row& row, Coord y) {
+    const Style& s = style();
+    auto char_width = s.font.char_width();
+    auto sr = screen_rect();
+
+    size_t start = 0;
+    for (size_t i = 1; i <= row.length; i++) {
+        if (i < row.length && row.color[i] == row.color[start])
+            continue;
+
+        uint8_t color = row.color[start];
+        draw_run(row.text + start, i - start, {(Coord)(start * char_width), y}, color < std::size(term_colors) ? term_colors[color] : s.foreground);
+        start = i;
+    }
+
+    Coord used = row.length * char_width;
+    if (used < sr.width())
+        fill_row(sr.left() + used, _api->scroll_area_y(y), sr.width() - used, s.font.line_height(), s.background);
+}
+
+void Console::draw_scroll_status(Coord y) {
+    std::string status = "-- " + to_string_dec_uint(scroll_back) + " rows back --";
+    status.resize(history->columns(), ' ');
+    draw_run(status.data(), status.size(), {0, y}, Theme::getInstance()->fg_yellow->foreground);
 }
 
 void Console::on_show() {
@@ -771,9 +1023,13 @@ void Console::enable_scrolling(bool enable) {
         _api->scroll_set_area(sr.top(), sr.top() + scroll_height);
         _api->scroll_set_position(0);
         scrolling_enabled = true;
+        scroll_area_owner = this;
     } else {
-        _api->scroll_disable();
+        if (scroll_area_owner == this || scroll_area_owner == nullptr)
+            _api->scroll_disable();
         scrolling_enabled = false;
+        if (scroll_area_owner == this)
+            scroll_area_owner = nullptr;
     }
 }
 
@@ -807,12 +1063,349 @@ void Console::crlf() {
         pos = {0, scroll_height - line_height};
 
         // Scroll off the "top" line.
+        paint_profile(PaintCall::SCROLL, 0);
         _api->scroll(-line_height);
 
         // Clear the new line at the "bottom".
         Rect dirty{sr.left(), _api->scroll_area_y(pos.y()), sr.width(), line_height};
-        _api->fill_rectangle(dirty.left(), dirty.top(), dirty.width(), dirty.height(), s.background.v);
+        fill_row(dirty.left(), dirty.top(), dirty.width(), dirty.height(), s.background);
+    }
+}
+
+/* HexDump ***************************************************************/
+
+HexDump::HexDump(
+    Rect parent_rect,
+    size_t history_rows)
+    : Widget{parent_rect},
+      rows_{std::make_unique<Row[]>(history_rows)},
+      capacity_{history_rows} {
+    for (auto& color : channel_colors_)
+        color = Color::white();
+
+    rows_[0].length = 0;
+    set_focusable(true);
+}
+
+const HexDump::Row& HexDump::row(size_t index) const {
+    index += head_;
+    if (index >= capacity_)
+        index -= capacity_;
+    return rows_[index];
+}
+
+HexDump::Row& HexDump::current() {
+    return const_cast<Row&>(row(count_ - 1));
+}
+
+void HexDump::new_row() {
+    added_++;
+
+    if (count_ < capacity_)
+        count_++;
+    else
+        head_ = head_ + 1 < capacity_ ? head_ + 1 : 0;
+
+    current().length = 0;
+}
+
+void HexDump::set_bytes_per_row(size_t bytes) {
+    bytes_per_row_ = bytes > 8 ? max_bytes_per_row : 8;
+    update_layout();
+    clear();
+}
+
+void HexDump::set_channel_color(uint8_t channel, Color color) {
+    if (channel < max_channels)
+        channel_colors_[channel] = color;
+}
+
+void HexDump::clear() {
+    head_ = 0;
+    count_ = 1;
+    rows_[0].length = 0;
+    scroll_back_ = 0;
+
+    for (auto& offset : channel_offsets_)
+        offset = 0;
+
+    draw_all();
+}
+
+// the widest layout that fits: offset, bytes separated by spaces, ascii
+void HexDump::update_layout() {
+    size_t columns = size().width() / style().font.char_width();
+
+    for (size_t layout = 0; layout < 4; layout++) {
+        show_offset_ = (layout & 1) == 0;
+        spaced_ = layout < 2;
+
+        size_t width = (show_offset_ ? 5 : 0) + (spaced_ ? 3 : 2) * bytes_per_row_ + bytes_per_row_;
+        if (width <= columns)
+            return;
+    }
+}
+
+void HexDump::write(uint8_t channel, const uint8_t* data, size_t length) {
+    channel &= max_channels - 1;
+    size_t added = added_;
+
+    for (size_t i = 0; i < length; i++) {
+        Row* r = &current();
+        if (r->length > 0 && r->channel != channel) {
+            new_row();
+            r = &current();
+        }
+
+        if (r->length == 0) {
+            r->channel = channel;
+            r->offset = channel_offsets_[channel];
+        }
+
+        r->data[r->length++] = data[i];
+        channel_offsets_[channel]++;
+
+        if (r->length == bytes_per_row_)
+            new_row();
+    }
+
+    show_new_rows(added_ - added);
+}
+
+void HexDump::end_row() {
+    if (current().length == 0)
+        return;
+
+    new_row();
+    show_new_rows(1);
+}
+
+void HexDump::show_new_rows(size_t new_rows) {
+    if (hidden() || !visible())
+        return;
+
+    PaintProfileScope profile_scope{this};
+
+    size_t rows = visible_rows();
+
+    if (frozen()) {
+        if (new_rows == 0)
+            return;
+
+        // stay on the same rows, unless they were overwritten
+        scroll_back_ += new_rows;
+        size_t max_back = count_ > rows ? count_ - rows : 0;
+        if (scroll_back_ > max_back) {
+            scroll_back_ = max_back;
+            draw_all();
+        } else {
+            draw_status();
+        }
+        return;
+    }
+
+    if (new_rows >= rows) {
+        draw_all();
+        return;
+    }
+
+    // the previous partial row is redrawn complete, then the new ones below it
+    for (size_t i = new_rows; i > 0; i--) {
+        draw_row(row(count_ - 1 - i), line_);
+        advance_line();
+    }
+
+    draw_row(current(), line_);
+}
+
+void HexDump::advance_line() {
+    if (line_ + 1 < visible_rows()) {
+        line_++;
+        return;
+    }
+
+    // the bottom line stays, the content moves up and the new row overwrites the old top row
+    paint_profile(PaintCall::SCROLL, 0);
+    _api->scroll(-style().font.line_height());
+}
+
+size_t HexDump::visible_rows() const {
+    auto line_height = style().font.line_height();
+    return (scroll_height_ > 0 ? scroll_height_ : size().height()) / line_height;
+}
+
+void HexDump::set_paused(bool paused) {
+    paused_ = paused;
+    if (!paused)
+        scroll_back_ = 0;
+
+    draw_all();
+}
+
+void HexDump::scroll(int32_t rows) {
+    size_t visible = visible_rows();
+    int32_t max_back = count_ > visible ? count_ - visible : 0;
+    int32_t back = std::clamp<int32_t>((int32_t)scroll_back_ + rows, 0, max_back);
+
+    if ((size_t)back == scroll_back_)
+        return;
+
+    scroll_back_ = back;
+    draw_all();
+}
+
+bool HexDump::on_encoder(const EncoderEvent delta) {
+    // turning right goes towards the newest row
+    scroll(-delta);
+    return true;
+}
+
+bool HexDump::on_touch(const TouchEvent event) {
+    auto line_height = style().font.line_height();
+
+    switch (event.type) {
+        case TouchEvent::Type::Start:
+            touch_y_ = event.point.y();
+            touch_moved_ = false;
+            return true;
+
+        case TouchEvent::Type::Move: {
+            // dragging down pulls older rows into view
+            int32_t rows = (event.point.y() - touch_y_) / line_height;
+            if (rows != 0) {
+                touch_y_ += rows * line_height;
+                touch_moved_ = true;
+                scroll(rows);
+            }
+            return true;
+        }
+
+        case TouchEvent::Type::End:
+            // a tap pauses and resumes
+            if (!touch_moved_)
+                set_paused(!paused_);
+            return true;
+
+        default:
+            return true;
+    }
+}
+
+void HexDump::paint(Painter&) {
+    draw_all();
+}
+
+void HexDump::draw_all() {
+    if (hidden() || !visible())
+        return;
+
+    PaintProfileScope profile_scope{this};
+
+    auto line_height = style().font.line_height();
+    auto sr = screen_rect();
+    size_t rows = visible_rows();
+
+    size_t last = count_ - 1 - scroll_back_;
+    size_t shown = std::min(rows, last + 1);
+    size_t first = last + 1 - shown;
+
+    for (size_t i = 0; i < rows; i++) {
+        if (i < shown)
+            draw_row(row(first + i), i);
+        else
+            fill_row(sr.left(), _api->scroll_area_y(i * line_height), sr.width(), line_height, style().background);
+    }
+
+    line_ = shown - 1;
+    if (frozen())
+        draw_status();
+}
+
+void HexDump::draw_row(const Row& row, size_t line) {
+    static const char digits[] = "0123456789ABCDEF";
+    // offset, 16 spaced bytes and their ascii
+    char text[5 + 3 * max_bytes_per_row + max_bytes_per_row];
+
+    const Style& s = style();
+    const Font& font = s.font;
+    auto char_width = font.char_width();
+    auto sr = screen_rect();
+    Coord y = _api->scroll_area_y(line * font.line_height());
+    size_t length = 0;
+
+    if (row.length > 0) {
+        if (show_offset_) {
+            for (size_t shift = 16; shift > 0; shift -= 4)
+                text[length++] = digits[(row.offset >> (shift - 4)) & 0x0F];
+            text[length++] = ' ';
+        }
+        size_t hex_start = length;
+
+        for (size_t i = 0; i < bytes_per_row_; i++) {
+            text[length++] = i < row.length ? digits[row.data[i] >> 4] : ' ';
+            text[length++] = i < row.length ? digits[row.data[i] & 0x0F] : ' ';
+            if (spaced_)
+                text[length++] = ' ';
+        }
+        size_t ascii_start = length;
+
+        for (size_t i = 0; i < row.length; i++)
+            text[length++] = row.data[i] >= 0x20 && row.data[i] < 0x7F ? row.data[i] : '.';
+
+        // runs are limited by the glyph strip, 40 glyphs of the large font
+        const size_t run_max = CONSOLE_RUN_MAX_BITS / (char_width * font.line_height());
+        const size_t segments[4] = {0, hex_start, ascii_start, length};
+        const Color colors[3] = {Color::dark_grey(), channel_colors_[row.channel], Color::light_grey()};
+
+        for (size_t segment = 0; segment < 3; segment++) {
+            for (size_t start = segments[segment]; start < segments[segment + 1]; start += run_max) {
+                size_t run = std::min(run_max, segments[segment + 1] - start);
+                draw_glyph_run(font, text + start, run, sr.left() + start * char_width, y, colors[segment], s.background);
+            }
+        }
     }
+
+    Coord used = length * char_width;
+    if (used < sr.width())
+        fill_row(sr.left() + used, y, sr.width() - used, font.line_height(), s.background);
+}
+
+void HexDump::draw_status() {
+    std::string status = paused_ ? "-- paused" : "--";
+    if (scroll_back_ > 0)
+        status += " " + to_string_dec_uint(scroll_back_) + " rows back";
+    status += " --";
+
+    const Font& font = style().font;
+    const size_t run_max = CONSOLE_RUN_MAX_BITS / (font.char_width() * font.line_height());
+    status.resize(std::min((size_t)(size().width() / font.char_width()), run_max), ' ');
+
+    Coord y = (visible_rows() - 1) * font.line_height();
+    draw_glyph_run(font, status.data(), status.size(), screen_rect().left(), _api->scroll_area_y(y), Theme::getInstance()->fg_yellow->foreground, style().background);
+}
+
+void HexDump::on_show() {
+    auto sr = screen_rect();
+    auto line_height = style().font.line_height();
+    scroll_height_ = (sr.height() / line_height) * line_height;
+
+    _api->scroll_set_area(sr.top(), sr.top() + scroll_height_);
+    _api->scroll_set_position(0);
+    scroll_area_owner = this;
+
+    update_layout();
+}
+
+void HexDump::on_hide() {
+    if (scroll_area_owner != this)
+        return;
+
+    _api->scroll_disable();
+    scroll_area_owner = nullptr;
+}
+
+void HexDump::getWidgetName(std::string& result) {
+    result = "HexDump";
 }
 
 /* Checkbox **************************************************************/
@@ -2733,6 +3326,10 @@ void Waveform::paint(Painter& painter) {
     }
 }
 
+void Waveform::getWidgetName(std::string& result) {
+    result = "Waveform";
+}
+
 /* VuMeter **************************************************************/
 
 VuMeter::VuMeter(
@@ -2743,7 +3340,7 @@ VuMeter::VuMeter(
       LEDs_{LEDs},
       show_max_{show_max} {
     // set_focusable(false);
-    LED_height = std::max(1UL, parent_rect.size().height() / LEDs);
+    LED_height = std::max<uint32_t>(1, parent_rect.size().height() / LEDs);
     split = 256 / LEDs;
 }
 
@@ -33,6 +33,7 @@
 
 // #include "portapack.hpp"
 #include "utility.hpp"
+#include "console_history.hpp"
 
 // #include "ui/ui_font_fixed_5x8.hpp"
 
@@ -363,8 +364,12 @@ class Console : public Widget {
     void paint(Painter&) override;
 
     void enable_scrolling(bool enable);
+    // keeps the given number of rows for scrolling back with the encoder or touch
+    void enable_history(size_t rows);
     void on_show() override;
     void on_hide() override;
+    bool on_encoder(const EncoderEvent delta) override;
+    bool on_touch(const TouchEvent event) override;
     void getAccessibilityText(std::string& result) override;
     void getWidgetName(std::string& result) override;
 
@@ -374,7 +379,93 @@ class Console : public Widget {
     std::string buffer{};
     static bool scrolling_enabled;
 
+    std::unique_ptr<ConsoleHistory> history{};
+    size_t scroll_back = 0;  // rows between the bottom of the screen and the newest row
+    Coord touch_y = 0;
+
     void crlf();
+    void draw_run(const char* text, size_t length, Point position, Color color);
+    void record(const std::string& message);
+    size_t visible_rows();
+    void scroll_history(int32_t rows);
+    void draw_history();
+    void draw_history_row(const ConsoleHistory::Row& row, Coord y);
+    void draw_scroll_status(Coord y);
+};
+
+/* Hex and ASCII dump of byte streams from up to four channels.
+ * Rows are kept in a bounded ring and appended incrementally: only completed
+ * rows and the row being filled are drawn, older rows move up with the
+ * hardware scroll area. A row only holds bytes of one channel, a chunk of
+ * another channel completes it early. Pausing or scrolling back with the
+ * encoder or touch keeps the rows on screen while data is still collected. */
+class HexDump : public Widget {
+   public:
+    static constexpr size_t max_bytes_per_row = 16;
+    static constexpr size_t max_channels = 4;
+
+    HexDump(Rect parent_rect, size_t history_rows);
+
+    HexDump(const HexDump&) = delete;
+    HexDump& operator=(const HexDump&) = delete;
+
+    // 8 or 16, clears the rows
+    void set_bytes_per_row(size_t bytes);
+    void set_channel_color(uint8_t channel, Color color);
+    void write(uint8_t channel, const uint8_t* data, size_t length);
+    // the next byte starts a new row, for data that arrives in frames
+    void end_row();
+    void clear();
+
+    void set_paused(bool paused);
+    bool paused() const { return paused_; }
+
+    void paint(Painter&) override;
+    void on_show() override;
+    void on_hide() override;
+    bool on_encoder(const EncoderEvent delta) override;
+    bool on_touch(const TouchEvent event) override;
+    void getWidgetName(std::string& result) override;
+
+   private:
+    struct Row {
+        uint16_t offset;  // of the first byte in its channel's stream
+        uint8_t channel;
+        uint8_t length;
+        uint8_t data[max_bytes_per_row];
+    };
+
+    const Row& row(size_t index) const;
+    Row& current();
+    void new_row();
+    void show_new_rows(size_t new_rows);
+    bool frozen() const { return paused_ || scroll_back_ > 0; }
+    size_t visible_rows() const;
+    void update_layout();
+    void advance_line();
+    void scroll(int32_t rows);
+    void draw_all();
+    void draw_row(const Row& row, size_t line);
+    void draw_status();
+
+    std::unique_ptr<Row[]> rows_;
+    const size_t capacity_;
+    size_t head_{0};
+    size_t count_{1};  // the last row is the one being filled
+    size_t added_{0};
+
+    size_t bytes_per_row_{8};
+    bool show_offset_{true};
+    bool spaced_{true};
+    Color channel_colors_[max_channels]{};
+    uint16_t channel_offsets_[max_channels]{};
+
+    Dim scroll_height_{0};
+    size_t line_{0};  // screen line of the row being filled
+    size_t scroll_back_{0};
+    bool paused_{false};
+    Coord touch_y_{0};
+    bool touch_moved_{false};
 };
 
 class Checkbox : public Widget {
@@ -990,6 +1081,7 @@ class Waveform : public Widget {
     void set_cursor(const uint32_t i, const int16_t position);
 
     void paint(Painter& painter) override;
+    void getWidgetName(std::string& result) override;
 
    private:
     const Color cursor_colors[2] = {Theme::getInstance()->fg_cyan->foreground, Theme::getInstance()->fg_magenta->foreground};
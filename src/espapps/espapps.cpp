@@ -33,6 +33,7 @@ extern "C" void initialize(const standalone_application_api_t& api) {
 namespace ui {
 
 ESPAppsView::ESPAppsView(NavigationView& nav) : nav_(nav) {
+    timer_load.start_frames(20);
     add_children({&options_apps, &button_startstop});
 
     button_startstop.on_select = [this](Button&) {
@@ -44,21 +45,12 @@ ESPAppsView::ESPAppsView(NavigationView& nav) : nav_(nav) {
             appcmd = 0;
         }
         current_app = appcmd;
-        std::vector<uint16_t> data;
-        data.push_back(static_cast<uint16_t>(cmd));
-        data.push_back(static_cast<uint16_t>(appcmd));
-        if (_api->i2c_read((uint8_t*)data.data(), 4, nullptr, 0) == false) return;
+        auto data = pp_command(cmd, appcmd);
+        if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
         update_ui_for_current_app();
     };
 }
 
-void ESPAppsView::on_framesync() {
-    if (config_loaded <= 20) config_loaded++;
-    if (config_loaded == 20) {
-        get_current_app();
-    }
-}
-
 void ESPAppsView::get_current_app() {
     Command cmd = Command::PPCMD_APPMGR_APPMGR;
     uint16_t capp = 0;
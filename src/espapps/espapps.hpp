@@ -51,11 +51,10 @@ class ESPAppsView : public View {
     };
 
     std::string title() const override { return "ESP Apps"; };
-    void on_framesync() override;
 
    private:
     uint16_t current_app = 0;
-    uint8_t config_loaded = 0;
+    FrameTimer timer_load{this, [this]() { get_current_app(); }};
 
     void get_current_app();
     void update_ui_for_current_app();
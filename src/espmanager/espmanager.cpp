@@ -34,35 +34,23 @@ extern "C" void initialize(const standalone_application_api_t& api) {
 namespace ui {
 
 ESPManagerView::ESPManagerView(NavigationView& nav) : nav_(nav) {
+    timer_load.start_frames(20);
     add_children({&btn_airplane_on,
                   &btn_airplane_off,
                   &labels});
 
     btn_airplane_on.on_select = [this](Button&) {
         uint8_t mode = 2;
-        Command cmd = Command::PPCMD_AIRPLANE_MODE;
-        std::vector<uint8_t> data(sizeof(uint8_t));
-        memcpy(data.data(), &mode, sizeof(mode));
-        data.insert(data.begin(), reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));
+        auto data = pp_command(Command::PPCMD_AIRPLANE_MODE, mode);
         if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
     };
     btn_airplane_off.on_select = [this](Button&) {
         uint8_t mode = 1;
-        Command cmd = Command::PPCMD_AIRPLANE_MODE;
-        std::vector<uint8_t> data(sizeof(uint8_t));
-        memcpy(data.data(), &mode, sizeof(mode));
-        data.insert(data.begin(), reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));
+        auto data = pp_command(Command::PPCMD_AIRPLANE_MODE, mode);
         if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
     };
 }
 
-void ESPManagerView::on_framesync() {
-    if (config_loaded <= 20) config_loaded++;
-    if (config_loaded == 20) {
-        get_current_config();
-    }
-}
-
 void ESPManagerView::get_current_config() {
     Command cmd = Command::PPCMD_AIRPLANE_MODE;
     uint8_t mode = 0;
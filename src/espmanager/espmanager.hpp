@@ -41,13 +41,12 @@ class ESPManagerView : public View {
     };
 
     std::string title() const override { return "ESP Manager"; };
-    void on_framesync() override;
 
    private:
     void get_current_config();
 
     NavigationView& nav_;
-    uint8_t config_loaded = 0;
+    FrameTimer timer_load{this, [this]() { get_current_config(); }};
     Button btn_airplane_on{{UI_POS_X(0), UI_POS_Y(5), UI_POS_WIDTH(10), UI_POS_HEIGHT(2)}, "ON"};
     Button btn_airplane_off{{UI_POS_X(15), UI_POS_Y(5), UI_POS_WIDTH(10), UI_POS_HEIGHT(2)}, "OFF"};
     Labels labels{
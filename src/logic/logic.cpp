@@ -0,0 +1,439 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include "logic.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+extern "C" void initialize(const standalone_application_api_t& api) {
+    _api = &api;
+    context = new ui::Context();
+    standaloneViewMirror = new ui::StandaloneViewMirror(*context, {0, 16, UI_POS_MAXWIDTH, UI_POS_MAXHEIGHT - 16});
+    standaloneViewMirror->push<ui::LogicAPPView>();
+}
+
+namespace ui {
+
+LogicAPPView::LogicAPPView(NavigationView& nav)
+    : nav_(nav) {
+    set_style(ui::Theme::getInstance()->bg_dark);
+
+    add_children({&option_trigger,
+                  &option_channel,
+                  &field_pre_trigger,
+                  &text_percent,
+                  &option_time,
+                  &button_arm,
+                  &button_fit,
+                  &button_pattern,
+                  &text_status,
+                  &button_generator,
+                  &trace,
+                  &text_pins});
+
+    trace.set_style(ui::Theme::getInstance()->bg_darkest_small);
+    text_pins.set_style(ui::Theme::getInstance()->bg_darkest_small);
+
+    option_trigger.set_by_value((int32_t)LogicTriggerType::TRIGGER_RISING);
+    field_pre_trigger.set_value(10);
+    option_time.set_by_value(100);
+
+    button_arm.on_select = [this](ui::Button&) {
+        if (polling_)
+            stop();
+        else
+            arm();
+    };
+
+    button_fit.on_select = [this](ui::Button&) {
+        trace.fit();
+    };
+
+    button_generator.on_select = [this](ui::Button&) {
+        nav_.push<LogicPatternView>();
+    };
+
+    button_pattern.on_select = [this](ui::Button&) {
+        pattern_edit_ = pattern_;
+        text_prompt(nav_, pattern_edit_, LOGIC_CHANNEL_COUNT, ENTER_KEYBOARD_MODE_ALPHA, [this](std::string& value) {
+            set_pattern(value);
+        });
+    };
+
+    // a capture left on the module from the last time is downloaded right away
+    polling_ = true;
+    status_refresh_ = LOGIC_STATUS_INTERVAL;
+}
+
+void LogicAPPView::on_framesync() {
+    if (downloading_) {
+        download();
+        return;
+    }
+
+    if (polling_ && ++status_refresh_ >= LOGIC_STATUS_INTERVAL) {
+        status_refresh_ = 0;
+        request_status();
+    }
+}
+
+void LogicAPPView::set_pattern(const std::string& pattern) {
+    pattern_.clear();
+    pattern_mask_ = 0;
+    pattern_value_ = 0;
+
+    // the first character is channel 0, anything but 0 and 1 is don't care
+    for (size_t channel = 0; channel < LOGIC_CHANNEL_COUNT; channel++) {
+        char c = channel < pattern.size() ? pattern[channel] : 'x';
+
+        if (c == '0' || c == '1') {
+            pattern_mask_ |= 1 << channel;
+            pattern_value_ |= (c == '1') << channel;
+            pattern_ += c;
+        } else {
+            pattern_ += 'x';
+        }
+    }
+
+    button_pattern.set_text(pattern_);
+}
+
+void LogicAPPView::arm() {
+    uint16_t max_time_ms = option_time.selected_index_value();
+    Command cmd = Command::COMMAND_LOGIC_ARM;
+    uint8_t data[sizeof(cmd) + 7];
+    memcpy(data, &cmd, sizeof(cmd));
+
+    data[2] = option_trigger.selected_index_value();
+    data[3] = option_channel.selected_index_value();
+    data[4] = pattern_mask_;
+    data[5] = pattern_value_;
+    data[6] = field_pre_trigger.value();
+    data[7] = max_time_ms & 0xFF;
+    data[8] = max_time_ms >> 8;
+
+    if (_api->i2c_read(data, sizeof(data), nullptr, 0) == false) {
+        text_status.set("No module");
+        return;
+    }
+
+    // the old capture is gone once the module is armed
+    trace.set_capture(nullptr, 0, LOGIC_CHANNEL_COUNT, 0, 1);
+    capture_.reset();
+    capture_size_ = 0;
+
+    status_.state = LogicCaptureState::CAPTURE_ARMED;
+    polling_ = true;
+    status_refresh_ = 0;
+    button_arm.set_text("Stop");
+    update_status_text();
+}
+
+void LogicAPPView::stop() {
+    // a triggered capture ends early and is downloaded, an armed trigger is dropped
+    Command cmd = Command::COMMAND_LOGIC_STOP;
+    _api->i2c_read((uint8_t*)&cmd, sizeof(cmd), nullptr, 0);
+}
+
+void LogicAPPView::request_status() {
+    Command cmd = Command::COMMAND_LOGIC_STATUS_GET;
+
+    if (_api->i2c_read((uint8_t*)&cmd, sizeof(cmd), (uint8_t*)&status_, sizeof(status_)) == false)
+        return;
+
+    switch (status_.state) {
+        case LogicCaptureState::CAPTURE_DONE:
+            polling_ = false;
+            capture_size_ = status_.encoded_size;
+            capture_ = std::make_unique<uint8_t[]>(capture_size_);
+            downloaded_ = 0;
+            downloading_ = true;
+            break;
+
+        case LogicCaptureState::CAPTURE_IDLE:
+            polling_ = false;
+            button_arm.set_text("Arm");
+            break;
+
+        default:
+            button_arm.set_text("Stop");
+            break;
+    }
+
+    update_status_text();
+}
+
+void LogicAPPView::download() {
+    for (size_t i = 0; i < LOGIC_READS_PER_FRAMESYNC && downloaded_ < capture_size_; i++) {
+        auto data = pp_command(Command::COMMAND_LOGIC_READ, logic_read_message_t{(uint32_t)downloaded_});
+
+        uint8_t block[LOGIC_READ_BLOCK_SIZE];
+        if (_api->i2c_read(data.data(), data.size(), block, sizeof(block)) == false)
+            return;
+
+        size_t length = std::min<size_t>(sizeof(block), capture_size_ - downloaded_);
+        memcpy(capture_.get() + downloaded_, block, length);
+        downloaded_ += length;
+    }
+
+    if (downloaded_ >= capture_size_) {
+        downloading_ = false;
+        trace.set_capture(capture_.get(), capture_size_, status_.channel_count, status_.trigger_index, status_.cycles_per_us);
+        button_arm.set_text("Arm");
+    }
+
+    update_status_text();
+}
+
+void LogicAPPView::update_status_text() {
+    if (downloading_) {
+        text_status.set("Reading " + std::to_string(capture_size_ > 0 ? downloaded_ * 100 / capture_size_ : 100) + "%");
+        return;
+    }
+
+    switch (status_.state) {
+        case LogicCaptureState::CAPTURE_ARMED:
+            text_status.set("Armed");
+            break;
+
+        case LogicCaptureState::CAPTURE_RUNNING:
+            text_status.set("Capturing");
+            break;
+
+        case LogicCaptureState::CAPTURE_DONE:
+            text_status.set(std::to_string(status_.transitions) + " records");
+            break;
+
+        default:
+            text_status.set("Idle");
+            break;
+    }
+}
+
+LogicPatternView::LogicPatternView(NavigationView& nav)
+    : nav_(nav) {
+    set_style(ui::Theme::getInstance()->bg_dark);
+
+    add_children({&labels,
+                  &button_file,
+                  &button_bitrate,
+                  &option_idle,
+                  &text_state,
+                  &text_underruns,
+                  &button_start});
+
+    button_bitrate.set_text(std::to_string(bitrate_) + " bit/s");
+    option_idle.set_by_value(0);
+
+    button_file.on_select = [this](ui::Button&) {
+        if (file_open_)
+            return;
+
+        auto open_view = nav_.push<FileLoadView>("");
+        open_view->on_changed = [this](std::filesystem::path path) {
+            path_ = path;
+            button_file.set_text(path.filename().string());
+        };
+    };
+
+    button_bitrate.on_select = [this](ui::Button&) {
+        bitrate_edit_ = std::to_string(bitrate_);
+        text_prompt(nav_, bitrate_edit_, 7, ENTER_KEYBOARD_MODE_DIGITS, [this](std::string& value) {
+            bitrate_ = std::clamp<uint32_t>(strtoul(value.c_str(), nullptr, 10), PATTERN_BITRATE_MIN, PATTERN_BITRATE_MAX);
+            button_bitrate.set_text(std::to_string(bitrate_) + " bit/s");
+            configure();
+        });
+    };
+
+    option_idle.on_change = [this](size_t, ui::OptionsField::value_t) {
+        configure();
+    };
+
+    button_start.on_select = [this](ui::Button&) {
+        if (file_open_ || status_.state == PatternState::PATTERN_PLAYING)
+            stop();
+        else
+            start();
+    };
+
+    // the output holds the idle level from now on
+    configure();
+}
+
+LogicPatternView::~LogicPatternView() {
+    // what is queued is still played, the output stays at the idle level afterwards
+    if (file_open_) {
+        file_.close();
+        send_control(PatternControl::CONTROL_END);
+        if (!started_)
+            send_control(PatternControl::CONTROL_START);
+    }
+}
+
+void LogicPatternView::focus() {
+    button_file.focus();
+}
+
+void LogicPatternView::on_framesync() {
+    // the queue space is needed every frame while sending, otherwise the status is refreshed twice a second
+    if (file_open_ || status_.state == PatternState::PATTERN_PLAYING || ++status_refresh_ >= 30) {
+        status_refresh_ = 0;
+        request_status();
+    }
+
+    if (flushing_ && status_.state != PatternState::PATTERN_PLAYING && status_.queued == 0)
+        flushing_ = false;
+
+    if (file_open_ && !flushing_)
+        transmit();
+}
+
+void LogicPatternView::configure() {
+    // a new configuration stops playing on the module
+    if (file_open_) {
+        file_.close();
+        file_open_ = false;
+    }
+
+    auto data = pp_command(Command::COMMAND_PATTERN_CONFIG, pattern_config_message_t{bitrate_, (uint8_t)option_idle.selected_index_value()});
+
+    _api->i2c_read(data.data(), data.size(), nullptr, 0);
+    button_start.set_text("Start");
+}
+
+void LogicPatternView::start() {
+    if (path_.empty()) {
+        nav_.display_modal("Error", "Select a pattern\nfile first.");
+        return;
+    }
+
+    auto error = file_.open(path_);
+    if (error.is_valid()) {
+        nav_.display_modal("Error", "Could not open\n" + path_.filename().string());
+        return;
+    }
+
+    // whatever an earlier run left in the queue is dropped, the module also drops data that arrives before it did that
+    flushing_ = status_.state == PatternState::PATTERN_PLAYING || status_.queued > 0;
+    if (flushing_)
+        send_control(PatternControl::CONTROL_STOP);
+
+    file_open_ = true;
+    started_ = false;
+    block_pos_ = 0;
+    block_length_ = 0;
+    file_size_ = file_.size();
+    button_start.set_text("Stop");
+}
+
+void LogicPatternView::stop() {
+    if (file_open_) {
+        file_.close();
+        file_open_ = false;
+    }
+
+    send_control(PatternControl::CONTROL_STOP);
+    button_start.set_text("Start");
+}
+
+void LogicPatternView::send_control(PatternControl control) {
+    Command cmd = Command::COMMAND_PATTERN_CONTROL;
+    uint8_t data[sizeof(cmd) + 1];
+    memcpy(data, &cmd, sizeof(cmd));
+    data[sizeof(cmd)] = (uint8_t)control;
+
+    _api->i2c_read(data, sizeof(data), nullptr, 0);
+}
+
+void LogicPatternView::request_status() {
+    Command cmd = Command::COMMAND_PATTERN_STATUS_GET;
+
+    if (_api->i2c_read((uint8_t*)&cmd, sizeof(cmd), (uint8_t*)&status_, sizeof(status_)) == false)
+        return;
+
+    if (!file_open_ && status_.state != PatternState::PATTERN_PLAYING)
+        button_start.set_text("Start");
+
+    update_status_text();
+}
+
+// fills the queue as far as the module has room, playing starts once it is full or the file is sent completely
+void LogicPatternView::transmit() {
+    Command cmd = Command::COMMAND_PATTERN_DATA;
+    uint8_t data[sizeof(cmd) + PATTERN_DATA_MAX_LENGTH];
+    memcpy(data, &cmd, sizeof(cmd));
+    uint8_t* payload = data + sizeof(cmd);
+    size_t credit = status_.free;
+
+    for (size_t frame = 0; frame < PATTERN_FRAMES_PER_FRAMESYNC && credit > 0; frame++) {
+        if (block_pos_ == block_length_) {
+            auto result = file_.read(block_, sizeof(block_));
+            if (result.is_error() || result.value() == 0) {
+                file_.close();
+                file_open_ = false;
+                send_control(PatternControl::CONTROL_END);
+                break;
+            }
+
+            block_pos_ = 0;
+            block_length_ = result.value();
+        }
+
+        size_t length = std::min({block_length_ - block_pos_, credit, (size_t)PATTERN_DATA_MAX_LENGTH});
+        memcpy(payload, block_ + block_pos_, length);
+
+        if (_api->i2c_read(data, sizeof(cmd) + length, nullptr, 0) == false)
+            break;
+
+        block_pos_ += length;
+        credit -= length;
+    }
+
+    if (!started_ && (credit == 0 || !file_open_)) {
+        started_ = true;
+        send_control(PatternControl::CONTROL_START);
+    }
+}
+
+void LogicPatternView::update_status_text() {
+    switch (status_.state) {
+        case PatternState::PATTERN_OFF:
+            text_state.set("Off");
+            break;
+
+        case PatternState::PATTERN_PLAYING:
+            text_state.set("Playing " + std::to_string(file_size_ > 0 ? status_.played * 100 / file_size_ : 100) + "%, " +
+                           std::to_string(status_.bitrate) + " bit/s");
+            break;
+
+        default:
+            text_state.set("Idle, " + std::to_string(status_.bitrate) + " bit/s");
+            break;
+    }
+
+    text_underruns.set("Underruns: " + std::to_string(status_.underruns) + " DMA: " + std::to_string(status_.dma_underruns));
+}
+
+}  // namespace ui
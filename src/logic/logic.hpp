@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#pragma once
+
+#include "standalone_application.hpp"
+
+#include "ui/ui_widget.hpp"
+#include "ui/theme.hpp"
+#include "ui/ui_helper.hpp"
+#include "ui/ui_navigation.hpp"
+#include "ui/ui_textentry.hpp"
+#include "ui/ui_fileman.hpp"
+#include "standaloneviewmirror.hpp"
+#include "logic_trace.hpp"
+
+#include <memory>
+
+#define USER_COMMANDS_START 0x7F01
+
+namespace ui {
+
+enum class Command : uint16_t {
+    // logic analyzer commands, they follow the UART commands of the module
+    COMMAND_LOGIC_ARM = USER_COMMANDS_START + 15,
+    COMMAND_LOGIC_STOP,
+    COMMAND_LOGIC_STATUS_GET,
+    COMMAND_LOGIC_READ,
+    // pattern generator commands
+    COMMAND_PATTERN_CONFIG,
+    COMMAND_PATTERN_CONTROL,
+    COMMAND_PATTERN_DATA,
+    COMMAND_PATTERN_STATUS_GET
+};
+
+#define LOGIC_CHANNEL_COUNT 8
+#define LOGIC_READ_BLOCK_SIZE 128
+// read commands per frame while downloading a capture
+#define LOGIC_READS_PER_FRAMESYNC 8
+// frames between two status requests while the module is armed or capturing
+#define LOGIC_STATUS_INTERVAL 10
+
+enum class LogicTriggerType : uint8_t {
+    TRIGGER_NONE = 0,
+    TRIGGER_RISING,
+    TRIGGER_FALLING,
+    TRIGGER_EDGE,
+    TRIGGER_PATTERN
+};
+
+enum class LogicCaptureState : uint8_t {
+    CAPTURE_IDLE = 0,
+    CAPTURE_ARMED,
+    CAPTURE_RUNNING,
+    CAPTURE_DONE
+};
+
+#define PATTERN_BITRATE_MIN 1000
+#define PATTERN_BITRATE_MAX 8000000
+#define PATTERN_DATA_MAX_LENGTH 126
+// keeps the pattern transfer from blocking the ui
+#define PATTERN_FRAMES_PER_FRAMESYNC 16
+
+enum class PatternState : uint8_t {
+    PATTERN_OFF = 0,
+    PATTERN_IDLE,
+    PATTERN_PLAYING
+};
+
+enum class PatternControl : uint8_t {
+    CONTROL_STOP = 0,
+    CONTROL_START,
+    CONTROL_END
+};
+
+typedef struct
+{
+    PatternState state;
+    uint8_t repeat;
+    uint8_t idle_level;
+    uint8_t reserved;
+    uint32_t bitrate;
+    uint32_t free;
+    uint32_t queued;
+    uint32_t played;
+    uint32_t underruns;
+    uint32_t underrun_bytes;
+    uint32_t dma_underruns;
+} pattern_status_t;
+PP_MESSAGE(pattern_status_t, PP_PATTERN_STATUS_SIZE);
+
+typedef struct
+{
+    LogicCaptureState state;
+    uint8_t channel_count;
+    uint8_t levels;
+    uint8_t reserved;
+    uint32_t transitions;
+    uint32_t trigger_index;
+    uint32_t encoded_size;
+    uint32_t cycles_per_us;
+} logic_capture_status_t;
+PP_MESSAGE(logic_capture_status_t, PP_LOGIC_CAPTURE_STATUS_SIZE);
+
+class LogicPatternView : public ui::View {
+   public:
+    LogicPatternView(ui::NavigationView& nav);
+    ~LogicPatternView();
+
+    std::string title() const override { return "Pattern Gen"; };
+    void focus() override;
+    void on_framesync() override;
+
+   private:
+    void configure();
+    void start();
+    void stop();
+    void send_control(PatternControl control);
+    void request_status();
+    void transmit();
+    void update_status_text();
+
+    ui::NavigationView& nav_;
+
+    uint32_t bitrate_{9600};
+    std::string bitrate_edit_{};
+    std::filesystem::path path_{};
+
+    pattern_status_t status_{};
+    uint8_t status_refresh_{0};
+
+    File file_{};
+    bool file_open_{false};
+    bool started_{false};   // the start was sent after the queue was filled
+    bool flushing_{false};  // waiting for the module to drop the queue of the previous run
+    uint8_t block_[std::filesystem::max_file_block_size]{};
+    size_t block_pos_{0};
+    size_t block_length_{0};
+    uint64_t file_size_{0};
+
+    ui::Labels labels{
+        {{UI_POS_X(0), UI_POS_Y(1)}, "File:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(3)}, "Rate:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(5)}, "Idle:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(10)}, "Output GPIO 47, clock 48.", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(11)}, "Bytes are played msb first.", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(12)}, "I2C keeps up to ~200 kbit/s", ui::Theme::getInstance()->fg_yellow->foreground}};
+
+    ui::Button button_file{{UI_POS_X(6), UI_POS_Y(1) - 2, UI_POS_WIDTH(23), UI_POS_HEIGHT(1) + 4}, "Select"};
+    ui::Button button_bitrate{{UI_POS_X(6), UI_POS_Y(3) - 2, UI_POS_WIDTH(14), UI_POS_HEIGHT(1) + 4}, ""};
+    ui::OptionsField option_idle{
+        {UI_POS_X(6), UI_POS_Y(5)},
+        4,
+        {{"Low", 0},
+         {"High", 1}}};
+
+    ui::Text text_state{{UI_POS_X(0), UI_POS_Y(7), UI_POS_MAXWIDTH, UI_POS_HEIGHT(1)}, "Off"};
+    ui::Text text_underruns{{UI_POS_X(0), UI_POS_Y(8), UI_POS_MAXWIDTH, UI_POS_HEIGHT(1)}, ""};
+
+    ui::Button button_start{{UI_POS_X_CENTER(10), UI_POS_Y_BOTTOM(5), UI_POS_WIDTH(10), UI_POS_HEIGHT(2)}, "Start"};
+};
+
+class LogicAPPView : public ui::View {
+   public:
+    LogicAPPView(ui::NavigationView& nav);
+
+    ~LogicAPPView() {
+        ui::Theme::destroy();
+    }
+
+    void on_framesync() override;
+
+    void focus() override {
+        button_arm.focus();
+    }
+
+   private:
+    void arm();
+    void stop();
+    void request_status();
+    void download();
+    void set_pattern(const std::string& pattern);
+    void update_status_text();
+
+    ui::NavigationView& nav_;
+
+    logic_capture_status_t status_{};
+    bool polling_{false};
+    uint8_t status_refresh_{0};
+
+    std::unique_ptr<uint8_t[]> capture_{};
+    size_t capture_size_{0};
+    size_t downloaded_{0};
+    bool downloading_{false};
+
+    // one character per channel: 0, 1 or x for don't care
+    std::string pattern_{"xxxxxxxx"};
+    std::string pattern_edit_{};
+    uint8_t pattern_mask_{0};
+    uint8_t pattern_value_{0};
+
+    ui::OptionsField option_trigger{
+        {4, 4},
+        4,
+        {{"None", (int32_t)LogicTriggerType::TRIGGER_NONE},
+         {"Rise", (int32_t)LogicTriggerType::TRIGGER_RISING},
+         {"Fall", (int32_t)LogicTriggerType::TRIGGER_FALLING},
+         {"Edge", (int32_t)LogicTriggerType::TRIGGER_EDGE},
+         {"Patt", (int32_t)LogicTriggerType::TRIGGER_PATTERN}}};
+    ui::OptionsField option_channel{
+        {44, 4},
+        3,
+        {{"Ch0", 0},
+         {"Ch1", 1},
+         {"Ch2", 2},
+         {"Ch3", 3},
+         {"Ch4", 4},
+         {"Ch5", 5},
+         {"Ch6", 6},
+         {"Ch7", 7}}};
+    ui::NumberField field_pre_trigger{
+        {76, 4},
+        3,
+        {0, 100},
+        10,
+        ' '};
+    ui::Text text_percent{{100, 4, 8, 16}, "%"};
+    // capture time after the trigger in ms
+    ui::OptionsField option_time{
+        {112, 4},
+        5,
+        {{"10ms", 10},
+         {"100ms", 100},
+         {"1s", 1000},
+         {"4s", 4000}}};
+    ui::Button button_arm{{156, 4, 40, 24}, "Arm"};
+    ui::Button button_fit{{200, 4, 36, 24}, "Fit"};
+
+    ui::Button button_pattern{{4, 28, 88, 20}, "xxxxxxxx"};
+    ui::Text text_status{{96, 30, 96, 16}, "Idle"};
+    ui::Button button_generator{{196, 28, 40, 20}, "Gen"};
+
+    ui::LogicTrace trace{{0, 52, UI_POS_MAXWIDTH, UI_POS_HEIGHT_REMAINING(5) - 4}};
+
+    ui::Text text_pins{{0, UI_POS_Y_BOTTOM(2), UI_POS_MAXWIDTH, 8}, "Ch0-7: GPIO 1 2 3 4 7 10 11 21"};
+};
+
+}  // namespace ui
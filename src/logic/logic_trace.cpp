@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include "logic_trace.hpp"
+
+#include <algorithm>
+
+namespace ui {
+
+static const Color lane_colors[LogicTrace::max_channels] = {
+    Color::white(), Color::yellow(), Color::cyan(), Color::green(),
+    Color::magenta(), Color::orange(), Color::red(), Color::blue()};
+
+// one record: levels byte and the time since the previous record as base 128 varint, see the module's logic_rle.hpp
+static size_t decode_record(const uint8_t* data, size_t len, uint8_t& levels, uint32_t& delta) {
+    if (len < 2)
+        return 0;
+
+    levels = data[0];
+    delta = 0;
+
+    for (size_t i = 1; i < len && i < 6; i++) {
+        delta |= (uint32_t)(data[i] & 0x7F) << (7 * (i - 1));
+        if ((data[i] & 0x80) == 0)
+            return i + 1;
+    }
+
+    return 0;
+}
+
+LogicTrace::LogicTrace(Rect parent_rect)
+    : Widget{parent_rect} {
+    set_focusable(true);
+}
+
+void LogicTrace::set_capture(const uint8_t* data, size_t size, size_t channel_count, uint32_t trigger_index, uint32_t cycles_per_us) {
+    data_ = data;
+    size_ = data != nullptr ? size : 0;
+    channel_count_ = std::clamp<size_t>(channel_count, 1, max_channels);
+    trigger_index_ = trigger_index;
+    cycles_per_us_ = cycles_per_us > 0 ? cycles_per_us : 1;
+    duration_ = 0;
+    trigger_time_ = 0;
+
+    size_t pos = 0;
+    uint32_t index = 0;
+    uint8_t levels;
+    uint32_t delta;
+
+    while (pos < size_) {
+        size_t length = decode_record(data_ + pos, size_ - pos, levels, delta);
+        if (length == 0)
+            break;
+
+        pos += length;
+        duration_ += delta;
+        if (index++ == trigger_index_)
+            trigger_time_ = duration_;
+    }
+
+    fit();
+}
+
+void LogicTrace::fit() {
+    start_ = 0;
+    scale_ = duration_ / trace_width() + 1;
+    set_dirty();
+}
+
+int LogicTrace::trace_width() const {
+    return std::max(1, (int)screen_rect().width() - label_width);
+}
+
+Coord LogicTrace::level_y(size_t channel, bool high) const {
+    auto r = screen_rect();
+    Dim lane_height = (r.height() - ruler_height) / channel_count_;
+    Coord top = r.top() + ruler_height + channel * lane_height;
+
+    // a pixel of space above and below every lane
+    return high ? top + 2 : top + lane_height - 3;
+}
+
+int64_t LogicTrace::column_of(uint64_t time) const {
+    // everything left of the view shares the column just outside of it
+    if (time < start_)
+        return -1;
+
+    return (time - start_) / scale_;
+}
+
+void LogicTrace::clamp_start() {
+    uint64_t span = (uint64_t)trace_width() * scale_;
+
+    if (start_ + span > duration_)
+        start_ = duration_ > span ? duration_ - span : 0;
+}
+
+std::string LogicTrace::format_time(uint64_t cycles) const {
+    uint64_t ns = cycles * 1000 / cycles_per_us_;
+
+    if (ns < 1000)
+        return std::to_string(ns) + "ns";
+
+    if (ns < 1000000)
+        return std::to_string(ns / 1000) + "." + std::to_string(ns / 100 % 10) + "us";
+
+    if (ns < 1000000000)
+        return std::to_string(ns / 1000000) + "." + std::to_string(ns / 100000 % 10) + "ms";
+
+    return std::to_string(ns / 1000000000) + "." + std::to_string(ns / 100000000 % 10) + "s";
+}
+
+void LogicTrace::draw_ruler(Painter& painter, int64_t trigger_column) {
+    auto r = screen_rect();
+    const Style& s = style();
+    Coord x0 = r.left() + label_width;
+    int width = trace_width();
+
+    for (int x = 0; x < width; x += division)
+        painter.draw_vline({x0 + x, r.top() + ruler_height - 3}, 3, Color::grey());
+
+    // the left edge relative to the trigger and the time per tick
+    std::string position = start_ < trigger_time_ ? "T-" + format_time(trigger_time_ - start_) : "T+" + format_time(start_ - trigger_time_);
+    painter.draw_string({x0 + 2, r.top()}, s, position);
+
+    std::string division_text = format_time(scale_ * division) + "/div";
+    painter.draw_string({r.right() - (int)division_text.size() * s.font.char_width(), r.top()}, s, division_text);
+
+    if (trigger_column >= 0 && trigger_column < width)
+        painter.draw_vline({x0 + (Coord)trigger_column, r.top() + ruler_height}, r.height() - ruler_height, Color::dark_yellow());
+}
+
+void LogicTrace::draw_run(Painter& painter, int64_t from, int64_t to, uint8_t levels) {
+    from = std::max<int64_t>(from, 0);
+    to = std::min<int64_t>(to, trace_width());
+    if (to <= from)
+        return;
+
+    Coord x = screen_rect().left() + label_width + from;
+    for (size_t channel = 0; channel < channel_count_; channel++)
+        painter.draw_hline({x, level_y(channel, levels & (1 << channel))}, to - from, lane_colors[channel]);
+}
+
+// a column that saw both levels of a channel gets a full bar, which also shows the edge of a single change
+void LogicTrace::draw_column(Painter& painter, int64_t column, uint8_t any_high, uint8_t all_high) {
+    if (column < 0 || column >= trace_width())
+        return;
+
+    Coord x = screen_rect().left() + label_width + column;
+    for (size_t channel = 0; channel < channel_count_; channel++) {
+        uint8_t bit = 1 << channel;
+        Coord high = level_y(channel, true);
+
+        if ((any_high ^ all_high) & bit)
+            painter.draw_vline({x, high}, level_y(channel, false) - high + 1, lane_colors[channel]);
+        else
+            painter.draw_pixel({x, level_y(channel, any_high & bit)}, lane_colors[channel]);
+    }
+}
+
+void LogicTrace::paint(Painter& painter) {
+    auto r = screen_rect();
+    const Style& s = style();
+    painter.fill_rectangle(r, s.background);
+
+    if (data_ == nullptr || size_ == 0) {
+        painter.draw_string({r.left() + label_width, r.top() + r.height() / 2}, s, "No capture");
+        return;
+    }
+
+    draw_ruler(painter, column_of(trigger_time_));
+
+    for (size_t channel = 0; channel < channel_count_; channel++) {
+        Coord y = (level_y(channel, true) + level_y(channel, false) - s.font.line_height()) / 2;
+        painter.draw_string({r.left(), y}, s.font, lane_colors[channel], s.background, std::to_string(channel));
+    }
+
+    int width = trace_width();
+    uint64_t time = 0;
+    size_t pos = 0;
+    uint32_t index = 0;
+    int64_t column = -1;
+    uint8_t current = 0;
+    uint8_t any_high = 0;
+    uint8_t all_high = 0;
+
+    while (pos < size_ && column < width) {
+        uint8_t levels;
+        uint32_t delta;
+        size_t length = decode_record(data_ + pos, size_ - pos, levels, delta);
+        if (length == 0)
+            break;
+
+        pos += length;
+        time += delta;
+        int64_t x = column_of(time);
+
+        if (index++ == 0) {
+            column = x;
+            any_high = levels;
+            all_high = levels;
+        } else if (x != column) {
+            // the levels before this record hold until its column
+            draw_column(painter, column, any_high, all_high);
+            draw_run(painter, column + 1, x, current);
+            column = x;
+            any_high = current | levels;
+            all_high = current & levels;
+        } else {
+            any_high |= levels;
+            all_high &= levels;
+        }
+
+        current = levels;
+    }
+
+    draw_column(painter, column, any_high, all_high);
+}
+
+bool LogicTrace::on_encoder(const EncoderEvent delta) {
+    if (data_ == nullptr)
+        return false;
+
+    uint64_t half = (uint64_t)trace_width() / 2;
+    uint64_t center = start_ + half * scale_;
+    uint64_t max_scale = duration_ / trace_width() + 1;
+
+    // turning right zooms in
+    for (EncoderEvent i = 0; i < std::abs(delta); i++)
+        scale_ = delta > 0 ? std::max<uint64_t>(scale_ / 2, 1) : std::min<uint64_t>(scale_ * 2, max_scale);
+
+    start_ = center > half * scale_ ? center - half * scale_ : 0;
+    clamp_start();
+    set_dirty();
+    return true;
+}
+
+bool LogicTrace::on_touch(const TouchEvent event) {
+    switch (event.type) {
+        case TouchEvent::Type::Start:
+            touch_x_ = event.point.x();
+            return true;
+
+        case TouchEvent::Type::Move: {
+            // dragging right shows earlier samples
+            int64_t shift = (int64_t)(event.point.x() - touch_x_) * (int64_t)scale_;
+            if (shift == 0)
+                return true;
+
+            touch_x_ = event.point.x();
+            start_ = shift > 0 ? (start_ > (uint64_t)shift ? start_ - shift : 0) : start_ - shift;
+            clamp_start();
+            set_dirty();
+            return true;
+        }
+
+        default:
+            return true;
+    }
+}
+
+void LogicTrace::getWidgetName(std::string& result) {
+    result = "LogicTrace";
+}
+
+}  // namespace ui
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#pragma once
+
+#include "ui/ui_widget.hpp"
+
+#include <string>
+
+namespace ui {
+
+/*
+    Shows a run length coded logic capture (see the module's logic_rle.hpp) as one lane per channel.
+    The capture is decoded on every paint, changes that fall into the same pixel column are drawn as a bar.
+    Turning the encoder zooms around the center, dragging pans.
+*/
+class LogicTrace : public Widget {
+   public:
+    static constexpr size_t max_channels = 8;
+
+    LogicTrace(Rect parent_rect);
+
+    LogicTrace(const LogicTrace&) = delete;
+    LogicTrace& operator=(const LogicTrace&) = delete;
+
+    // data has to stay valid until the next call, nullptr clears the trace
+    void set_capture(const uint8_t* data, size_t size, size_t channel_count, uint32_t trigger_index, uint32_t cycles_per_us);
+    // zooms out to the whole capture
+    void fit();
+
+    void paint(Painter& painter) override;
+    bool on_encoder(const EncoderEvent delta) override;
+    bool on_touch(const TouchEvent event) override;
+    void getWidgetName(std::string& result) override;
+
+   private:
+    static constexpr int label_width = 8;
+    static constexpr int ruler_height = 8;
+    static constexpr int division = 40;  // pixels between two ruler ticks
+
+    int trace_width() const;
+    Coord level_y(size_t channel, bool high) const;
+    int64_t column_of(uint64_t time) const;
+    void clamp_start();
+    std::string format_time(uint64_t cycles) const;
+    void draw_ruler(Painter& painter, int64_t trigger_column);
+    void draw_run(Painter& painter, int64_t from, int64_t to, uint8_t levels);
+    void draw_column(Painter& painter, int64_t column, uint8_t any_high, uint8_t all_high);
+
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+    size_t channel_count_{max_channels};
+    uint32_t trigger_index_{0};
+    uint32_t cycles_per_us_{1};
+    uint64_t duration_{0};     // cycles from the first to the last record
+    uint64_t trigger_time_{0};
+
+    uint64_t start_{0};  // cycles at the left edge
+    uint64_t scale_{1};  // cycles per pixel
+    Coord touch_x_{0};
+};
+
+}  // namespace ui
@@ -0,0 +1 @@
+docker build -t arm-docker-build ../common/config
@@ -64,7 +64,6 @@ class MapAppView : public ui::View {
     ui::Button button_send{{0, UI_POS_Y(0), UI_POS_WIDTH(5), UI_POS_HEIGHT(2)}, "Move", true};
     // ui::Button button_recv{{1, 60, 7 * 16 + 1, 20}, "Read ir"};
     ui::GeoMap geo_map{{0, UI_POS_Y(2), UI_POS_MAXWIDTH, UI_POS_MAXHEIGHT - 60}};
-    uint8_t rfcnt = 0;
 };
 
 }  // namespace ui
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "logic_capture.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+// while armed the loop pauses one tick this often so the idle task can feed the watchdog
+#define LOGIC_ARMED_YIELD_MS 1000
+
+LogicCapture::LogicCapture(const gpio_num_t* pins, size_t pin_count)
+    : pin_count(pin_count < LOGIC_CHANNEL_COUNT ? pin_count : LOGIC_CHANNEL_COUNT) {
+    for (size_t i = 0; i < this->pin_count; i++)
+        this->pins[i] = pins[i];
+}
+
+void LogicCapture::start_task() {
+    times = (uint32_t*)malloc(LOGIC_CAPTURE_DEPTH * sizeof(uint32_t));
+    levels = (uint8_t*)malloc(LOGIC_CAPTURE_DEPTH);
+    encoded = (uint8_t*)malloc((LOGIC_CAPTURE_DEPTH + 1) * LOGIC_RLE_MAX_RECORD);
+
+    if (times == nullptr || levels == nullptr || encoded == nullptr) {
+        esp_rom_printf("logic: not enough memory for the capture buffers\n");
+        return;
+    }
+
+    configure_pins();
+
+    // the sampling loop busy waits, so it gets the second core to itself
+    xTaskCreatePinnedToCore(task, "logic_task", 1024 * 3, this, 20, NULL, 1);
+}
+
+bool LogicCapture::parse_config(const uint8_t* data, size_t len, logic_capture_config_t& config) {
+    if (len < 7)
+        return false;
+
+    if (data[0] > (uint8_t)LogicTriggerType::TRIGGER_PATTERN || data[1] >= LOGIC_CHANNEL_COUNT || data[4] > 100)
+        return false;
+
+    config.trigger.type = (LogicTriggerType)data[0];
+    config.trigger.channel = data[1];
+    config.trigger.mask = data[2];
+    config.trigger.value = data[3] & data[2];
+    config.pre_trigger_percent = data[4];
+    config.max_time_ms = data[5] | (data[6] << 8);
+
+    if (config.max_time_ms == 0)
+        config.max_time_ms = LOGIC_MAX_TIME_MS_DEFAULT;
+
+    if (config.max_time_ms > LOGIC_MAX_TIME_MS_LIMIT)
+        config.max_time_ms = LOGIC_MAX_TIME_MS_LIMIT;
+
+    return true;
+}
+
+void LogicCapture::request_arm(const logic_capture_config_t& config) {
+    if (arm_pending)
+        return;
+
+    pending_config = config;
+    arm_pending = true;
+}
+
+void LogicCapture::request_stop() {
+    stop_pending = true;
+}
+
+void LogicCapture::get_status(logic_capture_status_t& status) const {
+    status.state = state;
+    status.channel_count = pin_count;
+    status.levels = read_levels();
+    status.reserved = 0;
+    status.transitions = transitions;
+    status.trigger_index = trigger_index;
+    status.encoded_size = state == LogicCaptureState::CAPTURE_DONE ? encoded_size : 0;
+    status.cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+}
+
+size_t LogicCapture::read(uint32_t offset, uint8_t* out, size_t len) const {
+    if (state != LogicCaptureState::CAPTURE_DONE || offset >= encoded_size)
+        return 0;
+
+    if (len > encoded_size - offset)
+        len = encoded_size - offset;
+
+    memcpy(out, encoded + offset, len);
+    return len;
+}
+
+void LogicCapture::task(void* arg) {
+    LogicCapture* self = (LogicCapture*)arg;
+
+    while (true) {
+        self->stop_pending = false;
+
+        if (self->arm_pending) {
+            self->config = self->pending_config;
+            self->arm_pending = false;
+            self->capture();
+        }
+
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+}
+
+void LogicCapture::configure_pins() {
+    for (size_t i = 0; i < pin_count; i++) {
+        gpio_reset_pin(pins[i]);
+        gpio_set_direction(pins[i], GPIO_MODE_INPUT);
+        // unconnected inputs would fill the buffer with noise
+        gpio_set_pull_mode(pins[i], GPIO_PULLDOWN_ONLY);
+    }
+}
+
+// all pins are below 32, so a single register read samples every channel at the same time
+uint8_t IRAM_ATTR LogicCapture::read_levels() const {
+    uint32_t in = REG_READ(GPIO_IN_REG);
+    uint8_t result = 0;
+
+    for (size_t i = 0; i < pin_count; i++)
+        result |= ((in >> pins[i]) & 1) << i;
+
+    return result;
+}
+
+void IRAM_ATTR LogicCapture::capture() {
+    const size_t mask = LOGIC_CAPTURE_DEPTH - 1;
+    // the trigger record needs a slot of its own
+    const size_t pre_limit = (LOGIC_CAPTURE_DEPTH - 1) * config.pre_trigger_percent / 100;
+    const uint32_t cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+    const uint32_t max_cycles = config.max_time_ms * 1000 * cycles_per_us;
+    const uint32_t yield_cycles = LOGIC_ARMED_YIELD_MS * 1000 * cycles_per_us;
+
+    transitions = 0;
+    trigger_index = 0;
+    encoded_size = 0;
+
+    uint32_t now = esp_cpu_get_cycle_count();
+    uint8_t last = read_levels();
+    times[0] = now;
+    levels[0] = last;
+
+    size_t head = 1;  // records written, the ring index is head & mask
+    size_t first = 0;
+    size_t trigger = 0;
+    uint32_t trigger_time = now;
+    uint32_t last_yield = now;
+    bool triggered = config.trigger.type == LogicTriggerType::TRIGGER_NONE;
+
+    state = triggered ? LogicCaptureState::CAPTURE_RUNNING : LogicCaptureState::CAPTURE_ARMED;
+    esp_rom_printf("logic: armed, trigger %d, %d%% pre-trigger\n", (int)config.trigger.type, config.pre_trigger_percent);
+
+    while (stop_pending == false && arm_pending == false) {
+        now = esp_cpu_get_cycle_count();
+        uint8_t current = read_levels();
+
+        if (current != last) {
+            times[head & mask] = now;
+            levels[head & mask] = current;
+
+            if (triggered == false && logic_trigger_check(config.trigger, last, current)) {
+                triggered = true;
+                trigger = head;
+                trigger_time = now;
+                first = head - (head < pre_limit ? head : pre_limit);
+                state = LogicCaptureState::CAPTURE_RUNNING;
+            }
+
+            head++;
+            last = current;
+
+            if (triggered && head - first >= LOGIC_CAPTURE_DEPTH)
+                break;
+        }
+
+        // no yielding once triggered, the capture time limit stays below the watchdog timeout
+        if (triggered) {
+            if (now - trigger_time >= max_cycles)
+                break;
+        } else if (now - last_yield >= yield_cycles) {
+            vTaskDelay(1);
+            last_yield = esp_cpu_get_cycle_count();
+        }
+    }
+
+    if (triggered == false) {
+        state = LogicCaptureState::CAPTURE_IDLE;
+        esp_rom_printf("logic: stopped before the trigger\n");
+        return;
+    }
+
+    encode(first, head - first, now);
+    trigger_index = trigger - first;
+    transitions = head - first + 1;
+    state = LogicCaptureState::CAPTURE_DONE;
+    esp_rom_printf("logic: captured %d transitions, %d bytes encoded\n", transitions, encoded_size);
+}
+
+void LogicCapture::encode(size_t first, size_t count, uint32_t end_time) {
+    const size_t mask = LOGIC_CAPTURE_DEPTH - 1;
+    uint32_t previous = times[first & mask];
+    uint8_t last = levels[first & mask];
+    size_t size = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = (first + i) & mask;
+        last = levels[index];
+        size += logic_rle_put(encoded + size, last, times[index] - previous);
+        previous = times[index];
+    }
+
+    // unchanged levels mark the end, so the trace shows the quiet time after the last transition
+    size += logic_rle_put(encoded + size, last, end_time - previous);
+    encoded_size = size;
+}
@@ -0,0 +1,103 @@
+#ifndef LOGIC_CAPTURE_HPP
+#define LOGIC_CAPTURE_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include "driver/gpio.h"
+
+#include "logic_rle.hpp"
+#include "logic_trigger.hpp"
+#include "pp_protocol.hpp"
+
+#define LOGIC_CHANNEL_COUNT 8
+// transitions kept per capture, the encoded capture needs up to LOGIC_RLE_MAX_RECORD bytes each
+// and has to fit the memory of the app on the PortaPack
+#define LOGIC_CAPTURE_DEPTH 4096
+#define LOGIC_MAX_TIME_MS_DEFAULT 1000
+// the sampling loop does not yield once triggered, so a capture has to end before the 5 s task watchdog
+#define LOGIC_MAX_TIME_MS_LIMIT 4000
+// encoded capture bytes per read command
+#define LOGIC_READ_BLOCK_SIZE 128
+
+enum class LogicCaptureState : uint8_t {
+    CAPTURE_IDLE = 0,
+    CAPTURE_ARMED,    // recording pre-trigger history, waiting for the trigger
+    CAPTURE_RUNNING,  // triggered, recording until the buffer is full or the time is up
+    CAPTURE_DONE,     // the encoded capture is ready to be read
+};
+
+typedef struct
+{
+    logic_trigger_t trigger;
+    uint8_t pre_trigger_percent;  // share of the buffer kept from before the trigger
+    uint16_t max_time_ms;         // capture time after the trigger
+} logic_capture_config_t;
+
+typedef struct
+{
+    LogicCaptureState state;
+    uint8_t channel_count;
+    uint8_t levels;  // current levels, bit per channel
+    uint8_t reserved;
+    uint32_t transitions;     // records in the capture
+    uint32_t trigger_index;   // record that fired the trigger
+    uint32_t encoded_size;    // bytes to read once the capture is done
+    uint32_t cycles_per_us;   // unit of the record deltas
+} logic_capture_status_t;
+PP_MESSAGE(logic_capture_status_t, PP_LOGIC_CAPTURE_STATUS_SIZE);
+
+/*
+    Samples up to 8 gpios with a busy loop pinned to the second core and keeps every level change
+    with its cpu cycle timestamp. Arming and stopping are requested from the i2c irq and applied by the capture task.
+*/
+class LogicCapture {
+   public:
+    LogicCapture(const gpio_num_t* pins, size_t pin_count);
+
+    LogicCapture(const LogicCapture&) = delete;
+    LogicCapture& operator=(const LogicCapture&) = delete;
+
+    void start_task();
+
+    // wire format: trigger type, trigger channel, pattern mask, pattern value, pre-trigger percent, max time in ms (2 bytes)
+    static bool parse_config(const uint8_t* data, size_t len, logic_capture_config_t& config);
+
+    void request_arm(const logic_capture_config_t& config);
+    void request_stop();
+
+    void get_status(logic_capture_status_t& status) const;
+    // copies encoded capture data from offset, returns the bytes copied, i2c irq only
+    size_t read(uint32_t offset, uint8_t* out, size_t len) const;
+
+   private:
+    static void task(void* arg);
+
+    void configure_pins();
+    uint8_t read_levels() const;
+    void capture();
+    void encode(size_t first, size_t count, uint32_t end_time);
+
+    gpio_num_t pins[LOGIC_CHANNEL_COUNT]{};
+    size_t pin_count;
+
+    volatile bool arm_pending{false};
+    volatile bool stop_pending{false};
+    logic_capture_config_t pending_config{};
+    logic_capture_config_t config{};
+
+    volatile LogicCaptureState state{LogicCaptureState::CAPTURE_IDLE};
+    volatile uint32_t transitions{0};
+    volatile uint32_t trigger_index{0};
+
+    // ring of transitions, the timestamps and levels are kept apart so the sampling loop only does two stores
+    uint32_t* times{nullptr};
+    uint8_t* levels{nullptr};
+
+    uint8_t* encoded{nullptr};
+    volatile uint32_t encoded_size{0};
+};
+
+extern LogicCapture logic_capture;
+
+#endif
@@ -0,0 +1,30 @@
+#include "logic_rle.hpp"
+
+size_t logic_rle_put(uint8_t* out, uint8_t levels, uint32_t delta) {
+    size_t length = 0;
+    out[length++] = levels;
+
+    while (delta >= 0x80) {
+        out[length++] = (delta & 0x7F) | 0x80;
+        delta >>= 7;
+    }
+    out[length++] = delta;
+
+    return length;
+}
+
+size_t logic_rle_get(const uint8_t* data, size_t len, uint8_t& levels, uint32_t& delta) {
+    if (len < 2)
+        return 0;
+
+    levels = data[0];
+    delta = 0;
+
+    for (size_t i = 1; i < len && i < LOGIC_RLE_MAX_RECORD; i++) {
+        delta |= (uint32_t)(data[i] & 0x7F) << (7 * (i - 1));
+        if ((data[i] & 0x80) == 0)
+            return i + 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef LOGIC_RLE_HPP
+#define LOGIC_RLE_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+// levels byte and a 32 bit delta in at most five 7 bit groups
+#define LOGIC_RLE_MAX_RECORD 6
+
+/*
+    Run length coding of a logic capture: every record is the levels of all channels (one bit each)
+    followed by the time since the previous record as a little endian base 128 varint.
+    The first record of a capture has a delta of 0, a record with unchanged levels marks the end of the capture.
+*/
+
+// writes one record to out, which needs LOGIC_RLE_MAX_RECORD bytes, returns its size
+size_t logic_rle_put(uint8_t* out, uint8_t levels, uint32_t delta);
+
+// reads one record from data, returns its size or 0 if the record is incomplete or malformed
+size_t logic_rle_get(const uint8_t* data, size_t len, uint8_t& levels, uint32_t& delta);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef LOGIC_TRIGGER_HPP
+#define LOGIC_TRIGGER_HPP
+
+#include <cstdint>
+
+enum class LogicTriggerType : uint8_t {
+    TRIGGER_NONE = 0,  // capture starts right away
+    TRIGGER_RISING,    // channel goes high
+    TRIGGER_FALLING,   // channel goes low
+    TRIGGER_EDGE,      // channel changes in either direction
+    TRIGGER_PATTERN,   // the masked levels start to match the value
+};
+
+typedef struct
+{
+    LogicTriggerType type;
+    uint8_t channel;  // edge triggers
+    uint8_t mask;     // pattern trigger, bit per channel
+    uint8_t value;    // pattern trigger, bit per channel
+} logic_trigger_t;
+
+// true when the change from previous to levels fires the trigger
+inline bool logic_trigger_check(const logic_trigger_t& trigger, uint8_t previous, uint8_t levels) {
+    uint8_t bit = 1 << (trigger.channel & 0x07);
+
+    switch (trigger.type) {
+        case LogicTriggerType::TRIGGER_NONE:
+            return true;
+
+        case LogicTriggerType::TRIGGER_RISING:
+            return (previous & bit) == 0 && (levels & bit) != 0;
+
+        case LogicTriggerType::TRIGGER_FALLING:
+            return (previous & bit) != 0 && (levels & bit) == 0;
+
+        case LogicTriggerType::TRIGGER_EDGE:
+            return ((previous ^ levels) & bit) != 0;
+
+        case LogicTriggerType::TRIGGER_PATTERN:
+            return (previous & trigger.mask) != trigger.value && (levels & trigger.mask) == trigger.value;
+    }
+
+    return false;
+}
+
+#endif
@@ -8,15 +8,42 @@
 #include "driver/i2c.h"
 #include "driver/uart.h"
 #include "uart_app.h"
+#include "logic_app.h"
+#include "logic_capture.hpp"
+#include "pattern_generator.hpp"
+#include "uart_channel.hpp"
 
 #include "ppi2c/pp_handler.hpp"
 
 static_assert(sizeof(uart_app) % 32 == 0, "app size must be multiple of 32 bytes. fill with 0s");
+static_assert(sizeof(logic_app) % 32 == 0, "app size must be multiple of 32 bytes. fill with 0s");
 
 #define I2C_SLAVE_SDA_IO GPIO_NUM_6
 #define I2C_SLAVE_SCL_IO GPIO_NUM_5
 
 #define UART_RX GPIO_NUM_14
+#define UART_RX_2 GPIO_NUM_13
+#define UART_RX_3 GPIO_NUM_12
+#define UART_TX GPIO_NUM_18
+#define UART_TX_2 GPIO_NUM_8
+#define UART_TX_3 GPIO_NUM_9
+#define UART_RTS GPIO_NUM_15
+#define UART_RTS_2 GPIO_NUM_16
+#define UART_RTS_3 GPIO_NUM_17
+
+// logic analyzer inputs, all below 32 so one register read samples them together
+#define LOGIC_CH0 GPIO_NUM_1
+#define LOGIC_CH1 GPIO_NUM_2
+#define LOGIC_CH2 GPIO_NUM_3
+#define LOGIC_CH3 GPIO_NUM_4
+#define LOGIC_CH4 GPIO_NUM_7
+#define LOGIC_CH5 GPIO_NUM_10
+#define LOGIC_CH6 GPIO_NUM_11
+#define LOGIC_CH7 GPIO_NUM_21
+
+// pattern generator output and its bit clock
+#define PATTERN_OUT GPIO_NUM_47
+#define PATTERN_CLOCK GPIO_NUM_48
 
 #define ESP_SLAVE_ADDR 0x51
 
@@ -32,16 +59,42 @@ static_assert(sizeof(uart_app) % 32 == 0, "app size must be multiple of 32 bytes
 #define COMMAND_UART_BAUDRATE_INC (USER_COMMANDS_START + 2)
 #define COMMAND_UART_BAUDRATE_DEC (USER_COMMANDS_START + 3)
 #define COMMAND_UART_BAUDRATE_GET (USER_COMMANDS_START + 4)
-
-void initialize_uart(uint32_t baudrate);
-void deinitialize_uart();
-
-uint32_t baudrate = 115200;
-
-std::vector<uint32_t> baudrates = {50, 75, 110, 134, 150, 200, 300, 600,
-                                   1200, 2400, 4800, 9600, 14400, 19200,
-                                   28800, 38400, 57600, 115200, 230400,
-                                   460800, 576000, 921600, 1843200, 3686400};
+#define COMMAND_UART_FILTER_SET (USER_COMMANDS_START + 5)
+#define COMMAND_UART_REQUESTDATA_MUX_SHORT (USER_COMMANDS_START + 6)
+#define COMMAND_UART_REQUESTDATA_MUX_LONG (USER_COMMANDS_START + 7)
+#define COMMAND_UART_CHANNEL_ENABLE (USER_COMMANDS_START + 8)
+#define COMMAND_UART_CHANNEL_STATUS_GET (USER_COMMANDS_START + 9)
+#define COMMAND_UART_BAUDRATE_SET (USER_COMMANDS_START + 10)
+#define COMMAND_UART_AUTOBAUD (USER_COMMANDS_START + 11)
+#define COMMAND_UART_FLOWCTRL_SET (USER_COMMANDS_START + 12)
+#define COMMAND_UART_TX_DATA (USER_COMMANDS_START + 13)
+#define COMMAND_UART_FRAMING_SET (USER_COMMANDS_START + 14)
+// logic analyzer commands
+#define COMMAND_LOGIC_ARM (USER_COMMANDS_START + 15)
+#define COMMAND_LOGIC_STOP (USER_COMMANDS_START + 16)
+#define COMMAND_LOGIC_STATUS_GET (USER_COMMANDS_START + 17)
+#define COMMAND_LOGIC_READ (USER_COMMANDS_START + 18)
+// pattern generator commands
+#define COMMAND_PATTERN_CONFIG (USER_COMMANDS_START + 19)
+#define COMMAND_PATTERN_CONTROL (USER_COMMANDS_START + 20)
+#define COMMAND_PATTERN_DATA (USER_COMMANDS_START + 21)
+#define COMMAND_PATTERN_STATUS_GET (USER_COMMANDS_START + 22)
+
+#define UART_BAUDRATE_MIN 50
+#define UART_BAUDRATE_MAX 5000000
+
+// channel 3 shares UART0 with the boot console, its log output is still available on the usb serial jtag
+UartChannel uart_channels[UART_CHANNEL_COUNT] = {
+    {UART_NUM_1, UART_RX, UART_TX, UART_RTS, true, 115200},
+    {UART_NUM_2, UART_RX_2, UART_TX_2, UART_RTS_2, false, 115200},
+    {UART_NUM_0, UART_RX_3, UART_TX_3, UART_RTS_3, false, 115200}};
+
+const gpio_num_t logic_pins[] = {LOGIC_CH0, LOGIC_CH1, LOGIC_CH2, LOGIC_CH3, LOGIC_CH4, LOGIC_CH5, LOGIC_CH6, LOGIC_CH7};
+LogicCapture logic_capture(logic_pins, sizeof(logic_pins) / sizeof(logic_pins[0]));
+// offset of the next COMMAND_LOGIC_READ response, set by its command data
+uint32_t logic_read_offset = 0;
+
+PatternGenerator pattern_generator(PATTERN_OUT, PATTERN_CLOCK);
 
 void initialize_gpio()
 {
@@ -56,58 +109,44 @@ void initialize_gpio()
     gpio_set_level(LED_BLUE, 1);
 }
 
-std::queue<uint8_t> uart_queue;
-
-#define BUF_SIZE (1024)
-
-void initialize_uart(uint32_t baudrate)
+// the optional first byte of a command selects the channel, default is the first one
+uint8_t get_channel(pp_command_data_t &data)
 {
-    uart_config_t uart_config = {
-        .baud_rate = (int)baudrate,
-        .data_bits = UART_DATA_8_BITS,
-        .parity = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .rx_flow_ctrl_thresh = 0,
-        .source_clk = UART_SCLK_DEFAULT,
-        .flags = {.backup_before_sleep = 0}};
-
-    int intr_alloc_flags = 0;
-
-#if CONFIG_UART_ISR_IN_IRAM
-    intr_alloc_flags = ESP_INTR_FLAG_IRAM;
-#endif
-
-    ESP_ERROR_CHECK(uart_driver_install(UART_NUM_1, BUF_SIZE * 2, 0, 0, NULL, intr_alloc_flags));
-    ESP_ERROR_CHECK(uart_param_config(UART_NUM_1, &uart_config));
-    ESP_ERROR_CHECK(uart_set_pin(UART_NUM_1, UART_PIN_NO_CHANGE, UART_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+    if (data.data->size() > 0 && (*data.data)[0] < UART_CHANNEL_COUNT)
+        return (*data.data)[0];
+
+    return 0;
 }
 
-void deinitialize_uart()
+// legacy drain commands only read the first channel
+void drain_first_channel(pp_command_data_t &data, size_t max_data_length)
 {
-    ESP_ERROR_CHECK(uart_driver_delete(UART_NUM_1));
+    data.data->resize(1 + max_data_length);
+
+    uint8_t bytesToSend = uart_channels[0].read(data.data->data() + 1, max_data_length);
+    bool moreData = uart_channels[0].available() > 0;
+    (*data.data)[0] = (bytesToSend & 0x7F) | (moreData << 7);
+
+    for (size_t i = bytesToSend; i < max_data_length; i++)
+        (*data.data)[i + 1] = 0xFF;
 }
 
-static void uart_task(void *arg)
+// remaining bytes are filled with 0xFF
+void drain_all_channels(pp_command_data_t &data, size_t max_data_length)
 {
-    uint8_t *data = (uint8_t *)malloc(BUF_SIZE);
-    while (true)
-    {
-        try
-        {
-            int len = uart_read_bytes(UART_NUM_1, data, (BUF_SIZE - 1), 20 / portTICK_PERIOD_MS);
-            if (len != 0)
-            {
-                for (int i = 0; i < len; i++)
-                    uart_queue.push(data[i]);
-            }
-        }
-        catch (const std::exception &ex)
-        {
-            std::cout << "Exception: " << std::endl;
-            std::cout << ex.what() << std::endl;
-        }
-    }
+    const size_t header_length = 1 + sizeof(uart_drain_status_t);
+    data.data->resize(header_length + max_data_length);
+
+    bool moreData = false;
+    size_t length = uart_channels_drain(data.data->data() + header_length, max_data_length, moreData);
+    (*data.data)[0] = (length & 0x7F) | (moreData << 7);
+
+    uart_drain_status_t status;
+    uart_channels_drain_status(status);
+    memcpy(data.data->data() + 1, &status, sizeof(status));
+
+    for (size_t i = length; i < max_data_length; i++)
+        (*data.data)[i + header_length] = 0xFF;
 }
 
 extern "C" void app_main(void)
@@ -116,86 +155,263 @@ extern "C" void app_main(void)
     PPHandler::set_module_name("ESP32-S3-PPDEVKIT");
     PPHandler::set_module_version(1);
     PPHandler::add_app(uart_app, sizeof(uart_app));
+    PPHandler::add_app(logic_app, sizeof(logic_app));
     PPHandler::add_custom_command(COMMAND_UART_REQUESTDATA_SHORT, nullptr, [](pp_command_data_t data)
                                   {
                                       // 1 bit: more data available
                                       // 7 bit: data length [0 to 4]
-                                      // 4 bytes: data from uart_queue optionally filled with 0xFF
+                                      // 4 bytes: data from the first channel optionally filled with 0xFF
 
-                                      const int max_data_length = 4;
-                                      data.data->resize(1 + max_data_length);
-
-                                      uint8_t bytesToSend = uart_queue.size() > max_data_length ? max_data_length : uart_queue.size();
-                                      bool moreData = uart_queue.size() > max_data_length ? 1 : 0;
-                                      (*data.data)[0] = (bytesToSend & 0x7F) | (moreData << 7);
-
-                                      for (int i = bytesToSend; i < max_data_length; i++)
-                                          (*data.data)[i + 1] = 0xFF;
-
-                                      for (int i = 0; i < bytesToSend; i++)
-                                      {
-                                          (*data.data)[i + 1] = uart_queue.front();
-                                          uart_queue.pop();
-                                      } });
+                                      drain_first_channel(data, 4); });
     PPHandler::add_custom_command(COMMAND_UART_REQUESTDATA_LONG, nullptr, [](pp_command_data_t data)
                                   {
-                                    // 1 bit: more data available
-                                    // 7 bit: data length [0 to 4]
-                                    // 4 bytes: data from uart_queue optionally filled with 0xFF
-
                                     // 1 bit: more data available
                                     // 7 bit: data length [0 to 127]
-                                    // 127 bytes: data from uart_queue optionally filled with 0xFF
-
-                                    const int max_data_length = 127;
-                                    data.data->resize(1 + max_data_length);                                    
+                                    // 127 bytes: data from the first channel optionally filled with 0xFF
 
-                                    uint8_t bytesToSend = uart_queue.size() > max_data_length ? max_data_length : uart_queue.size();
-                                    bool moreData = uart_queue.size() > max_data_length ? 1 : 0;
-                                    (*data.data)[0] = (bytesToSend & 0x7F) | (moreData << 7);
+                                    drain_first_channel(data, 127); });
+    PPHandler::add_custom_command(COMMAND_UART_REQUESTDATA_MUX_SHORT, nullptr, [](pp_command_data_t data)
+                                  {
+                                    // 1 bit: more data available on any channel
+                                    // 7 bit: length of the chunk stream [0 to 4]
+                                    // uart_drain_status_t: fill levels and overflow counters
+                                    // chunk stream, per chunk: 2 bit channel, 6 bit length [1 to 63], data
 
-                                    for (int i = bytesToSend; i < max_data_length; i++)
-                                        (*data.data)[i + 1] = 0xFF;
+                                    drain_all_channels(data, 4); });
+    PPHandler::add_custom_command(COMMAND_UART_REQUESTDATA_MUX_LONG, nullptr, [](pp_command_data_t data)
+                                  {
+                                    // 1 bit: more data available on any channel
+                                    // 7 bit: length of the chunk stream [0 to 108]
+                                    // uart_drain_status_t: fill levels and overflow counters
+                                    // chunk stream, per chunk: 2 bit channel, 6 bit length [1 to 63], data
 
-                                    for (int i = 0; i < bytesToSend; i++)
-                                    {
-                                        (*data.data)[i + 1] = uart_queue.front();
-                                        uart_queue.pop();
-                                    } });
+                                    drain_all_channels(data, 127 - sizeof(uart_drain_status_t)); });
     PPHandler::add_custom_command(COMMAND_UART_BAUDRATE_GET, nullptr, [](pp_command_data_t data)
                                   {
                                     data.data->resize(4);
+                                    uint32_t baudrate = uart_channels[0].get_baudrate();
                                     esp_rom_printf("COMMAND_UART_BAUDRATE_GET: %d\n", baudrate);
-                                    *(uint32_t *)(*data.data).data() = baudrate; });
+                                    pp_store(data.data->data(), baudrate); });
 
     PPHandler::add_custom_command(COMMAND_UART_BAUDRATE_INC, [](pp_command_data_t data)
                                   {
-                                      deinitialize_uart();
-                                      if (baudrate == baudrates.back())
-                                          baudrate = baudrates.front();
-                                      else
-                                      {
-                                          auto it = std::find(baudrates.begin(), baudrates.end(), baudrate);
-                                          baudrate = *(it + 1);
-                                      }
+                                      UartChannel &channel = uart_channels[get_channel(data)];
+                                      uint32_t baudrate = uart_baudrate_next(channel.get_baudrate());
                                       esp_rom_printf("COMMAND_UART_BAUDRATE_INC: %d\n", baudrate);
-                                      initialize_uart(baudrate); }, nullptr);
+                                      channel.request_baudrate(baudrate); }, nullptr);
 
     PPHandler::add_custom_command(COMMAND_UART_BAUDRATE_DEC, [](pp_command_data_t data)
                                   {
-                                    deinitialize_uart();
-                                    if (baudrate == baudrates.front())
-                                        baudrate = baudrates.back();
-                                    else
+                                    UartChannel &channel = uart_channels[get_channel(data)];
+                                    uint32_t baudrate = uart_baudrate_previous(channel.get_baudrate());
+                                    esp_rom_printf("COMMAND_UART_BAUDRATE_DEC: %d\n", baudrate);
+                                    channel.request_baudrate(baudrate); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_BAUDRATE_SET, [](pp_command_data_t data)
+                                  {
+                                    // uart_baudrate_message_t
+
+                                    uart_baudrate_message_t message;
+                                    if (pp_load(data.data->data(), data.data->size(), message) == false || message.channel >= UART_CHANNEL_COUNT)
+                                        return;
+
+                                    if (message.baudrate < UART_BAUDRATE_MIN || message.baudrate > UART_BAUDRATE_MAX)
+                                        return;
+
+                                    esp_rom_printf("COMMAND_UART_BAUDRATE_SET: %d\n", message.baudrate);
+                                    uart_channels[message.channel].request_baudrate(message.baudrate); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_AUTOBAUD, [](pp_command_data_t data)
+                                  {
+                                    // optional 1 byte: channel
+                                    // the result is reported by COMMAND_UART_CHANNEL_STATUS_GET
+
+                                    uart_channels[get_channel(data)].request_autobaud(); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_FILTER_SET, [](pp_command_data_t data)
+                                  {
+                                    // 1 byte: mode (off, include, exclude, trigger)
+                                    // 1 byte: context lines kept before the trigger
+                                    // 1 byte: rule count
+                                    // per rule: 1 byte type (prefix, substring), 1 byte length, pattern bytes
+                                    // the filter is applied to every channel
+
+                                    uart_filter_config_t config;
+                                    if (UartFilter::parse_config(data.data->data(), data.data->size(), config) == false)
                                     {
-                                        auto it = std::find(baudrates.begin(), baudrates.end(), baudrate);
-                                        baudrate = *(it - 1);
+                                        esp_rom_printf("COMMAND_UART_FILTER_SET: invalid config\n");
+                                        return;
                                     }
-                                    esp_rom_printf("COMMAND_UART_BAUDRATE_DEC: %d\n", baudrate);
 
-                                    initialize_uart(baudrate); }, nullptr);
+                                    for (auto &channel : uart_channels)
+                                        channel.request_filter(config); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_CHANNEL_ENABLE, [](pp_command_data_t data)
+                                  {
+                                    // 1 byte: channel
+                                    // 1 byte: 1 to enable, 0 to disable
+
+                                    if (data.data->size() != 2 || (*data.data)[0] >= UART_CHANNEL_COUNT)
+                                        return;
+
+                                    uart_channels[(*data.data)[0]].request_enabled((*data.data)[1] != 0); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_FLOWCTRL_SET, [](pp_command_data_t data)
+                                  {
+                                    // 1 byte: channel
+                                    // 1 byte: UartFlowControl
+                                    // 1 byte: UartDropPolicy
+                                    // 1 byte: high water mark in percent of the ring
+                                    // 1 byte: low water mark in percent of the ring
+
+                                    if (data.data->size() != 5 || (*data.data)[0] >= UART_CHANNEL_COUNT)
+                                        return;
+
+                                    if ((*data.data)[1] > (uint8_t)UartFlowControl::FLOW_RTS || (*data.data)[2] > (uint8_t)UartDropPolicy::DROP_OLDEST)
+                                        return;
+
+                                    uart_channels[(*data.data)[0]].request_flow_control((UartFlowControl)(*data.data)[1], (UartDropPolicy)(*data.data)[2],
+                                                                                        (*data.data)[3], (*data.data)[4]); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_FRAMING_SET, [](pp_command_data_t data)
+                                  {
+                                    // 1 byte: channel
+                                    // 1 byte: UartFrameMode (off, delimiter, length)
+                                    // 1 byte: max frame length [1 to 106]
+                                    // 1 byte: idle gap in ms that ends a frame, 0 is off
+                                    // 1 byte: flags (keep delimiter, big endian length)
+                                    // 1 byte: delimiter length [1 to 4], 4 bytes: delimiter
+                                    // 1 byte: length field offset, 1 byte: length field size, 1 byte: signed length adjustment
+                                    // drain responses then carry whole frames, see uart_channels_drain
+
+                                    uart_framing_config_t config;
+                                    if (data.data->size() < 1 || (*data.data)[0] >= UART_CHANNEL_COUNT ||
+                                        UartFramer::parse_config(data.data->data() + 1, data.data->size() - 1, config) == false)
+                                    {
+                                        esp_rom_printf("COMMAND_UART_FRAMING_SET: invalid config\n");
+                                        return;
+                                    }
+
+                                    uart_channels[(*data.data)[0]].request_framing(config); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_TX_DATA, [](pp_command_data_t data)
+                                  {
+                                    // 1 byte: channel
+                                    // n bytes: data to transmit [1 to 125]
+                                    // the sender keeps track of the tx space reported in uart_drain_status_t
+
+                                    if (data.data->size() < 2 || (*data.data)[0] >= UART_CHANNEL_COUNT)
+                                        return;
+
+                                    size_t length = data.data->size() - 1;
+                                    size_t written = uart_channels[(*data.data)[0]].write(data.data->data() + 1, length);
+                                    if (written != length)
+                                        esp_rom_printf("COMMAND_UART_TX_DATA: tx ring full, lost %d bytes\n", length - written); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_UART_CHANNEL_STATUS_GET, nullptr, [](pp_command_data_t data)
+                                  {
+                                    // uart_channel_status_t for every channel
+
+                                    data.data->resize(sizeof(uart_channel_status_t) * UART_CHANNEL_COUNT);
+                                    for (int i = 0; i < UART_CHANNEL_COUNT; i++)
+                                    {
+                                        uart_channel_status_t status;
+                                        uart_channels[i].get_status(status);
+                                        pp_store(data.data->data() + i * sizeof(status), status);
+                                    } });
+
+    PPHandler::add_custom_command(COMMAND_LOGIC_ARM, [](pp_command_data_t data)
+                                  {
+                                    // 1 byte: LogicTriggerType (none, rising, falling, edge, pattern)
+                                    // 1 byte: trigger channel [0 to 7]
+                                    // 1 byte: pattern mask, 1 byte: pattern value
+                                    // 1 byte: pre-trigger percent [0 to 100]
+                                    // 2 bytes: capture time after the trigger in ms, 0 is the default, at most 4000
+                                    // a running capture is stopped and the trigger armed again
+
+                                    logic_capture_config_t config;
+                                    if (LogicCapture::parse_config(data.data->data(), data.data->size(), config) == false)
+                                    {
+                                        esp_rom_printf("COMMAND_LOGIC_ARM: invalid config\n");
+                                        return;
+                                    }
+
+                                    logic_capture.request_arm(config); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_LOGIC_STOP, [](pp_command_data_t data)
+                                  {
+                                    // ends a running capture, which can then be read, or disarms the trigger
+
+                                    logic_capture.request_stop(); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_LOGIC_STATUS_GET, nullptr, [](pp_command_data_t data)
+                                  {
+                                    // logic_capture_status_t
+
+                                    logic_capture_status_t status;
+                                    logic_capture.get_status(status);
+                                    data.data->resize(sizeof(status));
+                                    pp_store(data.data->data(), status); });
+
+    PPHandler::add_custom_command(COMMAND_LOGIC_READ, [](pp_command_data_t data)
+                                  {
+                                    // logic_read_message_t
+
+                                    logic_read_message_t message;
+                                    if (pp_load(data.data->data(), data.data->size(), message))
+                                        logic_read_offset = message.offset; }, [](pp_command_data_t data)
+                                  {
+                                    // 128 bytes: encoded capture from the offset, see logic_rle.hpp, filled with 0xFF at the end
+
+                                    data.data->resize(LOGIC_READ_BLOCK_SIZE);
+                                    size_t length = logic_capture.read(logic_read_offset, data.data->data(), LOGIC_READ_BLOCK_SIZE);
+                                    for (size_t i = length; i < LOGIC_READ_BLOCK_SIZE; i++)
+                                        (*data.data)[i] = 0xFF; });
+
+    PPHandler::add_custom_command(COMMAND_PATTERN_CONFIG, [](pp_command_data_t data)
+                                  {
+                                    // pattern_config_message_t: bit rate [1000 to 8000000] or 0 for off, idle level (0 or 1)
+                                    // stops playing and drops the queued data
+
+                                    pattern_config_message_t message;
+                                    if (pp_load(data.data->data(), data.data->size(), message) == false)
+                                        return;
+
+                                    esp_rom_printf("COMMAND_PATTERN_CONFIG: %d\n", message.bitrate);
+                                    pattern_generator.request_config(message.bitrate, message.idle_level); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_PATTERN_CONTROL, [](pp_command_data_t data)
+                                  {
+                                    // 1 byte: PatternControl (stop, start, end of data)
+
+                                    if (data.data->size() < 1 || (*data.data)[0] > (uint8_t)PatternControl::CONTROL_END)
+                                        return;
+
+                                    pattern_generator.control((PatternControl)(*data.data)[0]); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_PATTERN_DATA, [](pp_command_data_t data)
+                                  {
+                                    // n bytes: pattern data, msb first [1 to 126]
+                                    // the sender keeps track of the queue space reported in pattern_status_t
+
+                                    size_t written = pattern_generator.write(data.data->data(), data.data->size());
+                                    if (written != data.data->size())
+                                        esp_rom_printf("COMMAND_PATTERN_DATA: queue full, lost %d bytes\n", data.data->size() - written); }, nullptr);
+
+    PPHandler::add_custom_command(COMMAND_PATTERN_STATUS_GET, nullptr, [](pp_command_data_t data)
+                                  {
+                                    // pattern_status_t
+
+                                    pattern_status_t status;
+                                    pattern_generator.get_status(status);
+                                    data.data->resize(sizeof(status));
+                                    pp_store(data.data->data(), status); });
+
 	PPHandler::init(I2C_SLAVE_SDA_IO, I2C_SLAVE_SCL_IO, ESP_SLAVE_ADDR);
-    initialize_uart(baudrate);
-    xTaskCreate(uart_task, "uart_task", 1024 * 2, (void *)0, 10, NULL);
+    uart_channels[0].start_task("uart_task");
+    uart_channels[1].start_task("uart_task_2");
+    uart_channels[2].start_task("uart_task_3");
+    logic_capture.start_task();
+    pattern_generator.start_task();
     std::cout << "[PP MDK] PortaPack - Module Develoment Kit is ready." << std::endl;
 }
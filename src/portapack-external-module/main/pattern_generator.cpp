@@ -0,0 +1,180 @@
+#include "pattern_generator.hpp"
+
+#include <cstdlib>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_rom_sys.h"
+
+// 8 bit stereo frames: the bit clock is 16 times the sample rate
+#define PATTERN_BITS_PER_FRAME 16
+
+PatternGenerator::PatternGenerator(gpio_num_t data_pin, gpio_num_t clock_pin)
+    : data_pin(data_pin),
+      clock_pin(clock_pin) {
+}
+
+void PatternGenerator::start_task() {
+    xTaskCreate(task, "pattern_task", 1024 * 3, this, 15, NULL);
+}
+
+void PatternGenerator::request_config(uint32_t bitrate, uint8_t idle_level) {
+    if (bitrate != 0 && bitrate < PATTERN_BITRATE_MIN)
+        bitrate = PATTERN_BITRATE_MIN;
+
+    if (bitrate > PATTERN_BITRATE_MAX)
+        bitrate = PATTERN_BITRATE_MAX;
+
+    pending_bitrate = bitrate;
+    pending_idle_level = idle_level != 0;
+    config_pending = true;
+}
+
+void PatternGenerator::control(PatternControl control) {
+    switch (control) {
+        case PatternControl::CONTROL_STOP:
+            stream.stop();
+            break;
+
+        case PatternControl::CONTROL_START:
+            if (channel != nullptr)
+                stream.start();
+            break;
+
+        case PatternControl::CONTROL_END:
+            stream.end();
+            break;
+    }
+}
+
+size_t PatternGenerator::write(const uint8_t* data, size_t len) {
+    if (channel == nullptr)
+        return 0;
+
+    return stream.push(data, len);
+}
+
+void PatternGenerator::get_status(pattern_status_t& status) const {
+    status.state = channel == nullptr ? PatternState::PATTERN_OFF : stream.is_playing() ? PatternState::PATTERN_PLAYING
+                                                                                       : PatternState::PATTERN_IDLE;
+    status.repeat = repeat;
+    status.idle_level = idle_level;
+    status.reserved = 0;
+    status.bitrate = bitrate;
+    status.free = stream.free();
+    status.queued = stream.queued();
+    status.played = stream.get_played();
+    status.underruns = stream.get_underruns();
+    status.underrun_bytes = stream.get_underrun_bytes();
+    status.dma_underruns = dma_underruns;
+}
+
+bool IRAM_ATTR PatternGenerator::on_send_queue_overflow(i2s_chan_handle_t handle, i2s_event_data_t* event, void* context) {
+    PatternGenerator* self = (PatternGenerator*)context;
+    self->dma_underruns = self->dma_underruns + 1;
+    return false;
+}
+
+void PatternGenerator::task(void* arg) {
+    PatternGenerator* self = (PatternGenerator*)arg;
+    uint8_t* input = (uint8_t*)malloc(PATTERN_BLOCK_SIZE);
+    uint8_t* output = (uint8_t*)malloc(PATTERN_BLOCK_SIZE);
+
+    while (true) {
+        self->apply_config();
+
+        if (self->channel == nullptr) {
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+            continue;
+        }
+
+        // the write blocks until one of the dma buffers is free, which paces the task to the output rate
+        size_t input_length = PATTERN_BLOCK_SIZE / self->repeat;
+        self->stream.pull(input, input_length, self->idle_level ? 0xFF : 0x00);
+        pattern_expand(input, input_length, self->repeat, output);
+
+        size_t written;
+        i2s_channel_write(self->channel, output, PATTERN_BLOCK_SIZE, &written, portMAX_DELAY);
+    }
+}
+
+void PatternGenerator::apply_config() {
+    if (config_pending == false)
+        return;
+
+    config_pending = false;
+    stream.stop();
+    delete_driver();
+
+    idle_level = pending_idle_level;
+    if (pending_bitrate != 0)
+        install_driver(pending_bitrate);
+}
+
+void PatternGenerator::install_driver(uint32_t requested_bitrate) {
+    uint32_t repeat = 1;
+    while (requested_bitrate * repeat < PATTERN_OUTPUT_RATE_MIN && repeat < PATTERN_MAX_REPEAT)
+        repeat *= 2;
+
+    uint32_t sample_rate = requested_bitrate * repeat / PATTERN_BITS_PER_FRAME;
+
+    i2s_chan_config_t channel_config = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    channel_config.dma_desc_num = 2;
+    channel_config.dma_frame_num = PATTERN_BLOCK_SIZE / 2;
+
+    if (i2s_new_channel(&channel_config, &channel, NULL) != ESP_OK) {
+        esp_rom_printf("pattern: could not create the i2s channel\n");
+        channel = nullptr;
+        return;
+    }
+
+    // msb slots without the one bit delay of the philips format, so the stream is played as it is
+    i2s_std_config_t std_config = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate),
+        .slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_8BIT, I2S_SLOT_MODE_STEREO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = clock_pin,
+            .ws = I2S_GPIO_UNUSED,
+            .dout = data_pin,
+            .din = I2S_GPIO_UNUSED,
+            .invert_flags = {
+                .mclk_inv = false,
+                .bclk_inv = false,
+                .ws_inv = false,
+            },
+        },
+    };
+    std_config.clk_cfg.mclk_multiple = I2S_MCLK_MULTIPLE_128;
+
+    i2s_event_callbacks_t callbacks = {};
+    callbacks.on_send_q_ovf = on_send_queue_overflow;
+
+    if (i2s_channel_init_std_mode(channel, &std_config) != ESP_OK ||
+        i2s_channel_register_event_callback(channel, &callbacks, this) != ESP_OK ||
+        i2s_channel_enable(channel) != ESP_OK) {
+        esp_rom_printf("pattern: could not start the i2s channel at %d bit/s\n", requested_bitrate);
+        i2s_del_channel(channel);
+        channel = nullptr;
+        return;
+    }
+
+    this->repeat = repeat;
+    bitrate = sample_rate * PATTERN_BITS_PER_FRAME / repeat;
+    dma_underruns = 0;
+    esp_rom_printf("pattern: %d bit/s, every bit repeated %d times\n", bitrate, repeat);
+}
+
+void PatternGenerator::delete_driver() {
+    if (channel == nullptr)
+        return;
+
+    i2s_channel_disable(channel);
+    i2s_del_channel(channel);
+    channel = nullptr;
+    bitrate = 0;
+
+    gpio_reset_pin(data_pin);
+    gpio_reset_pin(clock_pin);
+}
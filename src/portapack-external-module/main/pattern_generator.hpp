@@ -0,0 +1,98 @@
+#ifndef PATTERN_GENERATOR_HPP
+#define PATTERN_GENERATOR_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include "driver/gpio.h"
+#include "driver/i2s_std.h"
+
+#include "pattern_stream.hpp"
+#include "pp_protocol.hpp"
+
+#define PATTERN_BITRATE_MIN 1000
+#define PATTERN_BITRATE_MAX 8000000
+// lowest bit clock the i2s peripheral is run at, slower patterns repeat their bits
+#define PATTERN_OUTPUT_RATE_MIN 128000
+// bytes per dma buffer, two of them are played in turn
+#define PATTERN_BLOCK_SIZE 2048
+// i2c writes are limited to 128 bytes: command and data
+#define PATTERN_DATA_MAX_LENGTH 126
+
+enum class PatternState : uint8_t {
+    PATTERN_OFF = 0,  // no output, the pins are inputs
+    PATTERN_IDLE,     // the output holds the idle level
+    PATTERN_PLAYING,
+};
+
+enum class PatternControl : uint8_t {
+    CONTROL_STOP = 0,  // back to the idle level, queued data is dropped
+    CONTROL_START,     // play the queued data, more may follow
+    CONTROL_END,       // no more data follows, the generator returns to idle once the queue is empty
+};
+
+typedef struct
+{
+    PatternState state;
+    uint8_t repeat;      // times every pattern bit is repeated on the i2s bit clock
+    uint8_t idle_level;  // 0 or 1
+    uint8_t reserved;
+    uint32_t bitrate;         // actual pattern rate, 0 when off
+    uint32_t free;            // queue space in bytes
+    uint32_t queued;          // bytes waiting to be played
+    uint32_t played;          // bytes played since the start
+    uint32_t underruns;       // times the queue ran empty while playing
+    uint32_t underrun_bytes;  // idle bytes played in place of missing data
+    uint32_t dma_underruns;   // times the dma ran out because the task was late
+} pattern_status_t;
+PP_MESSAGE(pattern_status_t, PP_PATTERN_STATUS_SIZE);
+
+/*
+    Plays a bit stream (msb first) on one gpio with the i2s peripheral, the bit clock is available on a second pin.
+    The pattern is queued over i2c, the generator task feeds two dma buffers from the queue,
+    so the timing of the output does not depend on the i2c transfers.
+*/
+class PatternGenerator {
+   public:
+    PatternGenerator(gpio_num_t data_pin, gpio_num_t clock_pin);
+
+    PatternGenerator(const PatternGenerator&) = delete;
+    PatternGenerator& operator=(const PatternGenerator&) = delete;
+
+    void start_task();
+
+    // bitrate 0 turns the output off
+    void request_config(uint32_t bitrate, uint8_t idle_level);
+    void control(PatternControl control);
+    // returns the number of bytes queued, i2c irq only
+    size_t write(const uint8_t* data, size_t len);
+
+    void get_status(pattern_status_t& status) const;
+
+   private:
+    static void task(void* arg);
+    static bool on_send_queue_overflow(i2s_chan_handle_t handle, i2s_event_data_t* event, void* context);
+
+    void apply_config();
+    void install_driver(uint32_t bitrate);
+    void delete_driver();
+
+    gpio_num_t data_pin;
+    gpio_num_t clock_pin;
+
+    volatile bool config_pending{false};
+    volatile uint32_t pending_bitrate{0};
+    volatile uint8_t pending_idle_level{0};
+
+    i2s_chan_handle_t channel{nullptr};
+    volatile uint32_t bitrate{0};
+    volatile uint8_t repeat{1};
+    volatile uint8_t idle_level{0};
+
+    PatternStream stream{};
+    volatile uint32_t dma_underruns{0};
+};
+
+extern PatternGenerator pattern_generator;
+
+#endif
@@ -0,0 +1,82 @@
+#include "pattern_stream.hpp"
+
+#include <cstring>
+
+void PatternStream::pull(uint8_t* out, size_t len, uint8_t idle) {
+    if (stop_pending) {
+        stop_pending = false;
+        end_of_data = false;
+        playing = false;
+        ring.discard(ring.size());
+    }
+
+    if (start_pending) {
+        start_pending = false;
+        playing = true;
+        in_underrun = false;
+        played = 0;
+        underruns = 0;
+        underrun_bytes = 0;
+    }
+
+    size_t length = playing ? ring.pop(out, len) : 0;
+    played = played + length;
+
+    if (length > 0)
+        in_underrun = false;
+
+    if (length == len)
+        return;
+
+    memset(out + length, idle, len - length);
+
+    if (playing == false)
+        return;
+
+    if (end_of_data) {
+        end_of_data = false;
+        playing = false;
+        return;
+    }
+
+    // a run of empty pulls counts as one underrun
+    if (in_underrun == false)
+        underruns = underruns + 1;
+
+    in_underrun = true;
+    underrun_bytes = underrun_bytes + len - length;
+}
+
+void pattern_expand(const uint8_t* in, size_t len, size_t repeat, uint8_t* out) {
+    if (repeat <= 1) {
+        memcpy(out, in, len);
+        return;
+    }
+
+    // whole bytes per bit
+    if (repeat >= 8) {
+        for (size_t i = 0; i < len; i++) {
+            for (int bit = 7; bit >= 0; bit--) {
+                memset(out, (in[i] >> bit) & 1 ? 0xFF : 0x00, repeat / 8);
+                out += repeat / 8;
+            }
+        }
+        return;
+    }
+
+    uint8_t value = 0;
+    size_t bits = 0;
+    const uint8_t run = (1 << repeat) - 1;
+
+    for (size_t i = 0; i < len; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            value = (value << repeat) | ((in[i] >> bit) & 1 ? run : 0);
+            bits += repeat;
+            if (bits == 8) {
+                *out++ = value;
+                value = 0;
+                bits = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef PATTERN_STREAM_HPP
+#define PATTERN_STREAM_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include "uart_ring.hpp"
+
+#define PATTERN_RING_SIZE (32 * 1024)
+// each pattern bit is repeated up to this many times to reach the lowest rate of the output peripheral
+#define PATTERN_MAX_REPEAT 128
+
+/*
+    Queue between the pattern data written over i2c and the task feeding the output peripheral.
+    Start, end and stop are requested from the i2c irq and applied by pull(), so the ring keeps a single consumer.
+    An underrun is a pull that finds the queue empty while playing before the end of the data was announced,
+    the missing bytes are replaced by the idle level.
+*/
+class PatternStream {
+   public:
+    // returns the number of bytes queued, the rest did not fit, i2c irq only
+    size_t push(const uint8_t* data, size_t len) { return ring.push(data, len); }
+
+    void start() { start_pending = true; }
+    // no more data follows, playing stops without an underrun once the queue is empty
+    void end() { end_of_data = true; }
+    // drops the queue, data pushed before the next pull is dropped as well
+    void stop() {
+        start_pending = false;
+        stop_pending = true;
+    }
+
+    // fills out with len bytes of the pattern or of idle bytes, task only
+    void pull(uint8_t* out, size_t len, uint8_t idle);
+
+    bool is_playing() const { return playing; }
+    size_t queued() const { return ring.size(); }
+    size_t free() const { return ring.free(); }
+
+    uint32_t get_played() const { return played; }
+    uint32_t get_underruns() const { return underruns; }
+    uint32_t get_underrun_bytes() const { return underrun_bytes; }
+
+   private:
+    UartRing<PATTERN_RING_SIZE> ring{};
+
+    volatile bool start_pending{false};
+    volatile bool stop_pending{false};
+    volatile bool end_of_data{false};
+    volatile bool playing{false};
+    bool in_underrun{false};
+
+    volatile uint32_t played{0};
+    volatile uint32_t underruns{0};
+    volatile uint32_t underrun_bytes{0};
+};
+
+// repeats every bit of in (msb first) repeat times, out needs len * repeat bytes, repeat is a power of two
+void pattern_expand(const uint8_t* in, size_t len, size_t repeat, uint8_t* out);
+
+#endif
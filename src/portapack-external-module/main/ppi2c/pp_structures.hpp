@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <vector>
 
+#include "pp_protocol.hpp"
+
 #define PP_API_VERSION 1
 #define ESP_SLAVE_ADDR 0x51
 
@@ -93,14 +95,6 @@ typedef struct
     uint32_t application_count;
 } device_info;
 
-enum app_location_t : uint32_t {
-    UTILITIES = 0,
-    RX,
-    TX,
-    DEBUG,
-    HOME
-};
-
 typedef struct
 {
     uint32_t header_version;
@@ -0,0 +1,114 @@
+#include "uart_autobaud.hpp"
+
+const uint32_t uart_standard_baudrates[] = {50, 75, 110, 134, 150, 200, 300, 600,
+                                            1200, 2400, 4800, 9600, 14400, 19200,
+                                            28800, 38400, 57600, 115200, 230400,
+                                            460800, 576000, 921600, 1843200, 3686400};
+
+const size_t uart_standard_baudrate_count = sizeof(uart_standard_baudrates) / sizeof(uart_standard_baudrates[0]);
+
+// a frame has at most 10 bits of the same level (start bit and 8 zero data bits plus parity), longer pulses are idle gaps
+#define MAX_BITS_PER_PULSE 10
+// a pulse fits a bit time when it is within a quarter bit of an integer multiple
+#define FIT_TOLERANCE_DIVIDER 4
+// percent of the pulses that have to fit the bit time
+#define MIN_FIT_PERCENT 90
+// percent a measured rate may differ from a standard rate to be snapped to it
+#define SNAP_TOLERANCE_PERCENT 3
+
+static void sort(uint32_t* values, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        uint32_t value = values[i];
+        size_t j = i;
+        for (; j > 0 && values[j - 1] > value; j--)
+            values[j] = values[j - 1];
+        values[j] = value;
+    }
+}
+
+// returns the summed width and bit count of all pulses fitting the bit time, or false if too few fit
+static bool fit_bit_time(const uint32_t* sorted, size_t count, uint32_t bit_time, uint64_t& width_sum, uint32_t& bit_sum) {
+    size_t fits = 0;
+    size_t considered = 0;
+    width_sum = 0;
+    bit_sum = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits = (sorted[i] + bit_time / 2) / bit_time;
+        if (bits > MAX_BITS_PER_PULSE)
+            break;
+
+        considered++;
+        uint32_t expected = bits * bit_time;
+        uint32_t error = sorted[i] > expected ? sorted[i] - expected : expected - sorted[i];
+
+        if (bits > 0 && error <= bit_time / FIT_TOLERANCE_DIVIDER) {
+            fits++;
+            width_sum += sorted[i];
+            bit_sum += bits;
+        }
+    }
+
+    return considered >= UART_AUTOBAUD_MIN_PULSES && fits * 100 >= considered * MIN_FIT_PERCENT;
+}
+
+uint32_t uart_autobaud_classify(const uint32_t* widths, size_t count, uint32_t ticks_per_second) {
+    if (count < UART_AUTOBAUD_MIN_PULSES)
+        return 0;
+
+    if (count > UART_AUTOBAUD_MAX_PULSES)
+        count = UART_AUTOBAUD_MAX_PULSES;
+
+    uint32_t sorted[UART_AUTOBAUD_MAX_PULSES];
+    for (size_t i = 0; i < count; i++)
+        sorted[i] = widths[i];
+    sort(sorted, count);
+
+    // the shortest pulses may be glitches, so try the next ones as well
+    for (size_t candidate = 0; candidate < count / 4; candidate++) {
+        uint32_t bit_time = sorted[candidate];
+        if (bit_time == 0)
+            continue;
+
+        uint64_t width_sum;
+        uint32_t bit_sum;
+        if (fit_bit_time(sorted + candidate, count - candidate, bit_time, width_sum, bit_sum) == false || bit_sum == 0)
+            continue;
+
+        // refine with the average bit time, the shortest pulse alone is off by the edge jitter
+        bit_time = (uint32_t)(width_sum / bit_sum);
+        if (fit_bit_time(sorted + candidate, count - candidate, bit_time, width_sum, bit_sum) == false)
+            continue;
+
+        uint32_t measured = (uint32_t)(((uint64_t)ticks_per_second * bit_sum + width_sum / 2) / width_sum);
+
+        for (size_t i = 0; i < uart_standard_baudrate_count; i++) {
+            uint32_t standard = uart_standard_baudrates[i];
+            uint32_t difference = measured > standard ? measured - standard : standard - measured;
+            if ((uint64_t)difference * 100 <= (uint64_t)standard * SNAP_TOLERANCE_PERCENT)
+                return standard;
+        }
+
+        return measured;
+    }
+
+    return 0;
+}
+
+uint32_t uart_baudrate_next(uint32_t baudrate) {
+    for (size_t i = 0; i < uart_standard_baudrate_count; i++) {
+        if (uart_standard_baudrates[i] > baudrate)
+            return uart_standard_baudrates[i];
+    }
+
+    return uart_standard_baudrates[0];
+}
+
+uint32_t uart_baudrate_previous(uint32_t baudrate) {
+    for (size_t i = uart_standard_baudrate_count; i > 0; i--) {
+        if (uart_standard_baudrates[i - 1] < baudrate)
+            return uart_standard_baudrates[i - 1];
+    }
+
+    return uart_standard_baudrates[uart_standard_baudrate_count - 1];
+}
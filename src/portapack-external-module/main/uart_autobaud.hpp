@@ -0,0 +1,24 @@
+#ifndef UART_AUTOBAUD_HPP
+#define UART_AUTOBAUD_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#define UART_AUTOBAUD_MAX_PULSES 128
+#define UART_AUTOBAUD_MIN_PULSES 16
+
+extern const uint32_t uart_standard_baudrates[];
+extern const size_t uart_standard_baudrate_count;
+
+/*
+    Estimates the baud rate from measured pulse widths (time between two edges on the rx pin).
+    The shortest pulse that most other pulses are an integer multiple of is taken as the bit time.
+    Snaps to a standard rate within 3%, otherwise the measured rate is returned. Returns 0 if undetermined.
+*/
+uint32_t uart_autobaud_classify(const uint32_t* widths, size_t count, uint32_t ticks_per_second);
+
+// nearest standard rate above / below baudrate, wrapping around at the ends of the table
+uint32_t uart_baudrate_next(uint32_t baudrate);
+uint32_t uart_baudrate_previous(uint32_t baudrate);
+
+#endif
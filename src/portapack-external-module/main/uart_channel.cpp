@@ -0,0 +1,462 @@
+#include "uart_channel.hpp"
+
+#include <cstdlib>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+UartChannel::UartChannel(uart_port_t port, gpio_num_t rx_pin, gpio_num_t tx_pin, gpio_num_t rts_pin, bool enabled, uint32_t baudrate)
+    : port(port),
+      rx_pin(rx_pin),
+      tx_pin(tx_pin),
+      rts_pin(rts_pin),
+      enabled(enabled),
+      baudrate(baudrate),
+      filter(on_filter_output, this),
+      framer(on_framer_output, this) {
+}
+
+void UartChannel::start_task(const char* name) {
+    xTaskCreate(task, name, 1024 * 3, this, 10, NULL);
+}
+
+void UartChannel::request_enabled(bool enabled) {
+    this->enabled = enabled;
+}
+
+void UartChannel::request_baudrate(uint32_t baudrate) {
+    this->baudrate = baudrate;
+}
+
+void UartChannel::request_filter(const uart_filter_config_t& config) {
+    if (filter_pending)
+        return;
+
+    pending_filter = config;
+    filter_pending = true;
+}
+
+void UartChannel::request_autobaud() {
+    if (autobaud_state == UartAutobaudState::AUTOBAUD_RUNNING)
+        return;
+
+    autobaud_state = UartAutobaudState::AUTOBAUD_RUNNING;
+    autobaud_pending = true;
+}
+
+void UartChannel::request_flow_control(UartFlowControl flow_control, UartDropPolicy drop_policy, uint8_t high_water, uint8_t low_water) {
+    if (high_water > 100)
+        high_water = 100;
+
+    if (low_water >= high_water)
+        low_water = high_water / 2;
+
+    this->drop_policy = drop_policy;
+    this->high_water = high_water;
+    this->low_water = low_water;
+    this->flow_control = flow_control;
+    flow_control_pending = true;
+}
+
+void UartChannel::request_framing(const uart_framing_config_t& config) {
+    if (framing_pending)
+        return;
+
+    pending_framing = config;
+    framing_pending = true;
+}
+
+void UartChannel::get_status(uart_channel_status_t& status) const {
+    status = {};
+    status.enabled = enabled ? 1 : 0;
+    status.autobaud_state = autobaud_state;
+    status.flow_control = flow_control;
+    status.drop_policy = drop_policy;
+    status.baudrate = baudrate;
+    status.rx_bytes = rx_bytes;
+    status.dropped_bytes = dropped_bytes;
+    status.high_water = high_water;
+    status.low_water = low_water;
+    status.frame_mode = framer.get_mode();
+    status.ring_fill = ring.size();
+    status.tx_bytes = tx_bytes;
+    status.tx_pending = tx_ring.size();
+}
+
+size_t UartChannel::write(const uint8_t* data, size_t len) {
+    if (!enabled)
+        return 0;
+
+    size_t written = tx_ring.push(data, len);
+    if (written > 0)
+        tx_idle = false;
+
+    return written;
+}
+
+size_t UartChannel::read(uint8_t* data, size_t len) {
+    portENTER_CRITICAL_ISR(&ring_lock);
+    size_t read = ring.pop(data, len);
+    portEXIT_CRITICAL_ISR(&ring_lock);
+
+    return read;
+}
+
+bool UartChannel::take_overflowed() {
+    bool was_overflowed = overflowed;
+    overflowed = false;
+    return was_overflowed;
+}
+
+size_t UartChannel::drain(uint8_t tag, uint8_t* out, size_t len) {
+    size_t written = 0;
+    portENTER_CRITICAL_ISR(&ring_lock);
+
+    if (!framed) {
+        size_t chunk = len - 1;
+        if (chunk > UART_CHUNK_MAX_LENGTH)
+            chunk = UART_CHUNK_MAX_LENGTH;
+
+        size_t read = ring.pop(out + 1, chunk);
+        if (read > 0) {
+            out[0] = tag | read;
+            written = 1 + read;
+        }
+    } else {
+        // a frame waits for the next response if it does not fit this one
+        uint8_t frame_length;
+        if (len >= 2 && ring.peek(frame_length) && (size_t)frame_length + 2 <= len) {
+            out[0] = tag;
+            ring.pop(out + 1, 1 + frame_length);
+            written = 2 + frame_length;
+        }
+    }
+
+    portEXIT_CRITICAL_ISR(&ring_lock);
+    return written;
+}
+
+void UartChannel::on_filter_output(void* context, const uint8_t* data, size_t len) {
+    UartChannel* channel = (UartChannel*)context;
+
+    if (channel->framer.is_enabled())
+        channel->framer.push(data, len, esp_timer_get_time() / 1000);
+    else
+        channel->store(data, len);
+}
+
+void UartChannel::on_framer_output(void* context, const uint8_t* record, size_t len) {
+    ((UartChannel*)context)->store_frame(record, len);
+}
+
+void UartChannel::store(const uint8_t* data, size_t len) {
+    size_t dropped = 0;
+
+    if (drop_policy == UartDropPolicy::DROP_OLDEST && len > ring.free()) {
+        // only the newest capacity bytes can be kept at all
+        if (len > ring.capacity()) {
+            dropped += len - ring.capacity();
+            data += len - ring.capacity();
+            len = ring.capacity();
+        }
+
+        portENTER_CRITICAL(&ring_lock);
+        size_t free = ring.free();
+        if (len > free)
+            dropped += ring.discard(len - free);
+        portEXIT_CRITICAL(&ring_lock);
+    }
+
+    size_t stored = ring.push(data, len);
+    dropped += len - stored;
+
+    if (dropped > 0) {
+        dropped_bytes = dropped_bytes + dropped;
+        overflowed = true;
+    }
+}
+
+// frames are stored or dropped whole, a single push makes the record visible to the drain at once
+void UartChannel::store_frame(const uint8_t* record, size_t len) {
+    size_t dropped = 0;
+
+    if (len > ring.free()) {
+        if (drop_policy == UartDropPolicy::DROP_OLDEST) {
+            portENTER_CRITICAL(&ring_lock);
+            uint8_t frame_length;
+            while (len > ring.free() && ring.peek(frame_length))
+                dropped += ring.discard(1 + frame_length) - 1;
+            portEXIT_CRITICAL(&ring_lock);
+        } else {
+            dropped = len - 1;
+            len = 0;
+        }
+    }
+
+    if (len > 0)
+        ring.push(record, len);
+
+    if (dropped > 0) {
+        dropped_bytes = dropped_bytes + dropped;
+        overflowed = true;
+    }
+}
+
+void UartChannel::install_driver() {
+    uart_config_t uart_config = {
+        .baud_rate = (int)baudrate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = flow_control == UartFlowControl::FLOW_RTS ? UART_HW_FLOWCTRL_RTS : UART_HW_FLOWCTRL_DISABLE,
+        .rx_flow_ctrl_thresh = UART_RTS_FIFO_THRESHOLD,
+        .source_clk = UART_SCLK_DEFAULT,
+        .flags = {.backup_before_sleep = 0}};
+
+    int intr_alloc_flags = 0;
+
+#if CONFIG_UART_ISR_IN_IRAM
+    intr_alloc_flags = ESP_INTR_FLAG_IRAM;
+#endif
+
+    ESP_ERROR_CHECK(uart_driver_install(port, UART_DRIVER_BUF_SIZE * 2, UART_DRIVER_BUF_SIZE * 2, 0, NULL, intr_alloc_flags));
+    ESP_ERROR_CHECK(uart_param_config(port, &uart_config));
+    ESP_ERROR_CHECK(uart_set_pin(port, tx_pin, rx_pin, rts_pin, UART_PIN_NO_CHANGE));
+
+    driver_installed = true;
+    driver_baudrate = uart_config.baud_rate;
+    driver_flow_control = flow_control;
+    esp_rom_printf("uart %d: started at %d baud\n", port, driver_baudrate);
+}
+
+void UartChannel::delete_driver() {
+    ESP_ERROR_CHECK(uart_driver_delete(port));
+    driver_installed = false;
+
+    // nothing is sent while disabled
+    tx_ring.discard(tx_ring.size());
+    tx_idle = true;
+}
+
+void UartChannel::apply_flow_control() {
+    UartFlowControl want_flow_control = flow_control;
+    flow_control_pending = false;
+
+    if (want_flow_control != UartFlowControl::FLOW_RTS)
+        holding = false;
+
+    if (!driver_installed || want_flow_control == driver_flow_control)
+        return;
+
+    uart_hw_flowcontrol_t mode = want_flow_control == UartFlowControl::FLOW_RTS ? UART_HW_FLOWCTRL_RTS : UART_HW_FLOWCTRL_DISABLE;
+    ESP_ERROR_CHECK(uart_set_hw_flow_ctrl(port, mode, UART_RTS_FIFO_THRESHOLD));
+
+    driver_flow_control = want_flow_control;
+    esp_rom_printf("uart %d: flow control %s\n", port, want_flow_control == UartFlowControl::FLOW_RTS ? "rts" : "off");
+}
+
+// true while reading has to pause so the driver buffer and then the uart fifo fill up and RTS stops the sender
+bool UartChannel::check_backpressure() {
+    if (flow_control != UartFlowControl::FLOW_RTS)
+        return false;
+
+    size_t fill_percent = ring.size() * 100 / ring.capacity();
+
+    if (holding && fill_percent < low_water)
+        holding = false;
+    else if (!holding && fill_percent >= high_water)
+        holding = true;
+
+    return holding;
+}
+
+// hands queued bytes to the driver, which buffers them and keeps the tx fifo filled from its interrupt
+void UartChannel::transmit(uint8_t* buffer) {
+    size_t len = tx_ring.pop(buffer, UART_DRIVER_BUF_SIZE);
+
+    if (len > 0) {
+        tx_idle = false;
+        uart_write_bytes(port, buffer, len);
+        tx_bytes = tx_bytes + len;
+        return;
+    }
+
+    if (!tx_idle && tx_ring.size() == 0 && uart_wait_tx_done(port, 0) == ESP_OK)
+        tx_idle = true;
+}
+
+// the ring holds either bytes or frame records, so it starts empty in the new mode
+void UartChannel::apply_framing() {
+    framer.configure(pending_framing);
+
+    portENTER_CRITICAL(&ring_lock);
+    ring.clear();
+    framed = framer.is_enabled();
+    portEXIT_CRITICAL(&ring_lock);
+}
+
+void UartChannel::apply_requests() {
+    if (filter_pending) {
+        filter.configure(pending_filter);
+        filter_pending = false;
+    }
+
+    if (framing_pending) {
+        apply_framing();
+        framing_pending = false;
+    }
+
+    if (autobaud_pending) {
+        run_autobaud();
+        autobaud_pending = false;
+    }
+
+    bool want_enabled = enabled;
+    if (driver_installed && !want_enabled)
+        delete_driver();
+
+    if (!driver_installed && want_enabled)
+        install_driver();
+
+    if (flow_control_pending)
+        apply_flow_control();
+
+    // a running driver can switch the rate without being reinstalled
+    uint32_t want_baudrate = baudrate;
+    if (driver_installed && want_baudrate != driver_baudrate) {
+        ESP_ERROR_CHECK(uart_set_baudrate(port, want_baudrate));
+        driver_baudrate = want_baudrate;
+        esp_rom_printf("uart %d: switched to %d baud\n", port, driver_baudrate);
+    }
+}
+
+void IRAM_ATTR UartChannel::on_rx_edge(void* arg) {
+    UartChannel* channel = (UartChannel*)arg;
+    uint32_t now = esp_cpu_get_cycle_count();
+
+    if (channel->last_edge != 0 && channel->pulse_count < UART_AUTOBAUD_MAX_PULSES) {
+        channel->pulses[channel->pulse_count] = now - channel->last_edge;
+        channel->pulse_count = channel->pulse_count + 1;
+    }
+
+    channel->last_edge = now;
+}
+
+void UartChannel::run_autobaud() {
+    pulse_count = 0;
+    last_edge = 0;
+
+    // the edge interrupt shares the pin with the uart rx input, so capture keeps running meanwhile
+    gpio_set_direction(rx_pin, GPIO_MODE_INPUT);
+    gpio_set_intr_type(rx_pin, GPIO_INTR_ANYEDGE);
+    gpio_isr_handler_add(rx_pin, on_rx_edge, this);
+
+    for (int waited = 0; waited < UART_AUTOBAUD_TIMEOUT_MS && pulse_count < UART_AUTOBAUD_MAX_PULSES; waited += 10)
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+
+    gpio_isr_handler_remove(rx_pin);
+    gpio_set_intr_type(rx_pin, GPIO_INTR_DISABLE);
+
+    uint32_t detected = uart_autobaud_classify(pulses, pulse_count, esp_rom_get_cpu_ticks_per_us() * 1000000);
+    esp_rom_printf("uart %d: autobaud measured %d pulses, detected %d baud\n", port, pulse_count, detected);
+
+    if (detected == 0) {
+        autobaud_state = UartAutobaudState::AUTOBAUD_FAILED;
+        return;
+    }
+
+    baudrate = detected;
+    autobaud_state = UartAutobaudState::AUTOBAUD_DONE;
+
+    // whatever arrived at the old rate is garbage
+    if (driver_installed)
+        uart_flush_input(port);
+}
+
+void UartChannel::task(void* arg) {
+    UartChannel* channel = (UartChannel*)arg;
+    uint8_t* data = (uint8_t*)malloc(UART_DRIVER_BUF_SIZE);
+
+    while (true) {
+        channel->apply_requests();
+
+        if (!channel->driver_installed) {
+            vTaskDelay(20 / portTICK_PERIOD_MS);
+            continue;
+        }
+
+        channel->transmit(data);
+
+        // wake up early while transmitting so the driver never runs dry, and to notice idle gaps between frames
+        TickType_t wait = channel->tx_idle && !channel->framer.has_idle_gap() ? 20 / portTICK_PERIOD_MS : 1;
+
+        if (channel->check_backpressure()) {
+            vTaskDelay(wait);
+            continue;
+        }
+
+        int len = uart_read_bytes(channel->port, data, UART_DRIVER_BUF_SIZE, wait);
+        if (len > 0) {
+            channel->rx_bytes = channel->rx_bytes + len;
+            channel->filter.push(data, len);
+        } else if (channel->framer.has_idle_gap()) {
+            channel->framer.poll(esp_timer_get_time() / 1000);
+        }
+    }
+}
+
+size_t uart_channels_drain(uint8_t* out, size_t len, bool& more_data) {
+    static uint8_t next_channel = 0;
+
+    size_t pos = 0;
+    bool progress = true;
+
+    while (progress && pos + 1 < len) {
+        progress = false;
+
+        for (uint8_t i = 0; i < UART_CHANNEL_COUNT && pos + 1 < len; i++) {
+            uint8_t channel = (next_channel + i) % UART_CHANNEL_COUNT;
+
+            size_t written = uart_channels[channel].drain(channel << 6, out + pos, len - pos);
+            if (written == 0)
+                continue;
+
+            pos += written;
+            progress = true;
+        }
+
+        next_channel = (next_channel + 1) % UART_CHANNEL_COUNT;
+    }
+
+    more_data = false;
+    for (uint8_t i = 0; i < UART_CHANNEL_COUNT; i++)
+        more_data = more_data || uart_channels[i].available() > 0;
+
+    return pos;
+}
+
+void uart_channels_drain_status(uart_drain_status_t& status) {
+    status = {};
+    status.time_us = (uint32_t)esp_timer_get_time();
+
+    for (uint8_t i = 0; i < UART_CHANNEL_COUNT; i++) {
+        status.fill[i] = uart_channels[i].get_fill();
+        status.dropped[i] = (uint16_t)uart_channels[i].get_dropped();
+
+        if (uart_channels[i].is_holding())
+            status.holding |= 1 << i;
+
+        if (uart_channels[i].take_overflowed())
+            status.overflowed |= 1 << i;
+
+        if (uart_channels[i].is_tx_idle())
+            status.tx_idle |= 1 << i;
+
+        status.tx_free[i] = uart_channels[i].get_tx_free();
+    }
+}
@@ -0,0 +1,190 @@
+#ifndef UART_CHANNEL_HPP
+#define UART_CHANNEL_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+
+#include "uart_autobaud.hpp"
+#include "uart_filter.hpp"
+#include "uart_framer.hpp"
+#include "uart_ring.hpp"
+#include "pp_protocol.hpp"
+
+#define UART_CHANNEL_COUNT 3
+#define UART_RING_SIZE (16 * 1024)
+#define UART_DRIVER_BUF_SIZE (1024)
+#define UART_TX_RING_SIZE (4 * 1024)
+// tx space is reported in units of this many bytes so it fits a byte
+#define UART_TX_FREE_UNIT 32
+// i2c writes are limited to 128 bytes: command, channel and data
+#define UART_TX_FRAME_MAX_LENGTH 125
+#define UART_AUTOBAUD_TIMEOUT_MS 3000
+
+enum class UartAutobaudState : uint8_t {
+    AUTOBAUD_IDLE = 0,
+    AUTOBAUD_RUNNING,
+    AUTOBAUD_DONE,
+    AUTOBAUD_FAILED
+};
+
+enum class UartFlowControl : uint8_t {
+    FLOW_NONE = 0,  // the drop policy decides what is lost when the ring is full
+    FLOW_RTS,       // reading pauses above the high water mark, the uart deasserts RTS once its fifo fills
+};
+
+enum class UartDropPolicy : uint8_t {
+    DROP_NEWEST = 0,  // keep what is in the ring, lose incoming data
+    DROP_OLDEST,      // make room by discarding the oldest data in the ring
+};
+
+#define UART_HIGH_WATER_DEFAULT 75
+#define UART_LOW_WATER_DEFAULT 50
+// fifo level at which the uart deasserts RTS
+#define UART_RTS_FIFO_THRESHOLD 100
+
+// drain chunk header: 2 bit channel, 6 bit length
+// length 0 marks a frame: the next byte is the frame length, followed by the whole frame
+#define UART_CHUNK_MAX_LENGTH 63
+
+typedef struct
+{
+    uint8_t enabled;
+    UartAutobaudState autobaud_state;
+    UartFlowControl flow_control;
+    UartDropPolicy drop_policy;
+    uint32_t baudrate;
+    uint32_t rx_bytes;       // bytes received from the uart driver
+    uint32_t dropped_bytes;  // bytes lost because the ring was full
+    uint8_t high_water;      // percent of the ring
+    uint8_t low_water;       // percent of the ring
+    UartFrameMode frame_mode;
+    uint8_t reserved;
+    uint32_t ring_fill;   // bytes waiting to be drained
+    uint32_t tx_bytes;    // bytes handed to the uart driver
+    uint32_t tx_pending;  // bytes waiting in the tx ring
+} uart_channel_status_t;
+PP_MESSAGE(uart_channel_status_t, PP_UART_CHANNEL_STATUS_SIZE);
+
+// sent in front of the chunk stream of every multiplexed drain response
+typedef struct __attribute__((packed))
+{
+    uint8_t fill[UART_CHANNEL_COUNT];      // ring fill level, 255 is full
+    uint8_t holding;                       // bit per channel: flow control paused reading
+    uint8_t overflowed;                    // bit per channel: data was dropped since the previous drain
+    uint8_t tx_idle;                       // bit per channel: everything queued for transmit has left the uart
+    uint8_t tx_free[UART_CHANNEL_COUNT];   // tx ring space in UART_TX_FREE_UNIT bytes
+    uint16_t dropped[UART_CHANNEL_COUNT];  // low 16 bit of the dropped byte counter
+    uint32_t time_us;                      // module time of the response, wraps after 71 minutes
+} uart_drain_status_t;
+
+/*
+    One uart controller with its own task, filter and capture ring.
+    Driver changes are requested from the i2c irq and applied by the channel task.
+*/
+class UartChannel {
+   public:
+    UartChannel(uart_port_t port, gpio_num_t rx_pin, gpio_num_t tx_pin, gpio_num_t rts_pin, bool enabled, uint32_t baudrate);
+
+    UartChannel(const UartChannel&) = delete;
+    UartChannel& operator=(const UartChannel&) = delete;
+
+    void start_task(const char* name);
+
+    void request_enabled(bool enabled);
+    void request_baudrate(uint32_t baudrate);
+    void request_filter(const uart_filter_config_t& config);
+    void request_autobaud();
+    void request_flow_control(UartFlowControl flow_control, UartDropPolicy drop_policy, uint8_t high_water, uint8_t low_water);
+    void request_framing(const uart_framing_config_t& config);
+
+    bool is_enabled() const { return enabled; }
+    uint32_t get_baudrate() const { return baudrate; }
+    void get_status(uart_channel_status_t& status) const;
+
+    size_t available() const { return ring.size(); }
+    size_t read(uint8_t* data, size_t len);  // i2c irq only
+    // writes one drain chunk with the given channel tag, returns its size or 0, i2c irq only
+    size_t drain(uint8_t tag, uint8_t* out, size_t len);
+
+    uint8_t get_fill() const { return ring.size() * 255 / ring.capacity(); }
+    bool is_holding() const { return holding; }
+    bool take_overflowed();
+    uint32_t get_dropped() const { return dropped_bytes; }
+
+    size_t write(const uint8_t* data, size_t len);  // i2c irq only
+    uint8_t get_tx_free() const { return tx_ring.free() / UART_TX_FREE_UNIT; }
+    bool is_tx_idle() const { return tx_idle; }
+
+   private:
+    static void task(void* arg);
+    static void on_filter_output(void* context, const uint8_t* data, size_t len);
+    static void on_framer_output(void* context, const uint8_t* record, size_t len);
+    static void on_rx_edge(void* arg);
+
+    void apply_requests();
+    void run_autobaud();
+    void install_driver();
+    void delete_driver();
+    void apply_flow_control();
+    void apply_framing();
+    void store(const uint8_t* data, size_t len);
+    void store_frame(const uint8_t* record, size_t len);
+    bool check_backpressure();
+    void transmit(uint8_t* buffer);
+
+    uart_port_t port;
+    gpio_num_t rx_pin;
+    gpio_num_t tx_pin;
+    gpio_num_t rts_pin;
+
+    volatile bool enabled;
+    volatile uint32_t baudrate;
+
+    bool driver_installed{false};
+    uint32_t driver_baudrate{0};
+
+    volatile bool filter_pending{false};
+    uart_filter_config_t pending_filter{};
+    UartFilter filter;
+
+    volatile bool framing_pending{false};
+    uart_framing_config_t pending_framing{};
+    UartFramer framer;
+    volatile bool framed{false};  // the ring holds frame records: length byte and frame
+
+    UartRing<UART_RING_SIZE> ring{};
+    portMUX_TYPE ring_lock = portMUX_INITIALIZER_UNLOCKED;  // DROP_OLDEST and framing changes touch the ring from the producer side
+
+    volatile UartFlowControl flow_control{UartFlowControl::FLOW_NONE};
+    volatile UartDropPolicy drop_policy{UartDropPolicy::DROP_NEWEST};
+    volatile uint8_t high_water{UART_HIGH_WATER_DEFAULT};
+    volatile uint8_t low_water{UART_LOW_WATER_DEFAULT};
+    volatile bool flow_control_pending{false};
+    UartFlowControl driver_flow_control{UartFlowControl::FLOW_NONE};
+    volatile bool holding{false};
+    volatile bool overflowed{false};
+
+    UartRing<UART_TX_RING_SIZE> tx_ring{};
+    volatile bool tx_idle{true};
+    volatile uint32_t tx_bytes{0};
+
+    volatile bool autobaud_pending{false};
+    volatile UartAutobaudState autobaud_state{UartAutobaudState::AUTOBAUD_IDLE};
+    uint32_t pulses[UART_AUTOBAUD_MAX_PULSES]{};
+    volatile size_t pulse_count{0};
+    volatile uint32_t last_edge{0};
+
+    volatile uint32_t rx_bytes{0};
+    volatile uint32_t dropped_bytes{0};
+};
+
+extern UartChannel uart_channels[UART_CHANNEL_COUNT];
+
+// fills out with channel tagged chunks from all channels in round robin, returns the bytes written
+size_t uart_channels_drain(uint8_t* out, size_t len, bool& more_data);
+void uart_channels_drain_status(uart_drain_status_t& status);
+
+#endif
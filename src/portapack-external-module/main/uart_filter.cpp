@@ -0,0 +1,159 @@
+#include "uart_filter.hpp"
+#include <cstring>
+
+UartFilter::UartFilter(uart_filter_output_fn output, void* output_context)
+    : output_fn(output),
+      output_context(output_context) {
+    config.mode = UartFilterMode::FILTER_OFF;
+}
+
+bool UartFilter::parse_config(const uint8_t* data, size_t len, uart_filter_config_t& config) {
+    if (len < 3)
+        return false;
+
+    std::memset(&config, 0, sizeof(config));
+
+    if (data[0] > (uint8_t)UartFilterMode::FILTER_TRIGGER)
+        return false;
+
+    config.mode = (UartFilterMode)data[0];
+    config.context_lines = data[1] > UART_FILTER_MAX_CONTEXT ? UART_FILTER_MAX_CONTEXT : data[1];
+    config.rule_count = data[2];
+
+    if (config.rule_count > UART_FILTER_MAX_RULES)
+        return false;
+
+    size_t offset = 3;
+    for (uint8_t i = 0; i < config.rule_count; i++) {
+        if (offset + 2 > len)
+            return false;
+
+        uart_filter_rule_t& rule = config.rules[i];
+        if (data[offset] > (uint8_t)UartFilterRuleType::RULE_SUBSTRING)
+            return false;
+
+        rule.type = (UartFilterRuleType)data[offset];
+        rule.length = data[offset + 1];
+        offset += 2;
+
+        if (rule.length == 0 || rule.length > UART_FILTER_MAX_PATTERN || offset + rule.length > len)
+            return false;
+
+        std::memcpy(rule.pattern, data + offset, rule.length);
+        offset += rule.length;
+    }
+
+    return true;
+}
+
+void UartFilter::configure(const uart_filter_config_t& new_config) {
+    config = new_config;
+    line_length = 0;
+    context_head = 0;
+    context_count = 0;
+    triggered = false;
+}
+
+void UartFilter::push(const uint8_t* data, size_t len) {
+    if (config.mode == UartFilterMode::FILTER_OFF || (config.mode == UartFilterMode::FILTER_TRIGGER && triggered)) {
+        output(data, len);
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        line[line_length++] = data[i];
+
+        // an overlong line is evaluated as if it was terminated
+        if (data[i] == '\n' || line_length == UART_FILTER_MAX_LINE) {
+            on_line(line, line_length);
+            line_length = 0;
+
+            if (triggered) {
+                // the rest of the chunk no longer needs to be looked at
+                if (i + 1 < len)
+                    output(data + i + 1, len - i - 1);
+                return;
+            }
+        }
+    }
+}
+
+bool UartFilter::matches(const uint8_t* line, size_t len) const {
+    for (uint8_t r = 0; r < config.rule_count; r++) {
+        const uart_filter_rule_t& rule = config.rules[r];
+
+        if (rule.length > len)
+            continue;
+
+        if (rule.type == UartFilterRuleType::RULE_PREFIX) {
+            if (std::memcmp(line, rule.pattern, rule.length) == 0)
+                return true;
+        } else {
+            const uint8_t* end = line + len - rule.length;
+            for (const uint8_t* p = line; p <= end; p++) {
+                p = (const uint8_t*)std::memchr(p, rule.pattern[0], end - p + 1);
+                if (p == nullptr)
+                    break;
+
+                if (std::memcmp(p, rule.pattern, rule.length) == 0)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void UartFilter::on_line(const uint8_t* line, size_t len) {
+    bool match = matches(line, len);
+
+    switch (config.mode) {
+        case UartFilterMode::FILTER_INCLUDE:
+            if (match)
+                output(line, len);
+            break;
+
+        case UartFilterMode::FILTER_EXCLUDE:
+            if (!match)
+                output(line, len);
+            break;
+
+        case UartFilterMode::FILTER_TRIGGER:
+            if (match) {
+                flush_context();
+                output(line, len);
+                triggered = true;
+            } else {
+                store_context(line, len);
+            }
+            break;
+
+        default:
+            output(line, len);
+            break;
+    }
+}
+
+void UartFilter::store_context(const uint8_t* line, size_t len) {
+    if (config.context_lines == 0)
+        return;
+
+    size_t slot = (context_head + context_count) % config.context_lines;
+    std::memcpy(context[slot], line, len);
+    context_length[slot] = len;
+
+    if (context_count < config.context_lines)
+        context_count++;
+    else
+        context_head = (context_head + 1) % config.context_lines;
+}
+
+void UartFilter::flush_context() {
+    for (size_t i = 0; i < context_count; i++) {
+        size_t slot = (context_head + i) % config.context_lines;
+        output(context[slot], context_length[slot]);
+    }
+
+    context_head = 0;
+    context_count = 0;
+}
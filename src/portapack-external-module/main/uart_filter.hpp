@@ -0,0 +1,80 @@
+#ifndef UART_FILTER_HPP
+#define UART_FILTER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#define UART_FILTER_MAX_RULES 4
+#define UART_FILTER_MAX_PATTERN 24
+#define UART_FILTER_MAX_LINE 256
+#define UART_FILTER_MAX_CONTEXT 8
+
+enum class UartFilterMode : uint8_t {
+    FILTER_OFF = 0,      // every byte is passed through
+    FILTER_INCLUDE = 1,  // only lines matching any rule are passed
+    FILTER_EXCLUDE = 2,  // only lines matching no rule are passed
+    FILTER_TRIGGER = 3,  // nothing is passed until a line matches, then the context lines and everything after it
+};
+
+enum class UartFilterRuleType : uint8_t {
+    RULE_PREFIX = 0,     // line starts with pattern
+    RULE_SUBSTRING = 1,  // pattern appears anywhere in the line
+};
+
+typedef struct
+{
+    UartFilterRuleType type;
+    uint8_t length;
+    uint8_t pattern[UART_FILTER_MAX_PATTERN];
+} uart_filter_rule_t;
+
+typedef struct
+{
+    UartFilterMode mode;
+    uint8_t context_lines;  // lines kept before the trigger, only used in FILTER_TRIGGER
+    uint8_t rule_count;
+    uart_filter_rule_t rules[UART_FILTER_MAX_RULES];
+} uart_filter_config_t;
+
+typedef void (*uart_filter_output_fn)(void* context, const uint8_t* data, size_t len);
+
+/*
+    Line based filter sitting between the uart driver and the i2c drain queue.
+    Not thread safe: configure() and push() must be called from the same task.
+*/
+class UartFilter {
+   public:
+    UartFilter(uart_filter_output_fn output, void* output_context);
+
+    // wire format: mode, context_lines, rule_count, then rule_count times: type, length, pattern bytes
+    static bool parse_config(const uint8_t* data, size_t len, uart_filter_config_t& config);
+
+    void configure(const uart_filter_config_t& config);
+    void push(const uint8_t* data, size_t len);
+
+    bool is_triggered() const { return triggered; }
+
+   private:
+    bool matches(const uint8_t* line, size_t len) const;
+    void on_line(const uint8_t* line, size_t len);
+    void store_context(const uint8_t* line, size_t len);
+    void flush_context();
+
+    void output(const uint8_t* data, size_t len) { output_fn(output_context, data, len); }
+
+    uart_filter_output_fn output_fn;
+    void* output_context;
+    uart_filter_config_t config{};
+
+    uint8_t line[UART_FILTER_MAX_LINE]{};
+    size_t line_length{0};
+
+    uint8_t context[UART_FILTER_MAX_CONTEXT][UART_FILTER_MAX_LINE]{};
+    size_t context_length[UART_FILTER_MAX_CONTEXT]{};
+    size_t context_head{0};
+    size_t context_count{0};
+
+    bool triggered{false};
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "uart_framer.hpp"
+#include <cstring>
+
+UartFramer::UartFramer(uart_framer_output_fn output, void* output_context)
+    : output_fn(output),
+      output_context(output_context) {
+    config.mode = UartFrameMode::FRAME_OFF;
+}
+
+bool UartFramer::parse_config(const uint8_t* data, size_t len, uart_framing_config_t& config) {
+    if (len != 12)
+        return false;
+
+    std::memset(&config, 0, sizeof(config));
+
+    if (data[0] > (uint8_t)UartFrameMode::FRAME_LENGTH)
+        return false;
+
+    config.mode = (UartFrameMode)data[0];
+    config.max_length = data[1];
+    config.idle_gap_ms = data[2];
+    config.flags = data[3];
+    config.delimiter_length = data[4];
+    std::memcpy(config.delimiter, data + 5, UART_FRAME_MAX_DELIMITER);
+    config.length_offset = data[9];
+    config.length_size = data[10];
+    config.length_adjust = (int8_t)data[11];
+
+    if (config.max_length == 0 || config.max_length > UART_FRAME_MAX_LENGTH)
+        return false;
+
+    if (config.mode == UartFrameMode::FRAME_DELIMITER && (config.delimiter_length == 0 || config.delimiter_length > UART_FRAME_MAX_DELIMITER))
+        return false;
+
+    if (config.mode == UartFrameMode::FRAME_LENGTH && ((config.length_size != 1 && config.length_size != 2) || config.length_offset + config.length_size > config.max_length))
+        return false;
+
+    return true;
+}
+
+void UartFramer::configure(const uart_framing_config_t& new_config) {
+    config = new_config;
+    frame_length = 0;
+    expected_length = 0;
+}
+
+void UartFramer::push(const uint8_t* data, size_t len, uint32_t now_ms) {
+    if (len == 0)
+        return;
+
+    // the gap is measured between reads, bytes of one read arrived together
+    poll(now_ms);
+    last_byte_ms = now_ms;
+
+    for (size_t i = 0; i < len; i++) {
+        frame()[frame_length++] = data[i];
+
+        if (config.mode == UartFrameMode::FRAME_DELIMITER) {
+            if (delimiter_found()) {
+                size_t length = frame_length;
+                if ((config.flags & UART_FRAME_FLAG_KEEP_DELIMITER) == 0)
+                    length -= config.delimiter_length;
+
+                emit(length);
+                continue;
+            }
+        } else {
+            if (expected_length == 0)
+                update_expected_length();
+
+            if (expected_length != 0 && frame_length >= expected_length) {
+                emit(frame_length);
+                continue;
+            }
+        }
+
+        if (frame_length >= config.max_length)
+            emit(frame_length);
+    }
+}
+
+void UartFramer::poll(uint32_t now_ms) {
+    if (frame_length > 0 && config.idle_gap_ms > 0 && now_ms - last_byte_ms >= config.idle_gap_ms)
+        emit(frame_length);
+}
+
+bool UartFramer::delimiter_found() const {
+    if (frame_length < config.delimiter_length)
+        return false;
+
+    return std::memcmp(record + 1 + frame_length - config.delimiter_length, config.delimiter, config.delimiter_length) == 0;
+}
+
+void UartFramer::update_expected_length() {
+    if (frame_length < (size_t)config.length_offset + config.length_size)
+        return;
+
+    const uint8_t* field = record + 1 + config.length_offset;
+    int32_t value = field[0];
+    if (config.length_size == 2)
+        value = (config.flags & UART_FRAME_FLAG_BIG_ENDIAN) ? (field[0] << 8) | field[1] : field[0] | (field[1] << 8);
+
+    // an impossible length is not trusted, the frame is cut at max_length or by the idle gap instead
+    int32_t length = value + config.length_adjust;
+    if (length >= config.length_offset + config.length_size && length <= config.max_length)
+        expected_length = length;
+}
+
+void UartFramer::emit(size_t length) {
+    // empty lines between delimiters are not worth a frame
+    if (length > 0) {
+        record[0] = length;
+        output_fn(output_context, record, 1 + length);
+    }
+
+    frame_length = 0;
+    expected_length = 0;
+}
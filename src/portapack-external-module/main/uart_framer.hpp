@@ -0,0 +1,74 @@
+#ifndef UART_FRAMER_HPP
+#define UART_FRAMER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+// a frame and its chunk header (marker and length byte) fit the stream of one long drain response
+#define UART_FRAME_MAX_LENGTH 106
+#define UART_FRAME_MAX_DELIMITER 4
+
+enum class UartFrameMode : uint8_t {
+    FRAME_OFF = 0,    // bytes are drained as they arrive
+    FRAME_DELIMITER,  // a frame ends with the delimiter sequence
+    FRAME_LENGTH,     // a header field gives the frame length
+};
+
+#define UART_FRAME_FLAG_KEEP_DELIMITER 0x01  // the delimiter stays at the end of the frame
+#define UART_FRAME_FLAG_BIG_ENDIAN 0x02      // two byte length field, most significant byte first
+
+typedef struct
+{
+    UartFrameMode mode;
+    uint8_t max_length;   // longer frames are cut, 1 to UART_FRAME_MAX_LENGTH
+    uint8_t idle_gap_ms;  // a pause this long ends the frame, 0 disables it
+    uint8_t flags;
+    uint8_t delimiter_length;
+    uint8_t delimiter[UART_FRAME_MAX_DELIMITER];
+    uint8_t length_offset;  // position of the length field in the frame
+    uint8_t length_size;    // 1 or 2 bytes
+    int8_t length_adjust;   // frame length is the field value plus this
+} uart_framing_config_t;
+
+// record is the frame length byte followed by the frame
+typedef void (*uart_framer_output_fn)(void* context, const uint8_t* record, size_t len);
+
+/*
+    Cuts the filtered byte stream into frames, so the drain can deliver them whole.
+    Not thread safe: configure(), push() and poll() must be called from the same task.
+*/
+class UartFramer {
+   public:
+    UartFramer(uart_framer_output_fn output, void* output_context);
+
+    // wire format: mode, max_length, idle_gap_ms, flags, delimiter_length, 4 delimiter bytes,
+    // length_offset, length_size, length_adjust
+    static bool parse_config(const uint8_t* data, size_t len, uart_framing_config_t& config);
+
+    void configure(const uart_framing_config_t& config);
+    void push(const uint8_t* data, size_t len, uint32_t now_ms);
+    // ends a pending frame once the idle gap passed
+    void poll(uint32_t now_ms);
+
+    bool is_enabled() const { return config.mode != UartFrameMode::FRAME_OFF; }
+    UartFrameMode get_mode() const { return config.mode; }
+    bool has_idle_gap() const { return is_enabled() && config.idle_gap_ms > 0; }
+
+   private:
+    bool delimiter_found() const;
+    void update_expected_length();
+    void emit(size_t length);
+
+    uint8_t* frame() { return record + 1; }
+
+    uart_framer_output_fn output_fn;
+    void* output_context;
+    uart_framing_config_t config{};
+
+    uint8_t record[1 + UART_FRAME_MAX_LENGTH]{};
+    size_t frame_length{0};
+    size_t expected_length{0};  // length mode, 0 until the header is complete
+    uint32_t last_byte_ms{0};
+};
+
+#endif
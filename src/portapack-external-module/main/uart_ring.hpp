@@ -0,0 +1,104 @@
+#ifndef UART_RING_HPP
+#define UART_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+/*
+    Fixed size byte ring with one producer (uart task) and one consumer (i2c irq).
+    Capacity must be a power of two, the ring holds Capacity bytes.
+*/
+template <size_t Capacity>
+class UartRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+   public:
+    // returns the number of bytes stored, the rest did not fit
+    size_t push(const uint8_t* data, size_t len) {
+        size_t head_ = head.load(std::memory_order_relaxed);
+        size_t tail_ = tail.load(std::memory_order_acquire);
+
+        size_t space = Capacity - (head_ - tail_);
+        if (len > space)
+            len = space;
+
+        size_t offset = head_ & mask;
+        size_t first = len < Capacity - offset ? len : Capacity - offset;
+        std::memcpy(buffer + offset, data, first);
+        std::memcpy(buffer, data + first, len - first);
+
+        head.store(head_ + len, std::memory_order_release);
+        return len;
+    }
+
+    // returns the number of bytes copied to data
+    size_t pop(uint8_t* data, size_t len) {
+        size_t tail_ = tail.load(std::memory_order_relaxed);
+        size_t head_ = head.load(std::memory_order_acquire);
+
+        size_t used = head_ - tail_;
+        if (len > used)
+            len = used;
+
+        size_t offset = tail_ & mask;
+        size_t first = len < Capacity - offset ? len : Capacity - offset;
+        std::memcpy(data, buffer + offset, first);
+        std::memcpy(data + first, buffer, len - first);
+
+        tail.store(tail_ + len, std::memory_order_release);
+        return len;
+    }
+
+    // copies the oldest byte without removing it, returns false if the ring is empty
+    bool peek(uint8_t& value) const {
+        size_t tail_ = tail.load(std::memory_order_relaxed);
+        size_t head_ = head.load(std::memory_order_acquire);
+
+        if (head_ == tail_)
+            return false;
+
+        value = buffer[tail_ & mask];
+        return true;
+    }
+
+    // drops the oldest len bytes, counts as a consumer operation
+    size_t discard(size_t len) {
+        size_t tail_ = tail.load(std::memory_order_relaxed);
+        size_t head_ = head.load(std::memory_order_acquire);
+
+        size_t used = head_ - tail_;
+        if (len > used)
+            len = used;
+
+        tail.store(tail_ + len, std::memory_order_release);
+        return len;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t free() const {
+        return Capacity - size();
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+    // only call when the producer is stopped
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+   private:
+    static constexpr size_t mask = Capacity - 1;
+
+    uint8_t buffer[Capacity]{};
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+};
+
+#endif
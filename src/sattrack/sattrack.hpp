@@ -52,18 +52,21 @@ typedef struct
     float lon;
     uint8_t time_method;
 } sattrackdata_t;
+PP_MESSAGE(sattrackdata_t, 36);
 
 typedef struct
 {
     float lat;
     float lon;
 } sat_mgps_t;
+PP_MESSAGE(sat_mgps_t, 8);
 
 class SatTrackView : public ui::View {
    public:
     SatTrackView(ui::NavigationView& nav) {
         (void)nav;
         set_style(ui::Theme::getInstance()->bg_dark);
+        timer_refresh.start_ms(2000, true);
 
         add_children({&labels,
                       &option_sat,
@@ -90,28 +93,25 @@ class SatTrackView : public ui::View {
         option_sat.on_change = [this](size_t, ui::OptionsField::value_t v) {
             if (v != -1) {
                 std::string sn = option_sat.selected_index_name();
-                Command cmd = Command::PPCMD_SATTRACK_SETSAT;
-                std::vector<uint8_t> data(sn.begin(), sn.end());
-                data.insert(data.begin(), reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));  // hacky way to i2c_transfer
+                uint8_t data[PP_MESSAGE_MAX_SIZE];
+                size_t length = pp_command(Command::PPCMD_SATTRACK_SETSAT, (const uint8_t*)sn.data(), sn.size(), data, sizeof(data));
                 text_elevation.set("?");
                 text_azi.set("?");
-                if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
+                if (length == 0 || _api->i2c_read(data, length, nullptr, 0) == false) return;
             }
         };
         button_set.on_select = [this](ui::Button&) {
-            Command cmd = Command::PPCMD_SATTRACK_SETMGPS;
             sat_mgps_t mgps;
             mgps.lat = getLat();
             mgps.lon = getLon();
-            std::vector<uint8_t> data(sizeof(sat_mgps_t));
-            memcpy(data.data(), &mgps, sizeof(sat_mgps_t));
-            data.insert(data.begin(), reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));
+            auto data = pp_command(Command::PPCMD_SATTRACK_SETMGPS, mgps);
             if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
             option_sat.focus();
         };
     }
 
     ~SatTrackView() {
+        i2c_queue.cancel(this);
         ui::Theme::destroy();
     }
 
@@ -119,25 +119,8 @@ class SatTrackView : public ui::View {
         option_sat.focus();
     }
 
-    void on_framesync() override {
-        if (need_refresh()) {
-            Command cmd = Command::PPCMD_SATTRACK_DATA;
-            std::vector<uint8_t> data(sizeof(sattrackdata_t));
-
-            if (_api->i2c_read((uint8_t*)&cmd, 2, data.data(), data.size()) == false) return;
-
-            sattrackdata_t sattrackdata = *(sattrackdata_t*)data.data();
-            got_data(sattrackdata);
-        }
-    }
-
-    bool need_refresh() {
-        rfcnt++;
-        if (rfcnt > 120) {  // 2 sec
-            rfcnt = 0;
-            return true;
-        }
-        return false;
+    void refresh() {
+        i2c_queue.read<sattrackdata_t>(this, Command::PPCMD_SATTRACK_DATA, [this](const sattrackdata_t& data) { got_data(data); });
     }
 
     void got_data(sattrackdata_t data) {
@@ -218,7 +201,7 @@ class SatTrackView : public ui::View {
         lon -= mlons2.value() * 0.01;
         mlons3.set_value(lon * 1000);
     }
-    uint8_t rfcnt = 0;  // refresh counter, inc with frame_sync
+    FrameTimer timer_refresh{this, [this]() { refresh(); }};
     ui::Text text_fixtime{{40, 4 + 2 * 16, 26 * 8, 16}};
     ui::Text text_dbtime{{40, 4 + 3 * 16, 26 * 8, 16}, "?"};
     ui::Text text_elevation{{90, 4 + 5 * 16, 20 * 8, 16}};
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "sim_api.hpp"
+#include "sim_png.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/* Runs one app headless. Commands come from a script file, or stdin with "-", one per line:
+ *   frames N               N frame syncs, the screen is painted after every frame that made it dirty
+ *   key right|left|down|up|select|dfu|back
+ *   encoder N              rotary encoder steps, negative for counter clockwise
+ *   keyboard C             a character, or its code as 0xNN
+ *   touch X Y start|move|end
+ *   drag X1 Y1 X2 Y2 F [M]  touch at X1 Y1, then M moves per frame (4) over F frames towards X2 Y2, release there
+ *   i2c CMD [BYTES]        response for every read of the 16 bit command, hex, no bytes removes it
+ *   i2c-log on|off         print every transfer
+ *   png PATH               dump the screen
+ *   stats                  print timing and draw counters
+ * Without a script the app runs 60 frames and the screen goes to app.png. */
+
+extern "C" standalone_application_information_t _standalone_application_information;
+
+struct run_stats_t {
+    uint64_t frames;
+    uint64_t paints;
+    uint64_t dropped_frames;
+    std::chrono::nanoseconds event_time;
+    std::chrono::nanoseconds paint_time;
+    std::chrono::nanoseconds slot_time;  // spent in the app since the last frame sync
+};
+
+static run_stats_t run_stats{};
+
+// the app misses a frame sync for every full frame period it is busy between two of them
+static const std::chrono::nanoseconds frame_period{1000000000 / 60};
+
+static void paint_if_dirty() {
+    if (simulator.take_dirty() == false)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    _standalone_application_information.PaintViewMirror();
+    auto time = std::chrono::steady_clock::now() - start;
+    run_stats.paint_time += time;
+    run_stats.slot_time += time;
+    run_stats.paints++;
+}
+
+// input is painted right away, like the firmware does after every event
+template <typename Event>
+static void input(Event event) {
+    auto start = std::chrono::steady_clock::now();
+    event();
+    run_stats.slot_time += std::chrono::steady_clock::now() - start;
+    paint_if_dirty();
+}
+
+static void run_frame() {
+    auto start = std::chrono::steady_clock::now();
+    _standalone_application_information.on_event(1);
+    auto time = std::chrono::steady_clock::now() - start;
+    run_stats.event_time += time;
+    run_stats.slot_time += time;
+    run_stats.frames++;
+    paint_if_dirty();
+
+    run_stats.dropped_frames += run_stats.slot_time / frame_period;
+    run_stats.slot_time = {};
+}
+
+static void print_stats() {
+    sim_stats_t& s = simulator.stats();
+    auto average_us = [](std::chrono::nanoseconds total, uint64_t count) {
+        return count ? (double)total.count() / count / 1000.0 : 0.0;
+    };
+
+    printf("frames %llu (%llu dropped), on_event %.1f us avg, paints %llu, paint %.1f us avg\n",
+           (unsigned long long)run_stats.frames, (unsigned long long)run_stats.dropped_frames, average_us(run_stats.event_time, run_stats.frames),
+           (unsigned long long)run_stats.paints, average_us(run_stats.paint_time, run_stats.paints));
+    printf("draw calls %llu, pixels %llu, i2c transfers %llu\n",
+           (unsigned long long)s.draw_calls, (unsigned long long)s.pixels, (unsigned long long)s.i2c_transfers);
+}
+
+static bool parse_key(const std::string& name, uint8_t& key) {
+    static const char* names[] = {"right", "left", "down", "up", "select", "dfu", "back"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (name == names[i]) {
+            key = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool run_command(const std::string& line, int line_number) {
+    std::istringstream in(line);
+    std::string command;
+    if (!(in >> command) || command[0] == '#')
+        return true;
+
+    if (command == "frames") {
+        int count = 0;
+        in >> count;
+        for (int i = 0; i < count && simulator.exit_requested() == false; i++)
+            run_frame();
+    } else if (command == "key") {
+        std::string name;
+        uint8_t key;
+        if (!(in >> name) || parse_key(name, key) == false)
+            goto invalid;
+        input([key]() { _standalone_application_information.OnKeyEvent(key); });
+    } else if (command == "encoder") {
+        int32_t delta = 0;
+        if (!(in >> delta))
+            goto invalid;
+        input([delta]() { _standalone_application_information.OnEncoder(delta); });
+    } else if (command == "keyboard") {
+        std::string text;
+        if (!(in >> text))
+            goto invalid;
+        uint8_t key = text.size() > 2 && text.compare(0, 2, "0x") == 0 ? strtoul(text.c_str(), nullptr, 16) : text[0];
+        input([key]() { _standalone_application_information.OnKeyboad(key); });
+    } else if (command == "touch") {
+        int x, y;
+        std::string type;
+        if (!(in >> x >> y >> type))
+            goto invalid;
+        uint32_t value = type == "start" ? 0 : type == "move" ? 1 : type == "end" ? 2 : 3;
+        if (value > 2)
+            goto invalid;
+        input([=]() { _standalone_application_information.OnTouchEvent(x, y, value); });
+    } else if (command == "drag") {
+        int x1, y1, x2, y2, frames, moves = 4;
+        if (!(in >> x1 >> y1 >> x2 >> y2 >> frames) || frames < 1)
+            goto invalid;
+        in >> moves;
+        input([=]() { _standalone_application_information.OnTouchEvent(x1, y1, 0); });
+        for (int f = 0; f < frames && simulator.exit_requested() == false; f++) {
+            for (int m = 1; m <= moves; m++) {
+                int step = f * moves + m;
+                int x = x1 + (x2 - x1) * step / (frames * moves);
+                int y = y1 + (y2 - y1) * step / (frames * moves);
+                input([=]() { _standalone_application_information.OnTouchEvent(x, y, 1); });
+            }
+            run_frame();
+        }
+        input([=]() { _standalone_application_information.OnTouchEvent(x2, y2, 2); });
+    } else if (command == "i2c") {
+        std::string code, byte;
+        if (!(in >> code))
+            goto invalid;
+        std::vector<uint8_t> response;
+        while (in >> byte)
+            response.push_back(strtoul(byte.c_str(), nullptr, 16));
+        simulator.set_i2c_response(strtoul(code.c_str(), nullptr, 16), response);
+    } else if (command == "i2c-log") {
+        std::string state;
+        in >> state;
+        simulator.set_i2c_log(state == "on");
+    } else if (command == "png") {
+        std::string path;
+        if (!(in >> path))
+            goto invalid;
+        if (sim_write_png(path, simulator.screen(), SIM_SCREEN_WIDTH, SIM_SCREEN_HEIGHT) == false) {
+            fprintf(stderr, "line %d: can't write %s\n", line_number, path.c_str());
+            return false;
+        }
+    } else if (command == "stats") {
+        print_stats();
+    } else {
+        goto invalid;
+    }
+    return true;
+
+invalid:
+    fprintf(stderr, "line %d: invalid command: %s\n", line_number, line.c_str());
+    return false;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [--sd DIR] [--font5x8 FILE] [--font8x16 FILE] [SCRIPT|-]\n", name);
+}
+
+int main(int argc, char** argv) {
+    std::string script_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--sd" && has_value) {
+            simulator.set_sd_root(argv[++i]);
+        } else if ((arg == "--font5x8" || arg == "--font8x16") && has_value) {
+            if (simulator.load_font(argv[++i], arg == "--font8x16") == false) {
+                fprintf(stderr, "can't load font %s\n", argv[i]);
+                return 1;
+            }
+        } else if (arg[0] != '-' || arg == "-") {
+            script_path = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ifstream file;
+    std::istringstream default_script("frames 60\npng app.png\nstats\n");
+    std::istream* script = &default_script;
+    if (script_path == "-") {
+        script = &std::cin;
+    } else if (!script_path.empty()) {
+        file.open(script_path);
+        if (!file) {
+            fprintf(stderr, "can't open %s\n", script_path.c_str());
+            return 1;
+        }
+        script = &file;
+    }
+
+    printf("%s\n", (const char*)_standalone_application_information.app_name);
+    _standalone_application_information.initialize(simulator.api());
+    _standalone_application_information.OnFocus();
+    paint_if_dirty();
+
+    int result = 0;
+    std::string line;
+    for (int line_number = 1; std::getline(*script, line) && simulator.exit_requested() == false; line_number++) {
+        if (run_command(line, line_number) == false) {
+            result = 1;
+            break;
+        }
+    }
+
+    _standalone_application_information.shutdown();
+    return result;
+}
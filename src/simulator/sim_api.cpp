@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "sim_api.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <pthread.h>
+
+#define SIM_THREAD_MIN_STACK (1024 * 1024)
+
+Simulator simulator;
+
+// provided by the firmware, the api points at the same values
+namespace ui {
+uint16_t screen_width = SIM_SCREEN_WIDTH;
+uint16_t screen_height = SIM_SCREEN_HEIGHT;
+}  // namespace ui
+
+// glyphs are bit packed, lsb first, row by row
+static std::vector<uint8_t> box_font(int width, int height, size_t count) {
+    size_t stride = (width * height + 7) / 8;
+    std::vector<uint8_t> data(stride * count);
+
+    // a box for every glyph but space, so text still shows where it goes
+    for (size_t c = 1; c < count; c++) {
+        uint8_t* glyph = data.data() + c * stride;
+        for (int y = 1; y < height - 1; y++) {
+            for (int x = 0; x < width - 1; x++) {
+                if (y == 1 || y == height - 2 || x == 0 || x == width - 2) {
+                    size_t bit = y * width + x;
+                    glyph[bit >> 3] |= 1 << (bit & 7);
+                }
+            }
+        }
+    }
+
+    return data;
+}
+
+struct SimulatorApi {
+    static void fill_rectangle(int x, int y, int width, int height, uint16_t color) {
+        simulator.fill(x, y, width, height, color);
+    }
+
+    static void draw_bitmap(int x, int y, int width, int height, const uint8_t* pixels, uint16_t foreground, uint16_t background) {
+        simulator.stats_.draw_calls++;
+        for (int row = 0; row < height; row++) {
+            for (int column = 0; column < width; column++) {
+                size_t bit = row * width + column;
+                simulator.put(x + column, y + row, (pixels[bit >> 3] & (1 << (bit & 7))) ? foreground : background);
+            }
+        }
+    }
+
+    static void draw_pixels(const ui::Rect r, const ui::Color* const colors, const size_t count) {
+        simulator.stats_.draw_calls++;
+        for (size_t i = 0; i < count && r.width() > 0; i++)
+            simulator.put(r.left() + i % r.width(), r.top() + i / r.width(), colors[i].v);
+    }
+
+    static void draw_pixel(const ui::Point p, const ui::Color color) {
+        simulator.stats_.draw_calls++;
+        simulator.put(p.x(), p.y(), color.v);
+    }
+
+    // same arithmetic as the lcd driver of the firmware
+    static ui::Coord scroll_area_y(const ui::Coord y) {
+        return (simulator.scroll_position_ + y) % simulator.scroll_height_ + simulator.scroll_top_;
+    }
+
+    static void scroll_set_area(const ui::Coord top_y, const ui::Coord bottom_y) {
+        simulator.scroll_top_ = top_y;
+        simulator.scroll_height_ = bottom_y - top_y;
+        simulator.scroll_position_ = 0;
+    }
+
+    static void scroll_disable() {
+        simulator.scroll_top_ = 0;
+        simulator.scroll_height_ = SIM_SCREEN_HEIGHT;
+        simulator.scroll_position_ = 0;
+    }
+
+    static ui::Coord scroll_set_position(const ui::Coord position) {
+        simulator.scroll_position_ = position % simulator.scroll_height_;
+        return simulator.scroll_position_;
+    }
+
+    static ui::Coord scroll(const int32_t delta) {
+        int32_t height = simulator.scroll_height_;
+        return scroll_set_position((simulator.scroll_position_ + height + delta) % height);
+    }
+
+    static bool i2c_read(uint8_t* cmd, size_t cmd_len, uint8_t* data, size_t data_len) {
+        return simulator.i2c_read(cmd, cmd_len, data, data_len);
+    }
+
+    struct ThreadStart {
+        int32_t (*fn)(void*);
+        void* arg;
+    };
+
+    static void* thread_main(void* start) {
+        ThreadStart thread = *static_cast<ThreadStart*>(start);
+        delete static_cast<ThreadStart*>(start);
+        thread.fn(thread.arg);
+        return nullptr;
+    }
+
+    // a detached pthread like the heap thread of chibios, the priority has no host equivalent
+    // the stack gets a floor, the c library and the sanitizers need far more than the firmware
+    static void create_thread(int32_t (*fn)(void*), void* arg, size_t stack_size, int) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        pthread_attr_setstacksize(&attr, std::max<size_t>(stack_size, SIM_THREAD_MIN_STACK));
+
+        pthread_t thread;
+        auto start = new ThreadStart{fn, arg};
+        if (pthread_create(&thread, &attr, thread_main, start) != 0) {
+            delete start;
+            panic("create_thread failed");
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    static uint8_t swizzled_switches() { return 0; }
+    static uint64_t get_switches_state() { return 0; }
+
+    static void panic(const char* msg) {
+        fprintf(stderr, "panic: %s\n", msg);
+        exit(1);
+    }
+
+    static void set_dirty() { simulator.dirty_ = true; }
+    static void exit_app() { simulator.exit_requested_ = true; }
+};
+
+Simulator::Simulator() {
+    font_small_ = box_font(5, 8, 95);
+    font_large_ = box_font(8, 16, 223);
+
+    api_.malloc = ::malloc;
+    api_.calloc = ::calloc;
+    api_.realloc = ::realloc;
+    api_.free = ::free;
+    api_.create_thread = SimulatorApi::create_thread;
+    api_.fill_rectangle = SimulatorApi::fill_rectangle;
+    api_.swizzled_switches = SimulatorApi::swizzled_switches;
+    api_.get_switches_state = SimulatorApi::get_switches_state;
+    api_.fixed_5x8_glyph_data = font_small_.data();
+    api_.fixed_8x16_glyph_data = font_large_.data();
+    api_.fill_rectangle_unrolled8 = SimulatorApi::fill_rectangle;
+    api_.draw_bitmap = SimulatorApi::draw_bitmap;
+    api_.scroll_area_y = SimulatorApi::scroll_area_y;
+    api_.scroll_set_area = SimulatorApi::scroll_set_area;
+    api_.scroll_disable = SimulatorApi::scroll_disable;
+    api_.scroll_set_position = SimulatorApi::scroll_set_position;
+    api_.scroll = SimulatorApi::scroll;
+    api_.i2c_read = SimulatorApi::i2c_read;
+    api_.panic = SimulatorApi::panic;
+    api_.set_dirty = SimulatorApi::set_dirty;
+    api_.draw_pixels = SimulatorApi::draw_pixels;
+    api_.draw_pixel = SimulatorApi::draw_pixel;
+    api_.exit_app = SimulatorApi::exit_app;
+    api_.screen_height = &ui::screen_height;
+    api_.screen_width = &ui::screen_width;
+    sim_fatfs_install(api_);
+}
+
+bool Simulator::load_font(const std::string& path, bool large) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::vector<uint8_t>& font = large ? font_large_ : font_small_;
+    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (data.size() < font.size())
+        return false;
+
+    font = std::move(data);
+    (large ? api_.fixed_8x16_glyph_data : api_.fixed_5x8_glyph_data) = font.data();
+    return true;
+}
+
+void Simulator::set_i2c_response(uint16_t command, const std::vector<uint8_t>& response) {
+    if (response.empty())
+        i2c_responses_.erase(command);
+    else
+        i2c_responses_[command] = response;
+}
+
+bool Simulator::i2c_read(const uint8_t* cmd, size_t cmd_len, uint8_t* data, size_t data_len) {
+    stats_.i2c_transfers++;
+    if (cmd_len < 2)
+        return false;
+
+    uint16_t command = cmd[0] | (cmd[1] << 8);
+    if (i2c_log_) {
+        printf("i2c %04x", command);
+        for (size_t i = 2; i < cmd_len; i++)
+            printf(" %02x", cmd[i]);
+        printf(" -> %zu bytes\n", data_len);
+    }
+
+    if (data_len == 0)
+        return true;
+
+    // unknown commands read as zeros, like a module that does not answer them
+    memset(data, 0, data_len);
+    auto response = i2c_responses_.find(command);
+    if (response != i2c_responses_.end())
+        memcpy(data, response->second.data(), std::min(data_len, response->second.size()));
+
+    return true;
+}
+
+void Simulator::fill(int x, int y, int width, int height, uint16_t color) {
+    stats_.draw_calls++;
+    int left = std::max(x, 0);
+    int top = std::max(y, 0);
+    int right = std::min(x + width, SIM_SCREEN_WIDTH);
+    int bottom = std::min(y + height, SIM_SCREEN_HEIGHT);
+
+    for (int row = top; row < bottom; row++) {
+        for (int column = left; column < right; column++)
+            ram_[row][column] = color;
+    }
+
+    if (right > left && bottom > top)
+        stats_.pixels += (right - left) * (bottom - top);
+}
+
+void Simulator::put(int x, int y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= SIM_SCREEN_WIDTH || y >= SIM_SCREEN_HEIGHT)
+        return;
+
+    ram_[y][x] = color;
+    stats_.pixels++;
+}
+
+std::vector<uint16_t> Simulator::screen() const {
+    std::vector<uint16_t> pixels(SIM_SCREEN_WIDTH * SIM_SCREEN_HEIGHT);
+
+    for (int y = 0; y < SIM_SCREEN_HEIGHT; y++) {
+        // lines of the scroll window show the ram from the scroll position on
+        int line = y;
+        if (y >= scroll_top_ && y < scroll_top_ + scroll_height_)
+            line = scroll_top_ + (y - scroll_top_ + scroll_position_) % scroll_height_;
+
+        memcpy(pixels.data() + y * SIM_SCREEN_WIDTH, ram_[line], sizeof(ram_[line]));
+    }
+
+    return pixels;
+}
+
+bool Simulator::take_dirty() {
+    bool dirty = dirty_;
+    dirty_ = false;
+    return dirty;
+}
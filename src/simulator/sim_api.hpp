@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __SIM_API_H__
+#define __SIM_API_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "standalone_application.hpp"
+
+#define SIM_SCREEN_WIDTH 240
+#define SIM_SCREEN_HEIGHT 320
+
+/* Host stand-in for the firmware side of standalone_application_api_t.
+ * Drawing goes to a 240x320 RGB565 frame buffer that behaves like the display ram of the lcd,
+ * including the hardware scroll window, so what gets dumped is what the screen would show.
+ * File calls work on a host directory that stands in for the sd card.
+ * i2c_read answers from a table of scripted responses keyed by the command. */
+
+struct sim_stats_t {
+    uint64_t draw_calls;
+    uint64_t pixels;  // written to the frame buffer
+    uint64_t i2c_transfers;
+};
+
+class Simulator {
+   public:
+    Simulator();
+
+    const standalone_application_api_t& api() const { return api_; }
+
+    // the glyph data of the firmware, without it text is drawn as boxes
+    bool load_font(const std::string& path, bool large);
+    void set_sd_root(const std::string& path) { sd_root_ = path; }
+    const std::string& sd_root() const { return sd_root_; }
+
+    // the response is returned for every read of command until replaced, an empty response removes it
+    void set_i2c_response(uint16_t command, const std::vector<uint8_t>& response);
+    void set_i2c_log(bool enabled) { i2c_log_ = enabled; }
+
+    // the visible screen with the scroll window applied, row by row
+    std::vector<uint16_t> screen() const;
+
+    bool take_dirty();
+    bool exit_requested() const { return exit_requested_; }
+    sim_stats_t& stats() { return stats_; }
+
+   private:
+    friend struct SimulatorApi;
+
+    void fill(int x, int y, int width, int height, uint16_t color);
+    void put(int x, int y, uint16_t color);
+    bool i2c_read(const uint8_t* cmd, size_t cmd_len, uint8_t* data, size_t data_len);
+
+    standalone_application_api_t api_{};
+    uint16_t ram_[SIM_SCREEN_HEIGHT][SIM_SCREEN_WIDTH]{};
+
+    ui::Coord scroll_top_{0};
+    ui::Coord scroll_height_{SIM_SCREEN_HEIGHT};
+    ui::Coord scroll_position_{0};
+
+    std::vector<uint8_t> font_small_;
+    std::vector<uint8_t> font_large_;
+    std::string sd_root_{"."};
+
+    std::map<uint16_t, std::vector<uint8_t>> i2c_responses_;
+    bool i2c_log_{false};
+
+    bool dirty_{true};
+    bool exit_requested_{false};
+    sim_stats_t stats_{};
+};
+
+extern Simulator simulator;
+
+// the FatFs calls of the api on top of the host file system, see sim_fatfs.cpp
+void sim_fatfs_install(standalone_application_api_t& api);
+
+#endif /*__SIM_API_H__*/
@@ -0,0 +1,508 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "sim_api.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* FatFs paths are utf-16, the host gets utf-8 below the sd root. Open files and directories are tracked
+ * by the address of their FIL and DIR, whose fptr and objsize are kept current for f_tell and f_size.
+ * Every call holds the volume lock, like FatFs built with _FS_REENTRANT, so app threads can use files too. */
+
+struct sim_dir_t {
+    std::vector<std::string> names;
+    size_t index;
+    std::string path;
+    std::u16string pattern;  // f_findfirst, empty for f_readdir
+};
+
+static std::map<const FIL*, int> open_files;
+static std::map<const DIR*, sim_dir_t> open_dirs;
+static std::recursive_mutex volume_lock;  // recursive, some calls are built from others
+
+static std::string narrow(const TCHAR* text) {
+    std::string out;
+    for (; text && *text; text++) {
+        char16_t c = *text;
+        if (c < 0x80) {
+            out += (char)c;
+        } else if (c < 0x800) {
+            out += (char)(0xC0 | (c >> 6));
+            out += (char)(0x80 | (c & 0x3F));
+        } else {
+            out += (char)(0xE0 | (c >> 12));
+            out += (char)(0x80 | ((c >> 6) & 0x3F));
+            out += (char)(0x80 | (c & 0x3F));
+        }
+    }
+    return out;
+}
+
+static void widen(const std::string& text, TCHAR* out, size_t size) {
+    size_t length = 0;
+    for (size_t i = 0; i < text.size() && length + 1 < size;) {
+        uint8_t c = text[i];
+        char16_t value;
+        if (c < 0x80) {
+            value = c;
+            i += 1;
+        } else if ((c & 0xE0) == 0xC0 && i + 1 < text.size()) {
+            value = ((c & 0x1F) << 6) | (text[i + 1] & 0x3F);
+            i += 2;
+        } else if (i + 2 < text.size()) {
+            value = ((c & 0x0F) << 12) | ((text[i + 1] & 0x3F) << 6) | (text[i + 2] & 0x3F);
+            i += 3;
+        } else {
+            break;
+        }
+        out[length++] = value;
+    }
+    out[length] = 0;
+}
+
+static std::string host_path(const TCHAR* path) {
+    std::string p = narrow(path);
+    if (p.size() >= 2 && p[1] == ':')
+        p.erase(0, 2);
+    while (!p.empty() && p[0] == '/')
+        p.erase(0, 1);
+    return simulator.sd_root() + "/" + p;
+}
+
+static FRESULT error_result() {
+    switch (errno) {
+        case ENOENT:
+            return FR_NO_FILE;
+        case ENOTDIR:
+            return FR_NO_PATH;
+        case EEXIST:
+            return FR_EXIST;
+        case EACCES:
+        case EPERM:
+        case EISDIR:
+        case ENOTEMPTY:
+            return FR_DENIED;
+        default:
+            return FR_DISK_ERR;
+    }
+}
+
+static void fill_info(const std::string& path, const std::string& name, FILINFO* fno) {
+    memset(fno, 0, sizeof(*fno));
+    widen(name, fno->fname, sizeof(fno->fname) / sizeof(fno->fname[0]));
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return;
+
+    fno->fsize = S_ISDIR(st.st_mode) ? 0 : st.st_size;
+    fno->fattrib = S_ISDIR(st.st_mode) ? AM_DIR : AM_ARC;
+
+    struct tm t;
+    localtime_r(&st.st_mtime, &t);
+    fno->fdate = ((t.tm_year - 80) << 9) | ((t.tm_mon + 1) << 5) | t.tm_mday;
+    fno->ftime = (t.tm_hour << 11) | (t.tm_min << 5) | (t.tm_sec / 2);
+}
+
+// * and ? as FatFs matches them, case insensitive
+static bool matches(const char16_t* pattern, const char16_t* name) {
+    for (; *pattern; pattern++, name++) {
+        if (*pattern == u'*') {
+            for (; *name; name++) {
+                if (matches(pattern + 1, name))
+                    return true;
+            }
+            return matches(pattern + 1, name);
+        }
+
+        if (*name == 0)
+            return false;
+
+        char16_t a = *pattern < 0x80 ? tolower(*pattern) : *pattern;
+        char16_t b = *name < 0x80 ? tolower(*name) : *name;
+        if (*pattern != u'?' && a != b)
+            return false;
+    }
+    return *name == 0;
+}
+
+static void update_position(FIL* fp, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+        fp->obj.objsize = st.st_size;
+}
+
+static FRESULT sim_f_open(FIL* fp, const TCHAR* path, BYTE mode) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    int flags = (mode & FA_WRITE) ? ((mode & FA_READ) ? O_RDWR : O_WRONLY) : O_RDONLY;
+    if (mode & FA_CREATE_NEW)
+        flags |= O_CREAT | O_EXCL;
+    if (mode & FA_CREATE_ALWAYS)
+        flags |= O_CREAT | O_TRUNC;
+    if (mode & FA_OPEN_ALWAYS)
+        flags |= O_CREAT;
+
+    int fd = open(host_path(path).c_str(), flags, 0644);
+    if (fd < 0)
+        return error_result();
+
+    memset(fp, 0, sizeof(*fp));
+    open_files[fp] = fd;
+    update_position(fp, fd);
+    if ((mode & FA_OPEN_APPEND) == FA_OPEN_APPEND)
+        fp->fptr = fp->obj.objsize;
+    return FR_OK;
+}
+
+static FRESULT sim_f_close(FIL* fp) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    auto file = open_files.find(fp);
+    if (file == open_files.end())
+        return FR_INVALID_OBJECT;
+
+    close(file->second);
+    open_files.erase(file);
+    return FR_OK;
+}
+
+static FRESULT sim_f_read(FIL* fp, void* buff, UINT btr, UINT* br) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    auto file = open_files.find(fp);
+    if (file == open_files.end())
+        return FR_INVALID_OBJECT;
+
+    ssize_t n = pread(file->second, buff, btr, fp->fptr);
+    if (n < 0)
+        return FR_DISK_ERR;
+
+    fp->fptr += n;
+    if (br)
+        *br = n;
+    return FR_OK;
+}
+
+static FRESULT sim_f_write(FIL* fp, const void* buff, UINT btw, UINT* bw) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    auto file = open_files.find(fp);
+    if (file == open_files.end())
+        return FR_INVALID_OBJECT;
+
+    ssize_t n = pwrite(file->second, buff, btw, fp->fptr);
+    if (n < 0)
+        return FR_DISK_ERR;
+
+    fp->fptr += n;
+    update_position(fp, file->second);
+    if (bw)
+        *bw = n;
+    return FR_OK;
+}
+
+static FRESULT sim_f_lseek(FIL* fp, FSIZE_t ofs) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    auto file = open_files.find(fp);
+    if (file == open_files.end())
+        return FR_INVALID_OBJECT;
+
+    // like FatFs, seeking past the end of a writable file grows it
+    if (ofs > fp->obj.objsize && ftruncate(file->second, ofs) == 0)
+        update_position(fp, file->second);
+    fp->fptr = ofs < fp->obj.objsize ? ofs : fp->obj.objsize;
+    return FR_OK;
+}
+
+static FRESULT sim_f_truncate(FIL* fp) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    auto file = open_files.find(fp);
+    if (file == open_files.end())
+        return FR_INVALID_OBJECT;
+
+    if (ftruncate(file->second, fp->fptr) != 0)
+        return FR_DENIED;
+
+    update_position(fp, file->second);
+    return FR_OK;
+}
+
+static FRESULT sim_f_sync(FIL* fp) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    auto file = open_files.find(fp);
+    if (file == open_files.end())
+        return FR_INVALID_OBJECT;
+
+    fsync(file->second);
+    return FR_OK;
+}
+
+static FRESULT open_dir(DIR* dp, const TCHAR* path, std::u16string pattern) {
+    // dirent.h would clash with the DIR of FatFs
+    std::string p = host_path(path);
+    std::error_code error;
+    std::filesystem::directory_iterator entries{p, error};
+    if (error)
+        return FR_NO_PATH;
+
+    sim_dir_t dir{{}, 0, p, pattern};
+    for (const auto& entry : entries)
+        dir.names.push_back(entry.path().filename().string());
+
+    memset(dp, 0, sizeof(*dp));
+    open_dirs[dp] = std::move(dir);
+    return FR_OK;
+}
+
+static FRESULT sim_f_readdir(DIR* dp, FILINFO* fno) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    auto dir = open_dirs.find(dp);
+    if (dir == open_dirs.end())
+        return FR_INVALID_OBJECT;
+
+    sim_dir_t& d = dir->second;
+    if (fno == nullptr) {
+        d.index = 0;
+        return FR_OK;
+    }
+
+    while (d.index < d.names.size()) {
+        const std::string& name = d.names[d.index++];
+        fill_info(d.path + "/" + name, name, fno);
+        if (d.pattern.empty() || matches(d.pattern.c_str(), (const char16_t*)fno->fname))
+            return FR_OK;
+    }
+
+    // end of the directory
+    memset(fno, 0, sizeof(*fno));
+    return FR_OK;
+}
+
+static FRESULT sim_f_opendir(DIR* dp, const TCHAR* path) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return open_dir(dp, path, u"");
+}
+
+static FRESULT sim_f_closedir(DIR* dp) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return open_dirs.erase(dp) ? FR_OK : FR_INVALID_OBJECT;
+}
+
+static FRESULT sim_f_findfirst(DIR* dp, FILINFO* fno, const TCHAR* path, const TCHAR* pattern) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    FRESULT result = open_dir(dp, path, (const char16_t*)pattern);
+    if (result != FR_OK)
+        return result;
+    return sim_f_readdir(dp, fno);
+}
+
+static FRESULT sim_f_findnext(DIR* dp, FILINFO* fno) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return sim_f_readdir(dp, fno);
+}
+
+static FRESULT sim_f_mkdir(const TCHAR* path) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return mkdir(host_path(path).c_str(), 0755) == 0 ? FR_OK : error_result();
+}
+
+static FRESULT sim_f_unlink(const TCHAR* path) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    std::string p = host_path(path);
+    if (unlink(p.c_str()) == 0 || rmdir(p.c_str()) == 0)
+        return FR_OK;
+    return error_result();
+}
+
+static FRESULT sim_f_rename(const TCHAR* path_old, const TCHAR* path_new) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return rename(host_path(path_old).c_str(), host_path(path_new).c_str()) == 0 ? FR_OK : error_result();
+}
+
+static FRESULT sim_f_stat(const TCHAR* path, FILINFO* fno) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    std::string p = host_path(path);
+    struct stat st;
+    if (stat(p.c_str(), &st) != 0)
+        return error_result();
+
+    if (fno) {
+        size_t slash = p.find_last_of('/');
+        fill_info(p, slash == std::string::npos ? p : p.substr(slash + 1), fno);
+    }
+    return FR_OK;
+}
+
+static FRESULT sim_f_utime(const TCHAR*, const FILINFO*) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return FR_OK;
+}
+
+static FRESULT sim_f_getfree(const TCHAR*, DWORD* nclst, FATFS** fatfs) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    // reported as a card with 1 GB free in 32 KB clusters
+    static FATFS fs{};
+    fs.csize = 64;
+    fs.n_fatent = 32768 + 2;
+    if (nclst)
+        *nclst = 32768;
+    if (fatfs)
+        *fatfs = &fs;
+    return FR_OK;
+}
+
+static FRESULT sim_f_mount(FATFS*, const TCHAR*, BYTE) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return FR_OK;
+}
+
+static int write_text(FIL* fp, const std::string& text) {
+    UINT written = 0;
+    if (sim_f_write(fp, text.data(), text.size(), &written) != FR_OK || written != text.size())
+        return -1;
+    return written;
+}
+
+static int sim_f_putc(TCHAR c, FIL* fp) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    TCHAR text[2] = {c, 0};
+    return write_text(fp, narrow(text)) < 0 ? -1 : 1;
+}
+
+static int sim_f_puts(const TCHAR* str, FIL* fp) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    return write_text(fp, narrow(str));
+}
+
+// the conversions of the FatFs f_printf, %s takes a TCHAR string
+static int sim_f_printf(FIL* fp, const TCHAR* str, ...) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    std::string format = narrow(str);
+    std::string out;
+    va_list args;
+    va_start(args, str);
+
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%') {
+            out += format[i];
+            continue;
+        }
+
+        std::string spec = "%";
+        while (++i < format.size() && strchr("0-123456789", format[i]))
+            spec += format[i];
+        bool is_long = i < format.size() && (format[i] == 'l' || format[i] == 'L');
+        if (is_long)
+            i++;
+        if (i >= format.size())
+            break;
+
+        char type = format[i];
+        char buffer[64];
+        switch (type) {
+            case 's':
+                snprintf(buffer, sizeof(buffer), (spec + "s").c_str(), narrow(va_arg(args, const TCHAR*)).c_str());
+                break;
+            case 'c':
+                buffer[0] = (char)va_arg(args, int);
+                buffer[1] = 0;
+                break;
+            case 'd':
+            case 'D':
+                snprintf(buffer, sizeof(buffer), (spec + "ld").c_str(), is_long ? va_arg(args, long) : (long)va_arg(args, int));
+                break;
+            case 'u':
+            case 'U':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'O': {
+                unsigned long value = is_long ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+                char conversion = type == 'U' ? 'u' : type == 'O' ? 'o' : type;
+                snprintf(buffer, sizeof(buffer), (spec + "l" + conversion).c_str(), value);
+                break;
+            }
+            default:
+                buffer[0] = type;
+                buffer[1] = 0;
+                break;
+        }
+        out += buffer;
+    }
+
+    va_end(args);
+    return write_text(fp, out);
+}
+
+static TCHAR* sim_f_gets(TCHAR* buff, int len, FIL* fp) {
+    std::lock_guard<std::recursive_mutex> lock(volume_lock);
+    std::string line;
+    char c;
+    UINT read = 0;
+    while ((int)line.size() < len - 1 && sim_f_read(fp, &c, 1, &read) == FR_OK && read == 1) {
+        line += c;
+        if (c == '\n')
+            break;
+    }
+
+    if (line.empty())
+        return nullptr;
+
+    widen(line, buff, len);
+    return buff;
+}
+
+void sim_fatfs_install(standalone_application_api_t& api) {
+    api.f_open = sim_f_open;
+    api.f_close = sim_f_close;
+    api.f_read = sim_f_read;
+    api.f_write = sim_f_write;
+    api.f_lseek = sim_f_lseek;
+    api.f_truncate = sim_f_truncate;
+    api.f_sync = sim_f_sync;
+    api.f_opendir = sim_f_opendir;
+    api.f_closedir = sim_f_closedir;
+    api.f_readdir = sim_f_readdir;
+    api.f_findfirst = sim_f_findfirst;
+    api.f_findnext = sim_f_findnext;
+    api.f_mkdir = sim_f_mkdir;
+    api.f_unlink = sim_f_unlink;
+    api.f_rename = sim_f_rename;
+    api.f_stat = sim_f_stat;
+    api.f_utime = sim_f_utime;
+    api.f_getfree = sim_f_getfree;
+    api.f_mount = sim_f_mount;
+    api.f_putc = sim_f_putc;
+    api.f_puts = sim_f_puts;
+    api.f_printf = sim_f_printf;
+    api.f_gets = sim_f_gets;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include "sim_png.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+static uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+static void chunk(FILE* file, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> out;
+    put32(out, data.size());
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put32(out, crc32(out.data() + 4, out.size() - 4));
+    fwrite(out.data(), 1, out.size(), file);
+}
+
+bool sim_write_png(const std::string& path, const std::vector<uint16_t>& rgb565, int width, int height) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), file);
+
+    std::vector<uint8_t> header;
+    put32(header, width);
+    put32(header, height);
+    header.insert(header.end(), {8, 2, 0, 0, 0});  // 8 bit rgb, no interlace
+    chunk(file, "IHDR", header);
+
+    // every row starts with filter type 0
+    std::vector<uint8_t> raw;
+    raw.reserve(height * (1 + width * 3));
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        for (int x = 0; x < width; x++) {
+            uint16_t v = rgb565[y * width + x];
+            uint8_t r = (v >> 11) & 0x1F;
+            uint8_t g = (v >> 5) & 0x3F;
+            uint8_t b = v & 0x1F;
+            raw.push_back((r << 3) | (r >> 2));
+            raw.push_back((g << 2) | (g >> 4));
+            raw.push_back((b << 3) | (b >> 2));
+        }
+    }
+
+    std::vector<uint8_t> zlib{0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size() || pos == 0;) {
+        size_t length = std::min<size_t>(raw.size() - pos, 65535);
+        bool last = pos + length == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(length & 0xFF);
+        zlib.push_back(length >> 8);
+        zlib.push_back(~length & 0xFF);
+        zlib.push_back((~length >> 8) & 0xFF);
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + length);
+        pos += length;
+        if (last)
+            break;
+    }
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    put32(zlib, (b << 16) | a);
+    chunk(file, "IDAT", zlib);
+    chunk(file, "IEND", {});
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __SIM_PNG_H__
+#define __SIM_PNG_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// writes an 8 bit rgb png, deflate with stored blocks only so no zlib is needed
+bool sim_write_png(const std::string& path, const std::vector<uint16_t>& rgb565, int width, int height);
+
+#endif /*__SIM_PNG_H__*/
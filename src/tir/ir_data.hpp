@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include "pp_protocol.hpp"
 
 enum irproto : uint8_t {
     UNK,
@@ -15,4 +16,5 @@ typedef struct ir_data {
     irproto protocol;
     uint64_t data;
     uint8_t repeat;
-} ir_data_t;
\ No newline at end of file
+} ir_data_t;
+PP_MESSAGE(ir_data_t, 24);
\ No newline at end of file
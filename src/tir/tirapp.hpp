@@ -52,12 +52,12 @@ class TIRAppView : public ui::View {
         button_send.on_select = [this](ui::Button&) {
             if (send_mode_on) {  // already sending
                 // stop
-                send_mode_on = false;
+                set_send_mode(false);
                 file.close();
                 button_send.set_text("Send ir3");
                 return;
             }
-            recv_mode_on = false;
+            set_recv_mode(false);
             if (current_file_path.empty()) {
                 if (ir_to_send.protocol != irproto::UNK) {
                     send_ir_data();  // only repeat last i got
@@ -68,7 +68,7 @@ class TIRAppView : public ui::View {
             } else {
                 auto res = file.open("/IR/unioff.ir", true, false);
                 if (!res.is_valid()) {
-                    send_mode_on = true;
+                    set_send_mode(true);
                     button_send.set_text("Stop");
                 } else {
                     button_send.set_text("Send ir6");
@@ -78,7 +78,7 @@ class TIRAppView : public ui::View {
 
         button_recv.on_select = [this](ui::Button&) {
             if (send_mode_on) return;  // can't recv while sending
-            recv_mode_on = true;
+            set_recv_mode(true);
             button_recv.set_text("Waiting...");
             text_irproto.set("-");
             text_irdata.set("-");
@@ -96,28 +96,26 @@ class TIRAppView : public ui::View {
     }
 
     ~TIRAppView() {
+        i2c_queue.cancel(this);
         ui::Theme::destroy();
     }
 
     void send_ir_data() {
-        Command cmd = Command::PPCMD_IRTX_SENDIR;
-        std::vector<uint8_t> data(sizeof(ir_data_t));
-        memcpy(data.data(), &ir_to_send, sizeof(ir_data_t));
-        data.insert(data.begin(), reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));
+        auto data = pp_command(Command::PPCMD_IRTX_SENDIR, ir_to_send);
         if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
     }
 
     void send_next_ir() {
         if (!send_mode_on) return;
         if (current_file_path.empty()) {
-            send_mode_on = false;
+            set_send_mode(false);
             return;
         }
 
         auto irdata = read_flipper_ir_file(file);
         if (irdata.protocol == irproto::UNK) {
             // done or error
-            send_mode_on = false;
+            set_send_mode(false);
             file.close();
             button_send.set_text("Send ir2");
             return;
@@ -128,35 +126,30 @@ class TIRAppView : public ui::View {
         }
     }
 
-    void on_framesync() override {
-        if (need_refresh()) {
-            Command cmd = Command::PPCMD_IRTX_GETLASTRCVIR;
-            std::vector<uint8_t> data(sizeof(ir_data_t));
-            if (_api->i2c_read((uint8_t*)&cmd, 2, data.data(), data.size()) == false) return;
-            ir_data_t irdata = *(ir_data_t*)data.data();
-            got_data(irdata);
-        }
-        if (send_mode_on) {
-            send_timer++;
-            if (send_timer > 20) {  // around 150ms
-                send_timer = 0;
-                send_next_ir();
-            }
-        }
+    void set_send_mode(bool on) {
+        send_mode_on = on;
+        if (on)
+            timer_send.start_frames(21, true);  // our max is around 150ms per ir
+        else
+            timer_send.stop();
     }
 
-    void focus() override {
-        button_recv.focus();
+    void set_recv_mode(bool on) {
+        recv_mode_on = on;
+        if (on)
+            timer_recv.start_ms(1000, true);
+        else
+            timer_recv.stop();
     }
 
-    bool need_refresh() {
-        rfcnt++;
-        if (!recv_mode_on) return false;
-        if (rfcnt > 60) {  // 1 sec
-            rfcnt = 0;
-            return true;
-        }
-        return false;
+    void poll_received() {
+        i2c_queue.read<ir_data_t>(this, Command::PPCMD_IRTX_GETLASTRCVIR, [this](const ir_data_t& irdata) {
+            if (recv_mode_on) got_data(irdata);
+        });
+    }
+
+    void focus() override {
+        button_recv.focus();
     }
 
     void update_ir_display() {
@@ -190,7 +183,7 @@ class TIRAppView : public ui::View {
         ir_to_send.repeat = 2;
         text_filename.set("-");
         current_file_path = "";
-        recv_mode_on = false;  // no more, got a valid
+        set_recv_mode(false);  // no more, got a valid
         button_recv.set_text("Read ir");
         update_ir_display();
     }
@@ -212,10 +205,10 @@ class TIRAppView : public ui::View {
     ui::Text text_irproto{{UI_POS_X(0), UI_POS_Y(10), UI_POS_MAXWIDTH, UI_POS_HEIGHT(1)}, "-"};
     ui::Text text_irdata{{UI_POS_X(0), UI_POS_Y(11), UI_POS_MAXWIDTH, UI_POS_HEIGHT(1)}, "-"};
 
-    uint8_t rfcnt = 0;
     bool recv_mode_on = false;
     bool send_mode_on = false;
-    uint8_t send_timer = 0;  // our max is around 150ms per ir, so 10 framesync
+    FrameTimer timer_recv{this, [this]() { poll_received(); }};
+    FrameTimer timer_send{this, [this]() { send_next_ir(); }};
     std::filesystem::path current_file_path = "";
     ir_data_t ir_to_send{};
     File file{};
@@ -21,6 +21,8 @@
 
 #include "uart.hpp"
 
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -30,3 +32,871 @@ extern "C" void initialize(const standalone_application_api_t& api) {
     standaloneViewMirror = new ui::StandaloneViewMirror(*context, {0, 16, UI_POS_MAXWIDTH, UI_POS_MAXHEIGHT - 16});
     standaloneViewMirror->push<ui::UartAPPView>();
 }
+
+namespace ui {
+
+// channel 1 uses the console foreground, the others are color coded
+static const char* const channel_colors[UART_CHANNEL_COUNT] = {STR_COLOR_FOREGROUND, STR_COLOR_YELLOW, STR_COLOR_CYAN};
+
+UartAPPView::UartAPPView(NavigationView& nav)
+    : nav_(nav) {
+    set_style(ui::Theme::getInstance()->bg_dark);
+
+    add_children({&text,
+                  &console,
+                  &hex_dump,
+                  &button_n,
+                  &button_p,
+                  &button_filter,
+                  &button_flow,
+                  &option_channel,
+                  &check_enabled,
+                  &option_decode,
+                  &button_baudrate,
+                  &button_autobaud,
+                  &text_fill,
+                  &button_send,
+                  &button_file,
+                  &button_record,
+                  &button_stats,
+                  &text_tx,
+                  &text_stats_rates,
+                  &text_stats_timing});
+
+    text_stats_rates.set_style(ui::Theme::getInstance()->bg_darkest_small);
+    text_stats_timing.set_style(ui::Theme::getInstance()->bg_darkest_small);
+
+    text.set("BR: -");
+
+    // shares the place of the console, shown in the hex modes
+    hex_dump.hidden(true);
+    hex_dump.set_style(ui::Theme::getInstance()->bg_darkest_small);
+    hex_dump.set_channel_color(1, Color::yellow());
+    hex_dump.set_channel_color(2, Color::cyan());
+    console.enable_history(128);
+    highlighter_.load(u"UART/HIGHLIGHT.TXT");
+
+    for (uint8_t channel = 0; channel < UART_CHANNEL_COUNT; channel++) {
+        auto on_record = [this, channel](const decoded_record_t& record) {
+            write_record(channel, record);
+        };
+
+        nmea_decoders_[channel].on_record = on_record;
+        modbus_decoders_[channel].on_record = on_record;
+        slip_decoders_[channel].on_record = on_record;
+        cobs_decoders_[channel].on_record = on_record;
+    }
+
+    button_n.on_select = [this](ui::Button&) {
+        send_command(Command::COMMAND_UART_BAUDRATE_DEC, {selected_channel_});
+    };
+
+    button_p.on_select = [this](ui::Button&) {
+        send_command(Command::COMMAND_UART_BAUDRATE_INC, {selected_channel_});
+    };
+
+    button_filter.on_select = [this](ui::Button&) {
+        nav_.push<UartFilterView>(filter_settings_);
+    };
+
+    button_flow.on_select = [this](ui::Button&) {
+        nav_.push<UartFlowView>(selected_channel_, channel_status_[selected_channel_], framing_settings_[selected_channel_]);
+    };
+
+    button_baudrate.on_select = [this](ui::Button&) {
+        baudrate_edit_ = std::to_string(channel_status_[selected_channel_].baudrate);
+        text_prompt(nav_, baudrate_edit_, 7, ENTER_KEYBOARD_MODE_DIGITS, [this](std::string& value) {
+            set_baudrate(strtoul(value.c_str(), nullptr, 10));
+        });
+    };
+
+    button_autobaud.on_select = [this](ui::Button&) {
+        send_command(Command::COMMAND_UART_AUTOBAUD, {selected_channel_});
+    };
+
+    button_send.on_select = [this](ui::Button&) {
+        text_prompt(nav_, tx_line_, 64, ENTER_KEYBOARD_MODE_ALPHA, [this](std::string& value) {
+            // the line is queued, the channel is only switched when nothing else is pending
+            if (tx_text_.empty() && !tx_file_open_)
+                tx_channel_ = selected_channel_;
+
+            tx_text_ += value + "\r\n";
+            tx_line_.clear();
+            update_tx_text();
+        });
+    };
+
+    button_file.on_select = [this](ui::Button&) {
+        if (tx_file_open_) {
+            stop_file();
+            return;
+        }
+
+        auto open_view = nav_.push<FileLoadView>("");
+        open_view->on_changed = [this](std::filesystem::path path) {
+            start_file(path);
+        };
+    };
+
+    button_record.on_select = [this](ui::Button&) {
+        if (recorder_.is_recording()) {
+            stop_recording();
+            return;
+        }
+
+        auto record_view = nav_.push<UartRecordView>();
+        record_view->on_start = [this](UartRecordFormat format) {
+            if (recorder_.start(format))
+                button_record.set_text("Stop");
+            else
+                nav_.display_modal("Error", "Could not create\nthe capture file.");
+        };
+    };
+
+    button_stats.on_select = [this](ui::Button&) {
+        switch (stats_.mode()) {
+            case UartStatsMode::STATS_OFF:
+                set_stats_mode(UartStatsMode::STATS_LIVE);
+                break;
+
+            case UartStatsMode::STATS_LIVE:
+                set_stats_mode(UartStatsMode::STATS_SECOND);
+                break;
+
+            default:
+                set_stats_mode(UartStatsMode::STATS_OFF);
+                break;
+        }
+    };
+
+    option_channel.on_change = [this](size_t, ui::OptionsField::value_t v) {
+        selected_channel_ = v;
+        update_channel_widgets();
+        update_drain_status(drain_status_);
+    };
+
+    option_decode.on_change = [this](size_t, ui::OptionsField::value_t v) {
+        set_decode_mode((UartDecodeMode)v);
+    };
+
+    check_enabled.on_select = [this](ui::Checkbox&, bool v) {
+        if (channel_status_[selected_channel_].enabled == v)
+            return;
+
+        send_command(Command::COMMAND_UART_CHANNEL_ENABLE, {selected_channel_, (uint8_t)v});
+    };
+}
+
+void UartAPPView::on_framesync() {
+    stats_.frame_start();
+
+    // keep polling while the module measures the baud rate
+    if (channel_status_[selected_channel_].autobaud_state == UartAutobaudState::AUTOBAUD_RUNNING && ++status_refresh_ >= 30) {
+        status_refresh_ = 0;
+        status_dirty_ = true;
+    }
+
+    if (status_dirty_) {
+        request_status();
+    } else {
+        drain();
+        flush_highlights();
+        transmit();
+
+        // the full block is written after the drain burst, not in the middle of it
+        if (recorder_.is_recording()) {
+            recorder_.flush();
+            if (recorder_.has_failed())
+                stop_recording();
+        }
+    }
+
+    if (stats_.enabled() && stats_.frame_end())
+        update_stats();
+}
+
+void UartAPPView::set_stats_mode(UartStatsMode mode) {
+    stats_.set_mode(mode);
+    button_stats.set_text(mode == UartStatsMode::STATS_OFF ? "Stat" : mode == UartStatsMode::STATS_LIVE ? "Live" : "1s");
+    update_stats();
+}
+
+void UartAPPView::update_stats() {
+    text_stats_rates.set_style(stats_.dropping() ? &stats_alert_style_ : ui::Theme::getInstance()->bg_darkest_small);
+    text_stats_rates.set(stats_.enabled() ? stats_.rates_line() : "");
+    text_stats_timing.set(stats_.enabled() ? stats_.timing_line() : "");
+}
+
+// all module transfers of the view go through here so they show up in the statistics
+bool UartAPPView::i2c_transfer(uint8_t* cmd, size_t cmd_len, uint8_t* data, size_t data_len) {
+    stats_.add_i2c();
+    return _api->i2c_read(cmd, cmd_len, data, data_len);
+}
+
+void UartAPPView::write_console(const std::string& text) {
+    stats_.add_rendered(text.size());
+    console.write(text);
+}
+
+void UartAPPView::stop_recording() {
+    bool failed = recorder_.has_failed();
+    recorder_.stop();
+    button_record.set_text("Rec");
+
+    std::string message = recorder_.path().filename().string() + "\n" + std::to_string(recorder_.bytes_written()) + " bytes";
+    nav_.display_modal(failed ? "Write failed" : "Saved", message);
+}
+
+void UartAPPView::request_status() {
+    Command cmd = Command::COMMAND_UART_CHANNEL_STATUS_GET;
+
+    if (i2c_transfer((uint8_t*)&cmd, 2, (uint8_t*)channel_status_, sizeof(channel_status_)) == false)
+        return;
+
+    status_dirty_ = false;
+
+    // the module keeps its framing while the app is closed
+    for (uint8_t channel = 0; channel < UART_CHANNEL_COUNT; channel++) {
+        modbus_decoders_[channel].set_baudrate(channel_status_[channel].baudrate);
+        framing_settings_[channel].mode = channel_status_[channel].frame_mode;
+    }
+
+    update_channel_widgets();
+}
+
+void UartAPPView::update_channel_widgets() {
+    const uart_channel_status_t& status = channel_status_[selected_channel_];
+
+    switch (status.autobaud_state) {
+        case UartAutobaudState::AUTOBAUD_RUNNING:
+            text.set("BR: auto...");
+            break;
+
+        case UartAutobaudState::AUTOBAUD_FAILED:
+            text.set("BR: " + std::to_string(status.baudrate) + "?");
+            break;
+
+        default:
+            text.set("BR: " + std::to_string(status.baudrate));
+            break;
+    }
+
+    check_enabled.set_value(status.enabled != 0);
+
+    set_dirty();
+}
+
+void UartAPPView::set_baudrate(uint32_t baudrate) {
+    auto data = pp_command(Command::COMMAND_UART_BAUDRATE_SET, uart_baudrate_message_t{selected_channel_, baudrate});
+
+    i2c_transfer(data.data(), data.size(), nullptr, 0);
+    status_dirty_ = true;
+}
+
+void UartAPPView::send_command(Command cmd, std::initializer_list<uint8_t> payload) {
+    uint8_t data[sizeof(cmd) + 8];
+    memcpy(data, &cmd, sizeof(cmd));
+
+    size_t length = sizeof(cmd);
+    for (auto value : payload)
+        data[length++] = value;
+
+    i2c_transfer(data, length, nullptr, 0);
+    status_dirty_ = true;
+}
+
+void UartAPPView::drain() {
+    // poll with a short read first and only switch to long reads when the module has more data
+    const size_t header_size = 1 + sizeof(uart_drain_status_t);
+    Command cmd = Command::COMMAND_UART_REQUESTDATA_MUX_SHORT;
+    uint8_t data[128];
+    size_t data_size = header_size + 4;
+
+    uint8_t more_data_available;
+    do {
+        if (i2c_transfer((uint8_t*)&cmd, 2, data, data_size) == false)
+            return;
+
+        uint8_t stream_len = data[0] & 0x7f;
+        more_data_available = data[0] >> 7;
+
+        uart_drain_status_t status;
+        memcpy(&status, data + 1, sizeof(status));
+        update_drain_status(status);
+
+        // chunk stream, per chunk: 2 bit channel, 6 bit length, data
+        // length 0 is a whole frame: 1 byte frame length, frame
+        size_t pos = header_size;
+        size_t end = std::min(header_size + stream_len, data_size);
+        while (pos < end) {
+            uint8_t channel = data[pos] >> 6;
+            uint8_t length = data[pos] & 0x3f;
+            bool frame = length == 0;
+
+            if (frame) {
+                if (pos + 1 >= end)
+                    break;
+                length = data[++pos];
+            }
+
+            if (pos + 1 + length > end || channel >= UART_CHANNEL_COUNT)
+                break;
+
+            stats_.add_rx(length);
+            if (frame)
+                write_frame(channel, data + pos + 1, length, status.time_us);
+            else
+                write_channel(channel, data + pos + 1, length, status.time_us);
+            recorder_.record(channel, status.time_us, data + pos + 1, length);
+            pos += 1 + length;
+        }
+
+        if (more_data_available) {
+            cmd = Command::COMMAND_UART_REQUESTDATA_MUX_LONG;
+            data_size = sizeof(data);
+        }
+    } while (more_data_available == 1);
+}
+
+void UartAPPView::write_channel(uint8_t channel, const uint8_t* data, size_t length, uint32_t time_us) {
+    if (decode_mode_ == UartDecodeMode::DECODE_HEX8 || decode_mode_ == UartDecodeMode::DECODE_HEX16) {
+        stats_.add_rendered(length);
+        hex_dump.write(channel, data, length);
+        return;
+    }
+
+    if (decode_mode_ != UartDecodeMode::DECODE_RAW) {
+        decode_channel(channel, data, length, time_us);
+        return;
+    }
+
+    if (highlighter_.empty()) {
+        write_console(channel_colors[channel] + std::string((const char*)data, length));
+        return;
+    }
+
+    console_text_ = channel_colors[channel];
+    highlighter_.process(channel, data, length, channel_colors[channel], console_text_);
+    write_console(console_text_);
+}
+
+// a frame is shown at once and on its own line or hex row, the decoders see it as part of the stream
+void UartAPPView::write_frame(uint8_t channel, const uint8_t* data, size_t length, uint32_t time_us) {
+    write_channel(channel, data, length, time_us);
+
+    if (decode_mode_ == UartDecodeMode::DECODE_HEX8 || decode_mode_ == UartDecodeMode::DECODE_HEX16)
+        hex_dump.end_row();
+    else if (decode_mode_ == UartDecodeMode::DECODE_RAW && data[length - 1] != '\n')
+        write_channel(channel, (const uint8_t*)"\n", 1, time_us);
+}
+
+void UartAPPView::decode_channel(uint8_t channel, const uint8_t* data, size_t length, uint32_t time_us) {
+    switch (decode_mode_) {
+        case UartDecodeMode::DECODE_NMEA:
+            nmea_decoders_[channel].push(data, length);
+            break;
+
+        case UartDecodeMode::DECODE_MODBUS:
+            modbus_decoders_[channel].push(data, length, time_us);
+            break;
+
+        case UartDecodeMode::DECODE_SLIP:
+            slip_decoders_[channel].push(data, length);
+            break;
+
+        case UartDecodeMode::DECODE_COBS:
+            cobs_decoders_[channel].push(data, length);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void append_hex(std::string& text, const uint8_t* data, size_t length) {
+    static const char digits[] = "0123456789ABCDEF";
+
+    for (size_t i = 0; i < length; i++) {
+        text += ' ';
+        text += digits[data[i] >> 4];
+        text += digits[data[i] & 0x0F];
+    }
+}
+
+// one console line per record, the record name is green when the check passed and red otherwise
+void UartAPPView::write_record(uint8_t channel, const decoded_record_t& record) {
+    console_text_ = record.valid ? STR_COLOR_GREEN : STR_COLOR_RED;
+
+    switch (record.type) {
+        case DecodedRecordType::NMEA: {
+            // sentence name, then the fields without the checksum, empty fields shown as -
+            size_t end = record.length;
+            if (end >= 3 && record.data[end - 3] == '*')
+                end -= 3;
+
+            size_t pos = 1;
+            while (pos < end && record.data[pos] != ',')
+                console_text_ += (char)record.data[pos++];
+
+            console_text_ += channel_colors[channel];
+            while (pos < end) {
+                pos++;
+                console_text_ += ' ';
+
+                size_t start = pos;
+                while (pos < end && record.data[pos] != ',')
+                    console_text_ += (char)record.data[pos++];
+
+                if (pos == start)
+                    console_text_ += '-';
+            }
+            break;
+        }
+
+        case DecodedRecordType::MODBUS:
+            // address and function, the data without the crc
+            if (record.valid) {
+                console_text_ += "MB" + std::string(channel_colors[channel]) + " @" + std::to_string(record.data[0]) + " fn" + std::to_string(record.data[1]) + ":";
+                append_hex(console_text_, record.data + 2, record.length - 4);
+            } else {
+                console_text_ += "MB?" + std::string(channel_colors[channel]);
+                append_hex(console_text_, record.data, record.length);
+            }
+            break;
+
+        case DecodedRecordType::SLIP:
+        case DecodedRecordType::COBS:
+            console_text_ += record.type == DecodedRecordType::SLIP ? "SLIP" : "COBS";
+            console_text_ += std::string(channel_colors[channel]) + " " + std::to_string(record.length) + ":";
+            append_hex(console_text_, record.data, record.length);
+            break;
+    }
+
+    console_text_ += "\n";
+    write_console(console_text_);
+}
+
+void UartAPPView::set_decode_mode(UartDecodeMode mode) {
+    // partial records of the previous mode are dropped
+    for (uint8_t channel = 0; channel < UART_CHANNEL_COUNT; channel++) {
+        nmea_decoders_[channel].reset();
+        modbus_decoders_[channel].reset();
+        slip_decoders_[channel].reset();
+        cobs_decoders_[channel].reset();
+    }
+
+    decode_mode_ = mode;
+
+    // both switch the scroll area in the next paint, the console comes first in the children
+    bool hex = mode == UartDecodeMode::DECODE_HEX8 || mode == UartDecodeMode::DECODE_HEX16;
+    if (hex)
+        hex_dump.set_bytes_per_row(mode == UartDecodeMode::DECODE_HEX16 ? 16 : 8);
+    console.hidden(hex);
+    hex_dump.hidden(!hex);
+
+    if (!hex)
+        write_console(STR_COLOR_FOREGROUND "\n");
+}
+
+// the highlighter holds back the end of a chunk in case a keyword continues in the next one
+void UartAPPView::flush_highlights() {
+    if (highlighter_.empty())
+        return;
+
+    for (uint8_t channel = 0; channel < UART_CHANNEL_COUNT; channel++) {
+        console_text_ = channel_colors[channel];
+        size_t empty_length = console_text_.size();
+
+        highlighter_.flush(channel, channel_colors[channel], console_text_);
+        if (console_text_.size() > empty_length)
+            write_console(console_text_);
+    }
+}
+
+void UartAPPView::update_drain_status(const uart_drain_status_t& status) {
+    // only repaint when something visible changed, this runs for every drain
+    uint8_t bit = 1 << selected_channel_;
+    std::string fill = std::to_string(status.fill[selected_channel_] * 100 / 255) + "%";
+    const Style* style = ui::Theme::getInstance()->fg_light;
+    if (status.overflowed & bit)
+        style = ui::Theme::getInstance()->fg_red;
+    else if (status.holding & bit)
+        style = ui::Theme::getInstance()->fg_yellow;
+
+    if (style != fill_style_) {
+        fill_style_ = style;
+        text_fill.set_style(style);
+    }
+
+    if (fill != fill_text_) {
+        fill_text_ = fill;
+        text_fill.set(fill);
+    }
+
+    // the module reports the low 16 bit of its drop counters
+    if (stats_.enabled()) {
+        uint8_t fill = 0;
+        uint32_t dropped = 0;
+        for (uint8_t channel = 0; channel < UART_CHANNEL_COUNT; channel++) {
+            fill = std::max(fill, status.fill[channel]);
+            dropped += (uint16_t)(status.dropped[channel] - last_dropped_[channel]);
+        }
+        stats_.add_drain(fill, status.overflowed != 0, dropped);
+    }
+
+    for (uint8_t channel = 0; channel < UART_CHANNEL_COUNT; channel++)
+        last_dropped_[channel] = status.dropped[channel];
+
+    drain_status_ = status;
+    tx_credit_ = status.tx_free[tx_channel_] * UART_TX_FREE_UNIT;
+    update_tx_text();
+}
+
+void UartAPPView::start_file(const std::filesystem::path& path) {
+    if (tx_file_open_ || !tx_text_.empty()) {
+        nav_.display_modal("Error", "A transfer is already\nrunning.");
+        return;
+    }
+
+    auto error = tx_file_.open(path);
+    if (error.is_valid()) {
+        nav_.display_modal("Error", "Could not open\n" + path.filename().string());
+        return;
+    }
+
+    tx_channel_ = selected_channel_;
+    tx_file_open_ = true;
+    tx_block_pos_ = 0;
+    tx_block_length_ = 0;
+    tx_file_sent_ = 0;
+    tx_file_size_ = tx_file_.size();
+    button_file.set_text("Stop");
+    update_tx_text();
+}
+
+void UartAPPView::stop_file() {
+    tx_file_.close();
+    tx_file_open_ = false;
+    button_file.set_text("File");
+    update_tx_text();
+}
+
+// sends typed text first, then the file, in frames as large as the module has room for
+void UartAPPView::transmit() {
+    Command cmd = Command::COMMAND_UART_TX_DATA;
+    uint8_t data[sizeof(cmd) + 1 + UART_TX_FRAME_MAX_LENGTH];
+    memcpy(data, &cmd, sizeof(cmd));
+    data[sizeof(cmd)] = tx_channel_;
+    uint8_t* payload = data + sizeof(cmd) + 1;
+
+    for (size_t frame = 0; frame < UART_TX_FRAMES_PER_FRAMESYNC && tx_credit_ > 0; frame++) {
+        size_t max_length = std::min(tx_credit_, (size_t)UART_TX_FRAME_MAX_LENGTH);
+        size_t length = 0;
+
+        if (!tx_text_.empty()) {
+            length = std::min(tx_text_.size(), max_length);
+            memcpy(payload, tx_text_.data(), length);
+            tx_text_.erase(0, length);
+        } else if (tx_file_open_) {
+            if (tx_block_pos_ == tx_block_length_) {
+                auto result = tx_file_.read(tx_block_, sizeof(tx_block_));
+                if (result.is_error() || result.value() == 0) {
+                    stop_file();
+                    break;
+                }
+
+                tx_block_pos_ = 0;
+                tx_block_length_ = result.value();
+            }
+
+            length = std::min(tx_block_length_ - tx_block_pos_, max_length);
+            memcpy(payload, tx_block_ + tx_block_pos_, length);
+            tx_block_pos_ += length;
+            tx_file_sent_ += length;
+        }
+
+        if (length == 0)
+            break;
+
+        if (i2c_transfer(data, sizeof(cmd) + 1 + length, nullptr, 0) == false)
+            break;
+
+        tx_credit_ -= length;
+    }
+}
+
+void UartAPPView::update_tx_text() {
+    std::string status;
+
+    if (tx_file_open_)
+        status = "TX " + std::to_string(tx_file_size_ > 0 ? tx_file_sent_ * 100 / tx_file_size_ : 100) + "%";
+    else if (!tx_text_.empty() || (drain_status_.tx_idle & (1 << tx_channel_)) == 0)
+        status = "TX busy";
+    else
+        status = "TX idle";
+
+    if (status != tx_status_text_) {
+        tx_status_text_ = status;
+        text_tx.set(status);
+    }
+}
+
+UartRecordView::UartRecordView(NavigationView& nav)
+    : nav_(nav) {
+    set_style(ui::Theme::getInstance()->bg_dark);
+
+    add_children({&labels,
+                  &option_format,
+                  &button_start});
+
+    button_start.on_select = [this](Button&) {
+        auto format = (UartRecordFormat)option_format.selected_index_value();
+        auto on_start_ = on_start;
+        nav_.pop();
+
+        if (on_start_)
+            on_start_(format);
+    };
+}
+
+void UartRecordView::focus() {
+    option_format.focus();
+}
+
+struct uart_frame_delimiter_t {
+    uint8_t length;
+    uint8_t bytes[UART_FRAME_MAX_DELIMITER];
+};
+
+// the presets offered by UartFrameView::option_delimiter
+static const uart_frame_delimiter_t uart_frame_delimiters[] = {
+    {1, {'\n'}},
+    {2, {'\r', '\n'}},
+    {1, {'\r'}},
+    {1, {0x00}},
+    {1, {0x7E}},
+    {1, {0xC0}}};
+
+UartFrameView::UartFrameView(NavigationView& nav, uint8_t channel, uart_framing_settings_t& settings)
+    : nav_(nav),
+      channel_(channel),
+      settings_(settings) {
+    set_style(ui::Theme::getInstance()->bg_dark);
+
+    add_children({&labels,
+                  &option_mode,
+                  &option_delimiter,
+                  &check_keep_delimiter,
+                  &field_max_length,
+                  &field_idle_gap,
+                  &field_length_offset,
+                  &option_length_format,
+                  &field_length_adjust,
+                  &button_apply});
+
+    option_mode.set_by_value((int32_t)settings_.mode);
+    option_delimiter.set_by_value(settings_.delimiter);
+    check_keep_delimiter.set_value(settings_.keep_delimiter);
+    field_max_length.set_value(settings_.max_length);
+    field_idle_gap.set_value(settings_.idle_gap_ms);
+    field_length_offset.set_value(settings_.length_offset);
+    option_length_format.set_by_value(settings_.length_format);
+    field_length_adjust.set_value(settings_.length_adjust);
+
+    button_apply.on_select = [this](Button&) {
+        if (send_framing())
+            nav_.pop();
+        else
+            nav_.display_modal("Error", "Module did not accept\nthe framing.");
+    };
+}
+
+void UartFrameView::focus() {
+    option_mode.focus();
+}
+
+bool UartFrameView::send_framing() {
+    uart_framing_settings_t settings{
+        .mode = (UartFrameMode)option_mode.selected_index_value(),
+        .delimiter = (uint8_t)option_delimiter.selected_index_value(),
+        .keep_delimiter = check_keep_delimiter.value(),
+        .max_length = (uint8_t)field_max_length.value(),
+        .idle_gap_ms = (uint8_t)field_idle_gap.value(),
+        .length_offset = (uint8_t)field_length_offset.value(),
+        .length_format = (uint8_t)option_length_format.selected_index_value(),
+        .length_adjust = (int8_t)field_length_adjust.value(),
+    };
+
+    // the length field has to be inside the frame
+    size_t length_size = settings.length_format == 0 ? 1 : 2;
+    if (settings.mode == UartFrameMode::FRAME_LENGTH && settings.length_offset + length_size > settings.max_length)
+        return false;
+
+    const uart_frame_delimiter_t& delimiter = uart_frame_delimiters[settings.delimiter];
+    Command cmd = Command::COMMAND_UART_FRAMING_SET;
+    uint8_t data[sizeof(cmd) + 13] = {};
+
+    memcpy(data, &cmd, sizeof(cmd));
+    uint8_t* payload = data + sizeof(cmd);
+    payload[0] = channel_;
+    payload[1] = (uint8_t)settings.mode;
+    payload[2] = settings.max_length;
+    payload[3] = settings.idle_gap_ms;
+    payload[4] = (settings.keep_delimiter ? UART_FRAME_FLAG_KEEP_DELIMITER : 0) | (settings.length_format == 2 ? UART_FRAME_FLAG_BIG_ENDIAN : 0);
+    payload[5] = delimiter.length;
+    memcpy(payload + 6, delimiter.bytes, UART_FRAME_MAX_DELIMITER);
+    payload[10] = settings.length_offset;
+    payload[11] = length_size;
+    payload[12] = (uint8_t)settings.length_adjust;
+
+    if (_api->i2c_read(data, sizeof(data), nullptr, 0) == false)
+        return false;
+
+    settings_ = settings;
+    return true;
+}
+
+UartFlowView::UartFlowView(NavigationView& nav, uint8_t channel, uart_channel_status_t& status, uart_framing_settings_t& framing)
+    : nav_(nav),
+      channel_(channel),
+      status_(status),
+      framing_(framing) {
+    set_style(ui::Theme::getInstance()->bg_dark);
+
+    add_children({&labels,
+                  &option_flow,
+                  &option_drop,
+                  &field_high_water,
+                  &field_low_water,
+                  &button_framing,
+                  &button_apply});
+
+    option_flow.set_by_value((int32_t)status_.flow_control);
+    option_drop.set_by_value((int32_t)status_.drop_policy);
+    field_high_water.set_value(status_.high_water);
+    field_low_water.set_value(status_.low_water);
+
+    button_framing.on_select = [this](Button&) {
+        nav_.push<UartFrameView>(channel_, framing_);
+    };
+
+    button_apply.on_select = [this](Button&) {
+        if (field_low_water.value() >= field_high_water.value()) {
+            nav_.display_modal("Error", "Low water has to be\nbelow high water.");
+            return;
+        }
+
+        if (send_flow_control())
+            nav_.pop();
+        else
+            nav_.display_modal("Error", "Module did not accept\nthe flow control.");
+    };
+}
+
+void UartFlowView::focus() {
+    option_flow.focus();
+}
+
+bool UartFlowView::send_flow_control() {
+    Command cmd = Command::COMMAND_UART_FLOWCTRL_SET;
+    uint8_t data[sizeof(cmd) + 5];
+
+    memcpy(data, &cmd, sizeof(cmd));
+    data[sizeof(cmd)] = channel_;
+    data[sizeof(cmd) + 1] = option_flow.selected_index_value();
+    data[sizeof(cmd) + 2] = option_drop.selected_index_value();
+    data[sizeof(cmd) + 3] = field_high_water.value();
+    data[sizeof(cmd) + 4] = field_low_water.value();
+
+    if (_api->i2c_read(data, sizeof(data), nullptr, 0) == false)
+        return false;
+
+    status_.flow_control = (UartFlowControl)data[sizeof(cmd) + 1];
+    status_.drop_policy = (UartDropPolicy)data[sizeof(cmd) + 2];
+    status_.high_water = data[sizeof(cmd) + 3];
+    status_.low_water = data[sizeof(cmd) + 4];
+    return true;
+}
+
+UartFilterView::UartFilterView(NavigationView& nav, uart_filter_settings_t& settings)
+    : nav_(nav),
+      settings_(settings) {
+    set_style(ui::Theme::getInstance()->bg_dark);
+
+    add_children({&labels,
+                  &option_mode,
+                  &option_rule_type,
+                  &field_context,
+                  &text_patterns,
+                  &button_edit,
+                  &button_apply});
+
+    option_mode.set_by_value((int32_t)settings_.mode);
+    option_rule_type.set_by_value((int32_t)settings_.rule_type);
+    field_context.set_value(settings_.context_lines);
+    patterns_edit_ = settings_.patterns;
+    update_patterns();
+
+    button_edit.on_select = [this](Button&) {
+        text_prompt(nav_, patterns_edit_, 64, ENTER_KEYBOARD_MODE_ALPHA, [this](std::string& value) {
+            patterns_edit_ = value;
+            update_patterns();
+        });
+    };
+
+    button_apply.on_select = [this](Button&) {
+        settings_.mode = (UartFilterMode)option_mode.selected_index_value();
+        settings_.rule_type = (UartFilterRuleType)option_rule_type.selected_index_value();
+        settings_.context_lines = field_context.value();
+        settings_.patterns = patterns_edit_;
+
+        if (send_filter())
+            nav_.pop();
+        else
+            nav_.display_modal("Error", "Module did not accept\nthe filter.");
+    };
+}
+
+void UartFilterView::focus() {
+    option_mode.focus();
+}
+
+void UartFilterView::update_patterns() {
+    text_patterns.set(patterns_edit_.empty() ? "-" : patterns_edit_);
+}
+
+bool UartFilterView::send_filter() {
+    Command cmd = Command::COMMAND_UART_FILTER_SET;
+    std::vector<uint8_t> data(reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));
+
+    size_t rule_count_pos = data.size() + 2;
+    data.push_back((uint8_t)settings_.mode);
+    data.push_back(settings_.context_lines);
+    data.push_back(0);
+
+    uint8_t rule_count = 0;
+    if (settings_.mode != UartFilterMode::FILTER_OFF) {
+        size_t start = 0;
+        while (start <= settings_.patterns.size() && rule_count < UART_FILTER_MAX_RULES) {
+            size_t end = settings_.patterns.find('|', start);
+            if (end == std::string::npos)
+                end = settings_.patterns.size();
+
+            size_t length = std::min(end - start, (size_t)UART_FILTER_MAX_PATTERN);
+            if (length > 0) {
+                data.push_back((uint8_t)settings_.rule_type);
+                data.push_back(length);
+                data.insert(data.end(), settings_.patterns.begin() + start, settings_.patterns.begin() + start + length);
+                rule_count++;
+            }
+
+            start = end + 1;
+        }
+    }
+
+    data[rule_count_pos] = rule_count;
+
+    return _api->i2c_read(data.data(), data.size(), nullptr, 0);
+}
+
+}  // namespace ui
@@ -27,7 +27,13 @@
 #include "ui/theme.hpp"
 #include "ui/ui_helper.hpp"
 #include "ui/ui_navigation.hpp"
+#include "ui/ui_textentry.hpp"
+#include "ui/ui_fileman.hpp"
 #include "standaloneviewmirror.hpp"
+#include "uart_recorder.hpp"
+#include "uart_highlighter.hpp"
+#include "protocol_decoders.hpp"
+#include "uart_stats.hpp"
 
 #define USER_COMMANDS_START 0x7F01
 
@@ -39,88 +45,361 @@ enum class Command : uint16_t {
     COMMAND_UART_REQUESTDATA_LONG,
     COMMAND_UART_BAUDRATE_INC,
     COMMAND_UART_BAUDRATE_DEC,
-    COMMAND_UART_BAUDRATE_GET
+    COMMAND_UART_BAUDRATE_GET,
+    COMMAND_UART_FILTER_SET,
+    COMMAND_UART_REQUESTDATA_MUX_SHORT,
+    COMMAND_UART_REQUESTDATA_MUX_LONG,
+    COMMAND_UART_CHANNEL_ENABLE,
+    COMMAND_UART_CHANNEL_STATUS_GET,
+    COMMAND_UART_BAUDRATE_SET,
+    COMMAND_UART_AUTOBAUD,
+    COMMAND_UART_FLOWCTRL_SET,
+    COMMAND_UART_TX_DATA,
+    COMMAND_UART_FRAMING_SET
 };
 
-class UartAPPView : public ui::View {
-   public:
-    UartAPPView(ui::NavigationView& nav) {
-        (void)nav;
-        set_style(ui::Theme::getInstance()->bg_dark);
+#define UART_CHANNEL_COUNT 3
+#define UART_TX_FREE_UNIT 32
+#define UART_TX_FRAME_MAX_LENGTH 125
+// keeps a file transfer from starving the receive path
+#define UART_TX_FRAMES_PER_FRAMESYNC 16
+
+enum class UartAutobaudState : uint8_t {
+    AUTOBAUD_IDLE = 0,
+    AUTOBAUD_RUNNING,
+    AUTOBAUD_DONE,
+    AUTOBAUD_FAILED
+};
 
-        add_children({&text,
-                      &console,
-                      &button_n,
-                      &button_p
+enum class UartFlowControl : uint8_t {
+    FLOW_NONE = 0,
+    FLOW_RTS
+};
 
-        });
+enum class UartDropPolicy : uint8_t {
+    DROP_NEWEST = 0,
+    DROP_OLDEST
+};
 
-        text.set("BR: " + std::to_string(baudrate_));
+enum class UartFrameMode : uint8_t {
+    FRAME_OFF = 0,
+    FRAME_DELIMITER,
+    FRAME_LENGTH
+};
 
-        button_n.on_select = [this](ui::Button&) {
-            Command cmd_dec = Command::COMMAND_UART_BAUDRATE_DEC;
-            _api->i2c_read((uint8_t*)&cmd_dec, 2, nullptr, 0);
+#define UART_FRAME_MAX_LENGTH 106
+#define UART_FRAME_MAX_DELIMITER 4
+#define UART_FRAME_FLAG_KEEP_DELIMITER 0x01
+#define UART_FRAME_FLAG_BIG_ENDIAN 0x02
+
+// framing settings kept by the app, the module cuts the stream into frames
+struct uart_framing_settings_t {
+    UartFrameMode mode{UartFrameMode::FRAME_OFF};
+    uint8_t delimiter{0};  // index into the delimiter presets
+    bool keep_delimiter{false};
+    uint8_t max_length{UART_FRAME_MAX_LENGTH};
+    uint8_t idle_gap_ms{0};
+    uint8_t length_offset{0};
+    uint8_t length_format{0};  // 1 byte, 2 bytes little endian, 2 bytes big endian
+    int8_t length_adjust{0};
+};
 
-            baudrate_dirty_ = true;
-        };
+typedef struct
+{
+    uint8_t enabled;
+    UartAutobaudState autobaud_state;
+    UartFlowControl flow_control;
+    UartDropPolicy drop_policy;
+    uint32_t baudrate;
+    uint32_t rx_bytes;
+    uint32_t dropped_bytes;
+    uint8_t high_water;
+    uint8_t low_water;
+    UartFrameMode frame_mode;
+    uint8_t reserved;
+    uint32_t ring_fill;
+    uint32_t tx_bytes;
+    uint32_t tx_pending;
+} uart_channel_status_t;
+PP_MESSAGE(uart_channel_status_t, PP_UART_CHANNEL_STATUS_SIZE);
+
+// sent by the module in front of the chunk stream of every multiplexed drain response
+typedef struct __attribute__((packed))
+{
+    uint8_t fill[UART_CHANNEL_COUNT];     // 255 is full
+    uint8_t holding;                      // bit per channel
+    uint8_t overflowed;                   // bit per channel, since the previous drain
+    uint8_t tx_idle;                      // bit per channel
+    uint8_t tx_free[UART_CHANNEL_COUNT];  // in UART_TX_FREE_UNIT bytes
+    uint16_t dropped[UART_CHANNEL_COUNT];
+    uint32_t time_us;
+} uart_drain_status_t;
+
+// how received data is shown in the console, decoding is done by the app
+enum class UartDecodeMode : uint8_t {
+    DECODE_RAW = 0,
+    DECODE_NMEA,
+    DECODE_MODBUS,
+    DECODE_SLIP,
+    DECODE_COBS,
+    DECODE_HEX8,  // hex dump instead of the console
+    DECODE_HEX16
+};
 
-        button_p.on_select = [this](ui::Button&) {
-            Command cmd_inc = Command::COMMAND_UART_BAUDRATE_INC;
-            _api->i2c_read((uint8_t*)&cmd_inc, 2, nullptr, 0);
+enum class UartFilterMode : uint8_t {
+    FILTER_OFF = 0,
+    FILTER_INCLUDE,
+    FILTER_EXCLUDE,
+    FILTER_TRIGGER
+};
 
-            baudrate_dirty_ = true;
-        };
+enum class UartFilterRuleType : uint8_t {
+    RULE_PREFIX = 0,
+    RULE_SUBSTRING
+};
 
-        Command cmd = Command::COMMAND_UART_BAUDRATE_GET;
-        std::vector<uint8_t> data(4);
+#define UART_FILTER_MAX_RULES 4
+#define UART_FILTER_MAX_PATTERN 24
+#define UART_FILTER_MAX_CONTEXT 8
 
-        if (_api->i2c_read((uint8_t*)&cmd, 2, data.data(), data.size()) == false)
-            return;
+// filter settings kept by the app, the module evaluates them per line
+struct uart_filter_settings_t {
+    UartFilterMode mode{UartFilterMode::FILTER_OFF};
+    UartFilterRuleType rule_type{UartFilterRuleType::RULE_SUBSTRING};
+    uint8_t context_lines{0};
+    std::string patterns{};  // multiple patterns are separated by '|'
+};
 
-        uint32_t baudrate = *(uint32_t*)data.data();
-        set_baudrate(baudrate);
-    }
+class UartFilterView : public ui::View {
+   public:
+    UartFilterView(ui::NavigationView& nav, uart_filter_settings_t& settings);
 
-    ~UartAPPView() {
-        ui::Theme::destroy();
-    }
+    std::string title() const override { return "UART Filter"; };
+    void focus() override;
+
+   private:
+    bool send_filter();
+    void update_patterns();
+
+    ui::NavigationView& nav_;
+    uart_filter_settings_t& settings_;
+    std::string patterns_edit_{};
+
+    ui::Labels labels{
+        {{UI_POS_X(0), UI_POS_Y(1)}, "Mode:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(2)}, "Match:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(3)}, "Context:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(5)}, "Patterns:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(10)}, "Separate patterns with |", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(11)}, "Context: lines kept", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(12)}, "before the trigger", ui::Theme::getInstance()->fg_yellow->foreground}};
+
+    ui::OptionsField option_mode{
+        {UI_POS_X(10), UI_POS_Y(1)},
+        8,
+        {{"Off", (int32_t)UartFilterMode::FILTER_OFF},
+         {"Include", (int32_t)UartFilterMode::FILTER_INCLUDE},
+         {"Exclude", (int32_t)UartFilterMode::FILTER_EXCLUDE},
+         {"Trigger", (int32_t)UartFilterMode::FILTER_TRIGGER}}};
+
+    ui::OptionsField option_rule_type{
+        {UI_POS_X(10), UI_POS_Y(2)},
+        8,
+        {{"Prefix", (int32_t)UartFilterRuleType::RULE_PREFIX},
+         {"Contains", (int32_t)UartFilterRuleType::RULE_SUBSTRING}}};
+
+    ui::NumberField field_context{
+        {UI_POS_X(10), UI_POS_Y(3)},
+        1,
+        {0, UART_FILTER_MAX_CONTEXT},
+        1,
+        ' '};
+
+    ui::Text text_patterns{{UI_POS_X(0), UI_POS_Y(6), UI_POS_MAXWIDTH, UI_POS_HEIGHT(1)}};
+    ui::Button button_edit{{UI_POS_X(0), UI_POS_Y(7), UI_POS_WIDTH(14), UI_POS_HEIGHT(2)}, "Edit patterns"};
+    ui::Button button_apply{{UI_POS_X_CENTER(10), UI_POS_Y_BOTTOM(5), UI_POS_WIDTH(10), UI_POS_HEIGHT(2)}, "Apply"};
+};
+
+class UartFlowView : public ui::View {
+   public:
+    UartFlowView(ui::NavigationView& nav, uint8_t channel, uart_channel_status_t& status, uart_framing_settings_t& framing);
+
+    std::string title() const override { return "UART Flow"; };
+    void focus() override;
+
+   private:
+    bool send_flow_control();
+
+    ui::NavigationView& nav_;
+    uint8_t channel_;
+    uart_channel_status_t& status_;
+    uart_framing_settings_t& framing_;
+
+    ui::Labels labels{
+        {{UI_POS_X(0), UI_POS_Y(1)}, "Flow:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(2)}, "When full:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(3)}, "High water:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(4)}, "Low water:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(15), UI_POS_Y(3)}, "%", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(15), UI_POS_Y(4)}, "%", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(6)}, "RTS pins: Ch1 15,", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(7)}, "Ch2 16, Ch3 17", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(8)}, "RTS pauses reading above", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(9)}, "high and resumes below low", ui::Theme::getInstance()->fg_yellow->foreground}};
+
+    ui::OptionsField option_flow{
+        {UI_POS_X(12), UI_POS_Y(1)},
+        4,
+        {{"None", (int32_t)UartFlowControl::FLOW_NONE},
+         {"RTS", (int32_t)UartFlowControl::FLOW_RTS}}};
+
+    ui::OptionsField option_drop{
+        {UI_POS_X(12), UI_POS_Y(2)},
+        8,
+        {{"Drop new", (int32_t)UartDropPolicy::DROP_NEWEST},
+         {"Drop old", (int32_t)UartDropPolicy::DROP_OLDEST}}};
+
+    ui::NumberField field_high_water{
+        {UI_POS_X(12), UI_POS_Y(3)},
+        3,
+        {10, 100},
+        5,
+        ' '};
+
+    ui::NumberField field_low_water{
+        {UI_POS_X(12), UI_POS_Y(4)},
+        3,
+        {0, 95},
+        5,
+        ' '};
+
+    ui::Button button_framing{{UI_POS_X(0), UI_POS_Y(11), UI_POS_WIDTH(14), UI_POS_HEIGHT(2)}, "Framing"};
+    ui::Button button_apply{{UI_POS_X_CENTER(10), UI_POS_Y_BOTTOM(5), UI_POS_WIDTH(10), UI_POS_HEIGHT(2)}, "Apply"};
+};
+
+class UartFrameView : public ui::View {
+   public:
+    UartFrameView(ui::NavigationView& nav, uint8_t channel, uart_framing_settings_t& settings);
 
-    void on_framesync() override {
-        if (isBaudrateChanged()) {
-            Command cmd = Command::COMMAND_UART_BAUDRATE_GET;
-            std::vector<uint8_t> data(4);
+    std::string title() const override { return "UART Framing"; };
+    void focus() override;
 
-            if (_api->i2c_read((uint8_t*)&cmd, 2, data.data(), data.size()) == false)
-                return;
+   private:
+    bool send_framing();
+
+    ui::NavigationView& nav_;
+    uint8_t channel_;
+    uart_framing_settings_t& settings_;
+
+    ui::Labels labels{
+        {{UI_POS_X(0), UI_POS_Y(1)}, "Mode:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(2)}, "Delimiter:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(4)}, "Max length:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(5)}, "Idle gap:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(16), UI_POS_Y(5)}, "ms", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(6)}, "Len offset:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(7)}, "Len field:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(8)}, "Len adjust:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(10)}, "Frames end at the delimiter", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(11)}, "or after field value plus", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(12)}, "adjust bytes. Gap 0 is off", ui::Theme::getInstance()->fg_yellow->foreground}};
+
+    ui::OptionsField option_mode{
+        {UI_POS_X(12), UI_POS_Y(1)},
+        9,
+        {{"Off", (int32_t)UartFrameMode::FRAME_OFF},
+         {"Delimiter", (int32_t)UartFrameMode::FRAME_DELIMITER},
+         {"Length", (int32_t)UartFrameMode::FRAME_LENGTH}}};
+
+    // values index uart_frame_delimiters
+    ui::OptionsField option_delimiter{
+        {UI_POS_X(12), UI_POS_Y(2)},
+        5,
+        {{"LF", 0},
+         {"CR LF", 1},
+         {"CR", 2},
+         {"NUL", 3},
+         {"0x7E", 4},
+         {"0xC0", 5}}};
+
+    ui::Checkbox check_keep_delimiter{{UI_POS_X(0), UI_POS_Y(3)}, 14, "Keep delimiter", true};
+
+    ui::NumberField field_max_length{
+        {UI_POS_X(12), UI_POS_Y(4)},
+        3,
+        {1, UART_FRAME_MAX_LENGTH},
+        1,
+        ' '};
+
+    ui::NumberField field_idle_gap{
+        {UI_POS_X(12), UI_POS_Y(5)},
+        3,
+        {0, 250},
+        5,
+        ' '};
+
+    ui::NumberField field_length_offset{
+        {UI_POS_X(12), UI_POS_Y(6)},
+        2,
+        {0, 16},
+        1,
+        ' '};
+
+    ui::OptionsField option_length_format{
+        {UI_POS_X(12), UI_POS_Y(7)},
+        6,
+        {{"1 byte", 0},
+         {"2 LE", 1},
+         {"2 BE", 2}}};
+
+    ui::NumberField field_length_adjust{
+        {UI_POS_X(12), UI_POS_Y(8)},
+        3,
+        {-16, 16},
+        1,
+        ' '};
+
+    ui::Button button_apply{{UI_POS_X_CENTER(10), UI_POS_Y_BOTTOM(5), UI_POS_WIDTH(10), UI_POS_HEIGHT(2)}, "Apply"};
+};
 
-            uint32_t baudrate = *(uint32_t*)data.data();
-            set_baudrate(baudrate);
-            return;
-        }
+class UartRecordView : public ui::View {
+   public:
+    std::function<void(UartRecordFormat)> on_start{};
 
-        Command cmd = Command::COMMAND_UART_REQUESTDATA_SHORT;
-        std::vector<uint8_t> data(5);
+    UartRecordView(ui::NavigationView& nav);
 
-        uint8_t more_data_available;
-        do {
-            if (_api->i2c_read((uint8_t*)&cmd, 2, data.data(), data.size()) == false)
-                return;
+    std::string title() const override { return "UART Record"; };
+    void focus() override;
 
-            uint8_t data_len = data[0] & 0x7f;
-            more_data_available = data[0] >> 7;
-            uint8_t* data_ptr = data.data() + 1;
+   private:
+    ui::NavigationView& nav_;
+
+    ui::Labels labels{
+        {{UI_POS_X(0), UI_POS_Y(1)}, "Format:", ui::Theme::getInstance()->fg_light->foreground},
+        {{UI_POS_X(0), UI_POS_Y(3)}, "Files go to /UART.", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(4)}, "Text keeps the bytes as", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(5)}, "received, Binary adds", ui::Theme::getInstance()->fg_yellow->foreground},
+        {{UI_POS_X(0), UI_POS_Y(6)}, "channel and timestamp.", ui::Theme::getInstance()->fg_yellow->foreground}};
+
+    ui::OptionsField option_format{
+        {UI_POS_X(10), UI_POS_Y(1)},
+        6,
+        {{"Text", (int32_t)UartRecordFormat::RECORD_TEXT},
+         {"Binary", (int32_t)UartRecordFormat::RECORD_BINARY}}};
+
+    ui::Button button_start{{UI_POS_X_CENTER(10), UI_POS_Y_BOTTOM(5), UI_POS_WIDTH(10), UI_POS_HEIGHT(2)}, "Start"};
+};
 
-            if (data_len > 0) {
-                get_console().write(std::string((char*)data_ptr, data_len));
-            }
+class UartAPPView : public ui::View {
+   public:
+    UartAPPView(ui::NavigationView& nav);
 
-            if (more_data_available) {
-                cmd = Command::COMMAND_UART_REQUESTDATA_LONG;
-                data = std::vector<uint8_t>(128);
-            }
-        } while (more_data_available == 1);
+    ~UartAPPView() {
+        ui::Theme::destroy();
     }
 
+    void on_framesync() override;
+
     ui::Console& get_console() {
         return console;
     }
@@ -129,29 +408,113 @@ class UartAPPView : public ui::View {
         button_n.focus();
     }
 
-    void set_baudrate(uint32_t baudrate) {
-        baudrate_ = baudrate;
-        baudrate_dirty_ = false;
-
-        text.set("BR: " + std::to_string(baudrate_));
-
-        set_dirty();
-    }
-
-    bool isBaudrateChanged() {
-        return baudrate_dirty_;
-    }
-
    private:
+    void request_status();
+    void set_baudrate(uint32_t baudrate);
+    void update_channel_widgets();
+    void send_command(Command cmd, std::initializer_list<uint8_t> payload);
+    void drain();
+    void write_channel(uint8_t channel, const uint8_t* data, size_t length, uint32_t time_us);
+    void write_frame(uint8_t channel, const uint8_t* data, size_t length, uint32_t time_us);
+    void decode_channel(uint8_t channel, const uint8_t* data, size_t length, uint32_t time_us);
+    void write_record(uint8_t channel, const decoded_record_t& record);
+    void set_decode_mode(UartDecodeMode mode);
+    void write_console(const std::string& text);
+    bool i2c_transfer(uint8_t* cmd, size_t cmd_len, uint8_t* data, size_t data_len);
+    void set_stats_mode(UartStatsMode mode);
+    void update_stats();
+    void flush_highlights();
+    void update_drain_status(const uart_drain_status_t& status);
+    void transmit();
+    void start_file(const std::filesystem::path& path);
+    void stop_file();
+    void update_tx_text();
+    void stop_recording();
+
+    ui::NavigationView& nav_;
+    uart_filter_settings_t filter_settings_{};
+    uart_framing_settings_t framing_settings_[UART_CHANNEL_COUNT]{};
+
+    uart_channel_status_t channel_status_[UART_CHANNEL_COUNT]{};
+    uint8_t selected_channel_{0};
+    bool status_dirty_{true};
+    uint8_t status_refresh_{0};
+    std::string baudrate_edit_{};
+    uart_drain_status_t drain_status_{};
+    std::string fill_text_{};
+    const Style* fill_style_{nullptr};
+
+    uint8_t tx_channel_{0};
+    size_t tx_credit_{0};  // bytes the module can take, refreshed by every drain
+    std::string tx_line_{};
+    std::string tx_text_{};  // typed text waiting to be sent
+    File tx_file_{};
+    bool tx_file_open_{false};
+    uint8_t tx_block_[std::filesystem::max_file_block_size]{};
+    size_t tx_block_pos_{0};
+    size_t tx_block_length_{0};
+    uint64_t tx_file_sent_{0};
+    uint64_t tx_file_size_{0};
+    std::string tx_status_text_{};
+
+    UartRecorder recorder_{};
+    UartHighlighter highlighter_{};
+    std::string console_text_{};
+
+    UartDecodeMode decode_mode_{UartDecodeMode::DECODE_RAW};
+    NmeaDecoder nmea_decoders_[UART_CHANNEL_COUNT]{};
+    ModbusRtuDecoder modbus_decoders_[UART_CHANNEL_COUNT]{};
+    SlipDecoder slip_decoders_[UART_CHANNEL_COUNT]{};
+    CobsDecoder cobs_decoders_[UART_CHANNEL_COUNT]{};
+
+    UartStats stats_{};
+    uint16_t last_dropped_[UART_CHANNEL_COUNT]{};
+    const Style stats_alert_style_{
+        .font = ui::font::fixed_5x8(),
+        .background = ui::Theme::getInstance()->bg_darkest_small->background,
+        .foreground = Color::red(),
+    };
+
     ui::Text text{{4, 4, 96, 16}};
 
     ui::Button button_n{{100, 4, 16, 24}, "-"};
     ui::Button button_p{{120, 4, 16, 24}, "+"};
-
-    ui::Console console{{0, 2 * 16, UI_POS_MAXWIDTH, UI_POS_HEIGHT_REMAINING(4)}};
-
-    uint32_t baudrate_{115200};
-    bool baudrate_dirty_{true};
+    ui::Button button_filter{{144, 4, 56, 24}, "Filter"};
+    ui::Button button_flow{{204, 4, 36, 24}, "Flow"};
+
+    ui::OptionsField option_channel{
+        {4, 30},
+        3,
+        {{"Ch1", 0},
+         {"Ch2", 1},
+         {"Ch3", 2}}};
+    ui::Checkbox check_enabled{{36, 30}, 2, "On", true};
+    ui::OptionsField option_decode{
+        {68, 30},
+        4,
+        {{"Raw", (int32_t)UartDecodeMode::DECODE_RAW},
+         {"Hex8", (int32_t)UartDecodeMode::DECODE_HEX8},
+         {"Hx16", (int32_t)UartDecodeMode::DECODE_HEX16},
+         {"NMEA", (int32_t)UartDecodeMode::DECODE_NMEA},
+         {"MBus", (int32_t)UartDecodeMode::DECODE_MODBUS},
+         {"SLIP", (int32_t)UartDecodeMode::DECODE_SLIP},
+         {"COBS", (int32_t)UartDecodeMode::DECODE_COBS}}};
+    ui::Button button_baudrate{{100, 28, 48, 20}, "Baud"};
+    ui::Button button_autobaud{{152, 28, 48, 20}, "Auto"};
+    ui::Text text_fill{{204, 30, 36, 16}, "-"};
+
+    ui::Button button_send{{4, 50, 40, 20}, "Send"};
+    ui::Button button_file{{48, 50, 40, 20}, "File"};
+    ui::Button button_record{{92, 50, 40, 20}, "Rec"};
+    ui::Button button_stats{{136, 50, 40, 20}, "Stat"};
+    ui::Text text_tx{{180, 52, 60, 16}, "TX idle"};
+
+    ui::Console console{{0, 72, UI_POS_MAXWIDTH, UI_POS_HEIGHT_REMAINING(6) - 8}};
+    ui::HexDump hex_dump{{0, 72, UI_POS_MAXWIDTH, UI_POS_HEIGHT_REMAINING(6) - 8}, 256};
+
+    // the row below the console
+    ui::Text text_stats_rates{{0, UI_POS_Y_BOTTOM(2), UI_POS_MAXWIDTH, 8}};
+    ui::Text text_stats_timing{{0, UI_POS_Y_BOTTOM(2) + 8, UI_POS_MAXWIDTH, 8}};
 };
 
 }  // namespace ui
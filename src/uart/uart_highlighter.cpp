@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include "uart_highlighter.hpp"
+
+#include <cstring>
+
+#include "ui/file_reader.hpp"
+
+namespace ui {
+
+static const struct {
+    const char* name;
+    uint8_t color;
+} highlight_colors[] = {
+    {"red", 0x0C},
+    {"yellow", 0x0E},
+    {"green", 0x0A},
+    {"cyan", 0x0B},
+    {"blue", 0x09},
+    {"magenta", 0x0D},
+    {"white", 0x0F},
+    {"grey", 0x07}};
+
+static char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+bool UartHighlighter::load(const std::filesystem::path& path) {
+    clear();
+
+    File file;
+    auto error = file.open(path);
+    if (error.is_valid())
+        return false;
+
+    FileLineReader reader{file};
+    for (const auto& line : reader) {
+        std::string_view keyword{line};
+        while (!keyword.empty() && (keyword.back() == '\n' || keyword.back() == '\r'))
+            keyword.remove_suffix(1);
+
+        if (keyword.empty() || keyword.front() == '#')
+            continue;
+
+        uint8_t color = highlight_colors[0].color;
+        size_t colon = keyword.find(':');
+        if (colon != std::string_view::npos) {
+            for (const auto& entry : highlight_colors) {
+                if (keyword.substr(0, colon) == entry.name) {
+                    color = entry.color;
+                    keyword.remove_prefix(colon + 1);
+                    break;
+                }
+            }
+        }
+
+        if (!add_keyword(keyword, color))
+            break;
+    }
+
+    build();
+    return true;
+}
+
+void UartHighlighter::clear() {
+    nodes_[0] = {0, no_color, no_node, no_node, 0};
+    node_count_ = 1;
+    keyword_count_ = 0;
+    max_length_ = 0;
+
+    for (auto& channel : channels_)
+        channel = {0, no_color, 0, {}, {}};
+}
+
+bool UartHighlighter::add_keyword(std::string_view keyword, uint8_t color) {
+    if (keyword.empty() || keyword.size() > UART_HIGHLIGHT_MAX_LENGTH || keyword_count_ == UART_HIGHLIGHT_MAX_KEYWORDS)
+        return false;
+
+    uint16_t node = 0;
+    for (char c : keyword) {
+        c = fold(c);
+        uint16_t next = child(node, c);
+
+        if (next == no_node) {
+            next = node_count_++;
+            nodes_[next] = {c, no_color, no_node, nodes_[node].first_child, 0};
+            nodes_[node].first_child = next;
+        }
+
+        node = next;
+    }
+
+    // a duplicate keyword keeps the first color
+    if (nodes_[node].output == no_color) {
+        nodes_[node].output = keyword_count_;
+        keywords_[keyword_count_] = {(uint8_t)keyword.size(), color};
+        keyword_count_++;
+    }
+
+    if (keyword.size() > max_length_)
+        max_length_ = keyword.size();
+
+    return true;
+}
+
+// sets the fail links breadth first, a node inherits the output of its fail node when it has none
+void UartHighlighter::build() {
+    uint16_t queue[UART_HIGHLIGHT_MAX_NODES];
+    size_t head = 0;
+    size_t tail = 0;
+
+    for (uint16_t c = nodes_[0].first_child; c != no_node; c = nodes_[c].next_sibling) {
+        nodes_[c].fail = 0;
+        queue[tail++] = c;
+    }
+
+    while (head < tail) {
+        uint16_t node = queue[head++];
+
+        for (uint16_t c = nodes_[node].first_child; c != no_node; c = nodes_[c].next_sibling) {
+            nodes_[c].fail = step(nodes_[node].fail, nodes_[c].c);
+
+            uint8_t inherited = nodes_[nodes_[c].fail].output;
+            if (nodes_[c].output == no_color)
+                nodes_[c].output = inherited;
+
+            queue[tail++] = c;
+        }
+    }
+}
+
+uint16_t UartHighlighter::child(uint16_t node, char c) const {
+    for (uint16_t next = nodes_[node].first_child; next != no_node; next = nodes_[next].next_sibling) {
+        if (nodes_[next].c == c)
+            return next;
+    }
+
+    return no_node;
+}
+
+uint16_t UartHighlighter::step(uint16_t node, char c) const {
+    while (true) {
+        uint16_t next = child(node, c);
+        if (next != no_node)
+            return next;
+
+        if (node == 0)
+            return 0;
+
+        node = nodes_[node].fail;
+    }
+}
+
+void UartHighlighter::process(uint8_t channel_index, const uint8_t* data, size_t length, const char* base_color, std::string& out) {
+    channel_t& channel = channels_[channel_index];
+    channel.emitted_color = no_color;
+
+    if (keyword_count_ == 0) {
+        out.append((const char*)data, length);
+        return;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        char c = data[i];
+
+        channel.pending[channel.pending_length] = c;
+        channel.pending_color[channel.pending_length] = no_color;
+        channel.pending_length++;
+
+        channel.node = step(channel.node, fold(c));
+
+        uint8_t output = nodes_[channel.node].output;
+        if (output != no_color) {
+            // after a flush the start of the keyword may be gone already
+            const keyword_t& keyword = keywords_[output];
+            size_t start = channel.pending_length > keyword.length ? channel.pending_length - keyword.length : 0;
+            for (size_t j = start; j < channel.pending_length; j++)
+                channel.pending_color[j] = keyword.color;
+        }
+
+        // bytes before the last max_length_ - 1 can not be part of a match anymore,
+        // they are released in batches so the buffer is only moved once in a while
+        if (channel.pending_length == sizeof(channel.pending))
+            emit(channel, channel.pending_length - (max_length_ - 1), base_color, out);
+    }
+}
+
+void UartHighlighter::flush(uint8_t channel_index, const char* base_color, std::string& out) {
+    channel_t& channel = channels_[channel_index];
+    channel.emitted_color = no_color;
+
+    emit(channel, channel.pending_length, base_color, out);
+}
+
+void UartHighlighter::emit(channel_t& channel, size_t count, const char* base_color, std::string& out) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t color = channel.pending_color[i];
+
+        if (color != channel.emitted_color) {
+            if (color == no_color) {
+                out += base_color;
+            } else {
+                out += '\x1B';
+                out += (char)color;
+            }
+            channel.emitted_color = color;
+        }
+
+        out += channel.pending[i];
+    }
+
+    channel.pending_length -= count;
+    memmove(channel.pending, channel.pending + count, channel.pending_length);
+    memmove(channel.pending_color, channel.pending_color + count, channel.pending_length);
+}
+
+}  // namespace ui
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "ui/file.hpp"
+
+#define UART_HIGHLIGHT_MAX_KEYWORDS 16
+#define UART_HIGHLIGHT_MAX_LENGTH 24
+#define UART_HIGHLIGHT_MAX_NODES (UART_HIGHLIGHT_MAX_KEYWORDS * UART_HIGHLIGHT_MAX_LENGTH + 1)
+#define UART_HIGHLIGHT_CHANNELS 3
+
+namespace ui {
+
+/*
+    Colors keywords in the console stream with an Aho-Corasick automaton.
+    The automaton is built once from the keyword list, matching is case insensitive,
+    runs byte by byte across chunk boundaries and keeps state per channel.
+    A byte is held back until no keyword that could still match covers it, which is at
+    least the longest keyword minus one byte. flush() releases them when the drain is done.
+    All state has a fixed size, nothing is allocated while processing.
+*/
+class UartHighlighter {
+   public:
+    UartHighlighter() {
+        clear();
+    }
+
+    // one keyword per line, optionally prefixed with a color: "red:ERROR", lines starting with # are skipped
+    bool load(const std::filesystem::path& path);
+    bool add_keyword(std::string_view keyword, uint8_t color);
+    void build();
+    void clear();
+
+    bool empty() const { return keyword_count_ == 0; }
+    size_t keyword_count() const { return keyword_count_; }
+
+    // appends data to out with color escapes around the keywords,
+    // out has to be in base_color, the escape of the channel, when called
+    void process(uint8_t channel, const uint8_t* data, size_t length, const char* base_color, std::string& out);
+    void flush(uint8_t channel, const char* base_color, std::string& out);
+
+   private:
+    static constexpr uint8_t no_color = 0xFF;
+    static constexpr uint16_t no_node = 0xFFFF;
+
+    struct node_t {
+        char c;
+        uint8_t output;  // longest keyword ending here, also through the fail links
+        uint16_t first_child;
+        uint16_t next_sibling;
+        uint16_t fail;
+    };
+
+    struct keyword_t {
+        uint8_t length;
+        uint8_t color;
+    };
+
+    struct channel_t {
+        uint16_t node;
+        uint8_t emitted_color;  // color of the last byte written to out
+        uint8_t pending_length;
+        char pending[UART_HIGHLIGHT_MAX_LENGTH * 2];
+        uint8_t pending_color[UART_HIGHLIGHT_MAX_LENGTH * 2];
+    };
+
+    uint16_t child(uint16_t node, char c) const;
+    uint16_t step(uint16_t node, char c) const;
+    void emit(channel_t& channel, size_t count, const char* base_color, std::string& out);
+
+    node_t nodes_[UART_HIGHLIGHT_MAX_NODES]{};
+    size_t node_count_{0};
+    keyword_t keywords_[UART_HIGHLIGHT_MAX_KEYWORDS]{};
+    size_t keyword_count_{0};
+    size_t max_length_{0};
+    channel_t channels_[UART_HIGHLIGHT_CHANNELS]{};
+};
+
+}  // namespace ui
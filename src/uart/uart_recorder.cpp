@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include "uart_recorder.hpp"
+
+#include <cstring>
+
+namespace ui {
+
+static const uint8_t binary_header[] = {'P', 'P', 'U', 'A', 'R', 'T', 1, 0};
+
+bool UartRecorder::start(UartRecordFormat format) {
+    stop();
+
+    ensure_directory(u"UART");
+    path_ = next_filename_matching_pattern(format == UartRecordFormat::RECORD_BINARY ? u"UART/UART_????.BIN" : u"UART/UART_????.TXT");
+    if (path_.empty())
+        return false;
+
+    auto error = file_.create(path_);
+    if (error.is_valid())
+        return false;
+
+    recording_ = true;
+    failed_ = false;
+    format_ = format;
+    fill_block_ = 0;
+    fill_length_ = 0;
+    pending_ = false;
+    first_record_ = true;
+    last_timestamp_ = 0;
+    bytes_written_ = 0;
+    stalls_ = 0;
+
+    if (format_ == UartRecordFormat::RECORD_BINARY)
+        append(binary_header, sizeof(binary_header));
+
+    return true;
+}
+
+void UartRecorder::stop() {
+    if (!recording_)
+        return;
+
+    flush();
+    if (recording_ && fill_length_ > 0)
+        write_block(fill_block_, fill_length_);
+
+    // a failed write has closed the file already
+    if (recording_) {
+        file_.close();
+        recording_ = false;
+    }
+}
+
+void UartRecorder::record(uint8_t channel, uint32_t timestamp_us, const uint8_t* data, size_t length) {
+    if (!recording_ || length == 0)
+        return;
+
+    if (format_ == UartRecordFormat::RECORD_BINARY) {
+        // the module clock wraps after 71 minutes, the unsigned difference stays correct
+        uint32_t delta = first_record_ ? 0 : timestamp_us - last_timestamp_;
+        first_record_ = false;
+        last_timestamp_ = timestamp_us;
+
+        append(&channel, 1);
+        append_varint(delta);
+        append_varint(length);
+    }
+
+    append(data, length);
+}
+
+void UartRecorder::flush() {
+    if (!recording_ || !pending_)
+        return;
+
+    pending_ = false;
+    write_block(fill_block_ ^ 1, sizeof(blocks_[0]));
+}
+
+void UartRecorder::append(const uint8_t* data, size_t length) {
+    while (length > 0 && recording_) {
+        size_t chunk = std::min(length, sizeof(blocks_[0]) - fill_length_);
+        memcpy(blocks_[fill_block_] + fill_length_, data, chunk);
+        fill_length_ += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (fill_length_ < sizeof(blocks_[0]))
+            continue;
+
+        // the card is slower than the drain, the data waits instead of being lost
+        if (pending_) {
+            stalls_++;
+            flush();
+        }
+
+        pending_ = true;
+        fill_block_ ^= 1;
+        fill_length_ = 0;
+    }
+}
+
+void UartRecorder::append_varint(uint32_t value) {
+    uint8_t encoded[5];
+    size_t length = 0;
+
+    do {
+        encoded[length] = value & 0x7f;
+        value >>= 7;
+        if (value != 0)
+            encoded[length] |= 0x80;
+        length++;
+    } while (value != 0);
+
+    append(encoded, length);
+}
+
+bool UartRecorder::write_block(size_t index, size_t length) {
+    auto result = file_.write(blocks_[index], length);
+    if (result.is_error() || result.value() != length) {
+        file_.close();
+        recording_ = false;
+        failed_ = true;
+        return false;
+    }
+
+    bytes_written_ += length;
+    return true;
+}
+
+}  // namespace ui
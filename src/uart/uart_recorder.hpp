@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#pragma once
+
+#include "ui/file.hpp"
+
+namespace ui {
+
+enum class UartRecordFormat : uint8_t {
+    RECORD_TEXT = 0,  // the received bytes as they are
+    RECORD_BINARY     // records with channel and timestamp, see UartRecorder
+};
+
+/*
+    Streams received uart data to a file on the SD card.
+    Data is collected in two blocks of max_file_block_size. A full block is written by flush(),
+    which the app calls after the drain, so the card only sees whole blocks and a drain burst
+    is not interrupted by a write. Only if both blocks are full the write happens right away.
+
+    Binary files start with "PPUART", a version byte and a zero byte, followed by records:
+    1 byte channel, LEB128 timestamp delta in us, LEB128 payload length, payload.
+*/
+class UartRecorder {
+   public:
+    UartRecorder() = default;
+    UartRecorder(const UartRecorder&) = delete;
+    UartRecorder& operator=(const UartRecorder&) = delete;
+
+    ~UartRecorder() {
+        stop();
+    }
+
+    // creates the next free UART/UART_????.TXT or .BIN
+    bool start(UartRecordFormat format);
+    void stop();
+
+    void record(uint8_t channel, uint32_t timestamp_us, const uint8_t* data, size_t length);
+    void flush();
+
+    bool is_recording() const { return recording_; }
+    bool has_failed() const { return failed_; }
+    const std::filesystem::path& path() const { return path_; }
+    uint64_t bytes_written() const { return bytes_written_; }
+    uint32_t stalls() const { return stalls_; }
+
+   private:
+    void append(const uint8_t* data, size_t length);
+    void append_varint(uint32_t value);
+    bool write_block(size_t index, size_t length);
+
+    File file_{};
+    bool recording_{false};
+    bool failed_{false};
+    UartRecordFormat format_{UartRecordFormat::RECORD_TEXT};
+    std::filesystem::path path_{};
+
+    uint8_t blocks_[2][std::filesystem::max_file_block_size]{};
+    size_t fill_block_{0};
+    size_t fill_length_{0};
+    bool pending_{false};  // the other block is full and waits for flush()
+
+    bool first_record_{true};
+    uint32_t last_timestamp_{0};
+    uint64_t bytes_written_{0};
+    uint32_t stalls_{0};  // times both blocks were full and the drain had to wait for the card
+};
+
+}  // namespace ui
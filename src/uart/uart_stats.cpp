@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include "uart_stats.hpp"
+
+namespace ui {
+
+// frame sync runs at 60 Hz
+#define UART_STATS_FRAMES_PER_SECOND 60
+
+static std::string format_rate(uint64_t value) {
+    if (value < 10000)
+        return std::to_string(value);
+
+    return std::to_string(value / 1000) + "k";
+}
+
+static std::string format_ms(uint32_t us) {
+    std::string fraction = std::to_string(us % 1000 / 10);
+    return std::to_string(us / 1000) + "." + (fraction.size() < 2 ? "0" : "") + fraction;
+}
+
+void UartStats::set_mode(UartStatsMode mode) {
+    mode_ = mode;
+    window_frames_ = mode == UartStatsMode::STATS_LIVE ? UART_STATS_FRAMES_PER_SECOND / 4 : UART_STATS_FRAMES_PER_SECOND;
+
+    current_ = {};
+    window_start_ = cycle_counter_now();
+    last_dropped_ = 0;
+    rates_line_ = "collecting...";
+    timing_line_.clear();
+}
+
+bool UartStats::frame_end() {
+    uint32_t now = cycle_counter_now();
+    uint32_t cycles = now - frame_start_;
+
+    current_.frames++;
+    current_.frame_cycles += cycles;
+    if (cycles > current_.frame_cycles_max)
+        current_.frame_cycles_max = cycles;
+
+    if (current_.frames < window_frames_)
+        return false;
+
+    update_lines(now - window_start_);
+    current_ = {};
+    window_start_ = now;
+    return true;
+}
+
+void UartStats::add_drain(uint8_t fill, bool overflowed, uint32_t dropped_bytes) {
+    if (fill > current_.fill_max)
+        current_.fill_max = fill;
+
+    if (overflowed)
+        current_.overflows++;
+
+    current_.dropped_bytes += dropped_bytes;
+}
+
+void UartStats::update_lines(uint32_t window_cycles) {
+    // without a cycle counter the nominal frame rate has to do
+    uint32_t window_ms = window_cycles / (CYCLE_COUNTER_HZ / 1000);
+    if (window_ms == 0)
+        window_ms = current_.frames * 1000 / UART_STATS_FRAMES_PER_SECOND;
+
+    auto per_second = [window_ms](uint32_t value) {
+        return (uint32_t)((uint64_t)value * 1000 / window_ms);
+    };
+
+    last_dropped_ = current_.dropped_bytes;
+    total_dropped_ += current_.dropped_bytes;
+
+    rates_line_ = "RX " + format_rate(per_second(current_.rx_bytes)) +
+                  "B/s DRAW " + format_rate(per_second(current_.rendered_bytes)) +
+                  "B/s Q " + std::to_string(current_.fill_max * 100 / 255) +
+                  "% OV " + std::to_string(current_.overflows) +
+                  " DROP " + format_rate(total_dropped_);
+
+    timing_line_ = "I2C " + std::to_string(per_second(current_.i2c_transfers)) +
+                   "/s FRAME " + format_ms(cycles_to_us(current_.frame_cycles / current_.frames)) +
+                   "ms MAX " + format_ms(cycles_to_us(current_.frame_cycles_max)) +
+                   "ms" + (mode_ == UartStatsMode::STATS_SECOND ? " 1s" : "");
+}
+
+}  // namespace ui
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2024 Bernd Herzog
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "cycle_counter.hpp"
+
+namespace ui {
+
+enum class UartStatsMode : uint8_t {
+    STATS_OFF = 0,
+    STATS_LIVE,    // refreshed four times a second
+    STATS_SECOND,  // refreshed once a second, the least overhead
+};
+
+/*
+    Throughput and timing counters of the uart view, collected over a window of frames.
+    Rates are per second of measured time, so frames skipped by a slow on_framesync
+    do not inflate them. Counting is a few additions per call, the text is only
+    built when a window completes.
+*/
+class UartStats {
+   public:
+    UartStats() {
+        cycle_counter_enable();
+    }
+
+    void set_mode(UartStatsMode mode);
+    UartStatsMode mode() const { return mode_; }
+    bool enabled() const { return mode_ != UartStatsMode::STATS_OFF; }
+
+    void frame_start() { frame_start_ = cycle_counter_now(); }
+    // returns true when a window completed and the lines were updated
+    bool frame_end();
+
+    void add_rx(size_t bytes) { current_.rx_bytes += bytes; }
+    void add_rendered(size_t bytes) { current_.rendered_bytes += bytes; }
+    void add_i2c() { current_.i2c_transfers++; }
+    void add_drain(uint8_t fill, bool overflowed, uint32_t dropped_bytes);
+
+    const std::string& rates_line() const { return rates_line_; }
+    const std::string& timing_line() const { return timing_line_; }
+    bool dropping() const { return last_dropped_ > 0; }
+
+   private:
+    struct window_t {
+        uint32_t rx_bytes;
+        uint32_t rendered_bytes;
+        uint32_t i2c_transfers;
+        uint32_t dropped_bytes;
+        uint32_t overflows;
+        uint32_t frames;
+        uint32_t frame_cycles;
+        uint32_t frame_cycles_max;
+        uint8_t fill_max;  // 255 is full
+    };
+
+    void update_lines(uint32_t window_cycles);
+
+    UartStatsMode mode_{UartStatsMode::STATS_OFF};
+    uint32_t window_frames_{60};
+    window_t current_{};
+    uint32_t window_start_{0};
+    uint32_t frame_start_{0};
+    uint32_t last_dropped_{0};
+    uint64_t total_dropped_{0};
+
+    std::string rates_line_{};
+    std::string timing_line_{};
+};
+
+}  // namespace ui
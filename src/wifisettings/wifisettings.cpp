@@ -34,6 +34,7 @@ extern "C" void initialize(const standalone_application_api_t& api) {
 namespace ui {
 
 WifiSettingsView::WifiSettingsView(NavigationView& nav) : nav_(nav) {
+    timer_load.start_frames(20);
     add_children({&btn_ssid, &btn_password, &btn_send, &text_ssid, &text_password,
                   &text_ssid_ap, &text_password_ap, &btn_ssid_ap, &btn_password_ap, &btn_send_ap,
                   &text_ip, &labels, &btn_refresh});
@@ -71,10 +72,7 @@ WifiSettingsView::WifiSettingsView(NavigationView& nav) : nav_(nav) {
         memset(&config, 0, sizeof(config));
         strncpy(config.ssid, ssid_.c_str(), sizeof(config.ssid) - 1);
         strncpy(config.password, password_.c_str(), sizeof(config.password) - 1);
-        Command cmd = Command::PPCMD_WIFI_SET_STA;
-        std::vector<uint8_t> data(sizeof(wifi_config_comp_t));
-        memcpy(data.data(), &config, sizeof(wifi_config_comp_t));
-        data.insert(data.begin(), reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));
+        auto data = pp_command(Command::PPCMD_WIFI_SET_STA, config);
         if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
     };
     btn_send_ap.on_select = [this](Button&) {
@@ -82,25 +80,15 @@ WifiSettingsView::WifiSettingsView(NavigationView& nav) : nav_(nav) {
         memset(&config, 0, sizeof(config));
         strncpy(config.ssid, ssid_ap_.c_str(), sizeof(config.ssid) - 1);
         strncpy(config.password, password_ap_.c_str(), sizeof(config.password) - 1);
-        Command cmd = Command::PPCMD_WIFI_SET_AP;
-        std::vector<uint8_t> data(sizeof(wifi_config_comp_t));
-        memcpy(data.data(), &config, sizeof(wifi_config_comp_t));
-        data.insert(data.begin(), reinterpret_cast<uint8_t*>(&cmd), reinterpret_cast<uint8_t*>(&cmd) + sizeof(cmd));
+        auto data = pp_command(Command::PPCMD_WIFI_SET_AP, config);
         if (_api->i2c_read(data.data(), data.size(), nullptr, 0) == false) return;
     };
 
     btn_refresh.on_select = [this](Button&) {
-        config_loaded = 0;
+        timer_load.start_frames(20);
     };
 }
 
-void WifiSettingsView::on_framesync() {
-    if (config_loaded <= 20) config_loaded++;
-    if (config_loaded == 20) {
-        get_current_config();
-    }
-}
-
 void WifiSettingsView::get_current_config() {
     Command cmd = Command::PPCMD_WIFI_GET_CONFIG;
     wifi_current_data_t current{};
@@ -38,6 +38,7 @@ typedef struct wifi_config_comp_t {
     char ssid[30];
     char password[30];
 } wifi_config_comp_t;
+PP_MESSAGE(wifi_config_comp_t, 60);
 
 typedef struct wifi_current_data_t {
     uint8_t ip[4];
@@ -46,6 +47,7 @@ typedef struct wifi_current_data_t {
     char ap_ssid[30];
     char ap_password[30];
 } wifi_current_data_t;
+PP_MESSAGE(wifi_current_data_t, 124);
 
 class WifiSettingsView : public View {
    public:
@@ -55,11 +57,10 @@ class WifiSettingsView : public View {
     };
 
     std::string title() const override { return "WiFi Settings"; };
-    void on_framesync() override;
 
    private:
     void get_current_config();
-    uint8_t config_loaded = 0;
+    FrameTimer timer_load{this, [this]() { get_current_config(); }};
 
     std::string ssid_ = "-";
     std::string password_ = "-";